@@ -4,12 +4,233 @@
 
 #include <cmath>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "zeek/3rdparty/doctest.h"
 #include "zeek/Conn.h"
 #include "zeek/Reporter.h"
 #include "zeek/ZeekString.h"
 
 namespace zeek::detail {
 
+namespace {
+
+// The vectorized paths below only handle the default alphabet. They work on
+// whole blocks of characters and stop at the first block containing anything
+// else, including padding and whitespace, which leaves these to the regular
+// per-character code with its error reporting.
+
+#if defined(__SSE2__)
+// Writes the three bytes held in the low 24 bits of each 32-bit lane.
+inline void store_triplets(const uint32_t* lanes, int n, char* out) {
+    for ( int i = 0; i < n; ++i ) {
+        *out++ = char(lanes[i] >> 16);
+        *out++ = char(lanes[i] >> 8);
+        *out++ = char(lanes[i]);
+    }
+}
+#endif
+
+// Decodes blocks of characters from the default alphabet into out, which has
+// room for out_len bytes. Returns the number of characters consumed, which
+// is a multiple of four. Each four of them yield three bytes.
+int decode_blocks(const unsigned char* in, int len, char* out, int out_len) {
+    int n = 0;
+
+#if defined(__AVX2__)
+    for ( ; len - n >= 32 && out_len >= 24; n += 32, out += 24, out_len -= 24 ) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + n));
+
+        // Bytes >= 0x80 compare as negative, so they fall outside all ranges.
+        auto in_range = [v](char lo, char hi) {
+            return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                                    _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+        };
+
+        __m256i upper = in_range('A', 'Z');
+        __m256i lower = in_range('a', 'z');
+        __m256i digit = in_range('0', '9');
+        __m256i plus = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('+'));
+        __m256i slash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'));
+
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, plus));
+        if ( static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(valid, slash))) != 0xffffffff )
+            break;
+
+        __m256i letters = _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-65)),
+                                          _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+        __m256i others = _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(4)),
+                                         _mm256_or_si256(_mm256_and_si256(plus, _mm256_set1_epi8(19)),
+                                                         _mm256_and_si256(slash, _mm256_set1_epi8(16))));
+        __m256i sextets = _mm256_add_epi8(v, _mm256_or_si256(letters, others));
+
+        // Combine pairs of sextets into 12 bits, then pairs of those into 24.
+        __m256i pairs = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(sextets, _mm256_set1_epi16(0x00ff)), 6),
+                                        _mm256_srli_epi16(sextets, 8));
+        __m256i triplets = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+
+        uint32_t lanes[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), triplets);
+        store_triplets(lanes, 8, out);
+    }
+#endif
+
+#if defined(__SSE2__)
+    for ( ; len - n >= 16 && out_len >= 12; n += 16, out += 12, out_len -= 12 ) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + n));
+
+        // Bytes >= 0x80 compare as negative, so they fall outside all ranges.
+        auto in_range = [v](char lo, char hi) {
+            return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+        };
+
+        __m128i upper = in_range('A', 'Z');
+        __m128i lower = in_range('a', 'z');
+        __m128i digit = in_range('0', '9');
+        __m128i plus = _mm_cmpeq_epi8(v, _mm_set1_epi8('+'));
+        __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+
+        __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus));
+        if ( _mm_movemask_epi8(_mm_or_si128(valid, slash)) != 0xffff )
+            break;
+
+        __m128i letters =
+            _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)), _mm_and_si128(lower, _mm_set1_epi8(-71)));
+        __m128i others = _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(4)),
+                                      _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(19)),
+                                                   _mm_and_si128(slash, _mm_set1_epi8(16))));
+        __m128i sextets = _mm_add_epi8(v, _mm_or_si128(letters, others));
+
+        // Combine pairs of sextets into 12 bits, then pairs of those into 24.
+        __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(sextets, _mm_set1_epi16(0x00ff)), 6),
+                                     _mm_srli_epi16(sextets, 8));
+        __m128i triplets = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+
+        uint32_t lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), triplets);
+        store_triplets(lanes, 4, out);
+    }
+#elif defined(__ARM_NEON)
+    for ( ; len - n >= 64 && out_len >= 48; n += 64, out += 48, out_len -= 48 ) {
+        // Deinterleaving puts the four characters of each group into
+        // separate vectors.
+        uint8x16x4_t chars = vld4q_u8(in + n);
+        uint8x16_t sextets[4];
+        uint8x16_t valid = vdupq_n_u8(0xff);
+
+        for ( int i = 0; i < 4; ++i ) {
+            uint8x16_t v = chars.val[i];
+
+            auto in_range = [v](uint8_t lo, uint8_t hi) {
+                return vandq_u8(vcgeq_u8(v, vdupq_n_u8(lo)), vcleq_u8(v, vdupq_n_u8(hi)));
+            };
+
+            uint8x16_t upper = in_range('A', 'Z');
+            uint8x16_t lower = in_range('a', 'z');
+            uint8x16_t digit = in_range('0', '9');
+            uint8x16_t plus = vceqq_u8(v, vdupq_n_u8('+'));
+            uint8x16_t slash = vceqq_u8(v, vdupq_n_u8('/'));
+
+            valid = vandq_u8(valid, vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, plus)), slash));
+
+            uint8x16_t letters =
+                vorrq_u8(vandq_u8(upper, vdupq_n_u8(uint8_t(-65))), vandq_u8(lower, vdupq_n_u8(uint8_t(-71))));
+            uint8x16_t others = vorrq_u8(vandq_u8(digit, vdupq_n_u8(4)),
+                                         vorrq_u8(vandq_u8(plus, vdupq_n_u8(19)), vandq_u8(slash, vdupq_n_u8(16))));
+            sextets[i] = vaddq_u8(v, vorrq_u8(letters, others));
+        }
+
+        // Four bits per input byte, as for the ContentLine analyzer's scanner.
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(valid), 4)), 0);
+        if ( mask != ~uint64_t(0) )
+            break;
+
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(sextets[0], 2), vshrq_n_u8(sextets[1], 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(sextets[1], 4), vshrq_n_u8(sextets[2], 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(sextets[2], 6), sextets[3]);
+        vst3q_u8(reinterpret_cast<uint8_t*>(out), bytes);
+    }
+#endif
+
+    return n;
+}
+
+// Encodes groups of three bytes with the default alphabet into out, which
+// has room for out_len characters. Returns the number of bytes consumed,
+// which is a multiple of three. Each three of them yield four characters.
+int encode_blocks(const unsigned char* in, int len, char* out, int out_len) {
+    int n = 0;
+
+#if defined(__SSE2__)
+    for ( ; len - n >= 12 && out_len >= 16; n += 12, out += 16, out_len -= 16 ) {
+        uint32_t lanes[4];
+
+        for ( int i = 0; i < 4; ++i ) {
+            const unsigned char* p = in + n + 3 * i;
+            lanes[i] = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+        }
+
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+        __m128i mask = _mm_set1_epi32(0x3f);
+
+        // Spread the four sextets of each lane across its bytes, in output order.
+        __m128i sextets = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 18), mask),
+                         _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 12), mask), 8)),
+            _mm_or_si128(_mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 6), mask), 16),
+                         _mm_slli_epi32(_mm_and_si128(v, mask), 24)));
+
+        // Offsets from 'A' for [0, 25], adjusted for the later ranges.
+        __m128i ge26 = _mm_cmpgt_epi8(sextets, _mm_set1_epi8(25));
+        __m128i ge52 = _mm_cmpgt_epi8(sextets, _mm_set1_epi8(51));
+        __m128i is62 = _mm_cmpeq_epi8(sextets, _mm_set1_epi8(62));
+        __m128i is63 = _mm_cmpeq_epi8(sextets, _mm_set1_epi8(63));
+
+        __m128i offset =
+            _mm_add_epi8(_mm_add_epi8(_mm_set1_epi8('A'), _mm_and_si128(ge26, _mm_set1_epi8('a' - 'A' - 26))),
+                         _mm_add_epi8(_mm_and_si128(ge52, _mm_set1_epi8('0' - 52 - ('a' - 26))),
+                                      _mm_add_epi8(_mm_and_si128(is62, _mm_set1_epi8('+' - 62 - ('0' - 52))),
+                                                   _mm_and_si128(is63, _mm_set1_epi8('/' - 63 - ('0' - 52))))));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi8(sextets, offset));
+    }
+#elif defined(__ARM_NEON)
+    for ( ; len - n >= 48 && out_len >= 64; n += 48, out += 64, out_len -= 64 ) {
+        uint8x16x3_t bytes = vld3q_u8(in + n);
+        uint8x16_t sextets[4];
+        sextets[0] = vshrq_n_u8(bytes.val[0], 2);
+        sextets[1] = vorrq_u8(vandq_u8(vshlq_n_u8(bytes.val[0], 4), vdupq_n_u8(0x3f)), vshrq_n_u8(bytes.val[1], 4));
+        sextets[2] = vorrq_u8(vandq_u8(vshlq_n_u8(bytes.val[1], 2), vdupq_n_u8(0x3f)), vshrq_n_u8(bytes.val[2], 6));
+        sextets[3] = vandq_u8(bytes.val[2], vdupq_n_u8(0x3f));
+
+        uint8x16x4_t chars;
+
+        for ( int i = 0; i < 4; ++i ) {
+            uint8x16_t s = sextets[i];
+            uint8x16_t offset = vbslq_u8(vcgeq_u8(s, vdupq_n_u8(26)), vdupq_n_u8('a' - 26), vdupq_n_u8('A'));
+            offset = vbslq_u8(vcgeq_u8(s, vdupq_n_u8(52)), vdupq_n_u8(uint8_t('0' - 52)), offset);
+            offset = vbslq_u8(vceqq_u8(s, vdupq_n_u8(62)), vdupq_n_u8(uint8_t('+' - 62)), offset);
+            offset = vbslq_u8(vceqq_u8(s, vdupq_n_u8(63)), vdupq_n_u8(uint8_t('/' - 63)), offset);
+            chars.val[i] = vaddq_u8(s, offset);
+        }
+
+        vst4q_u8(reinterpret_cast<uint8_t*>(out), chars);
+    }
+#endif
+
+    return n;
+}
+
+} // namespace
+
 int Base64Converter::default_base64_table[256];
 const std::string Base64Converter::default_alphabet =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -34,7 +255,15 @@ void Base64Converter::Encode(int len, const unsigned char* data, int* pblen, cha
         *pblen = blen;
     }
 
-    for ( int i = 0, j = 0; (i < len) && (j < blen); ) {
+    int i = 0;
+    int j = 0;
+
+    if ( alphabet == default_alphabet ) {
+        i = encode_blocks(data, len, buf, blen);
+        j = i / 3 * 4;
+    }
+
+    while ( (i < len) && (j < blen) ) {
         uint32_t bit32 = data[i++] << 16;
         bit32 += (i++ < len ? data[i - 1] : 0) << 8;
         bit32 += i++ < len ? data[i - 1] : 0;
@@ -166,6 +395,16 @@ int Base64Converter::Decode(int len, const char* data, int* pblen, char** pbuf)
         if ( dlen >= len )
             break;
 
+        if ( base64_group_next == 0 && ! base64_after_padding && base64_table == default_base64_table ) {
+            int n = decode_blocks(reinterpret_cast<const unsigned char*>(data) + dlen, len - dlen, buf,
+                                  *pbuf + blen - buf);
+            dlen += n;
+            buf += n / 4 * 3;
+
+            if ( dlen >= len )
+                break;
+        }
+
         unsigned char c = (unsigned char)data[dlen];
         if ( c == '=' )
             ++base64_padding;
@@ -255,4 +494,52 @@ String* encode_base64(const String* s, const String* a, Connection* conn) {
     return new String(true, (u_char*)outbuf, outlen);
 }
 
+TEST_SUITE_BEGIN("base64");
+
+TEST_CASE("base64 round trip") {
+    // Long enough to go through the vectorized paths, with a tail that's not.
+    std::string plain = "The quick brown fox jumps over the lazy dog, then naps in the sun until dusk.";
+    std::string encoded =
+        "VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVyIHRoZSBsYXp5IGRvZywgdGhlbiBuYXBzIGluIHRoZSBzdW4gdW50aWwgZHVzay4=";
+
+    String s(plain);
+    String* e = encode_base64(&s);
+    CHECK(e->CheckString() == encoded);
+
+    String* d = decode_base64(e);
+    CHECK(d->CheckString() == plain);
+
+    // Bytes with the high bit set, and sextets 62 and 63.
+    std::string binary;
+    for ( int i = 200; i < 276; ++i )
+        binary.push_back(char(i & 0xff));
+
+    String b(binary);
+    String* be = encode_base64(&b);
+    CHECK(be->CheckString() == std::string("yMnKy8zNzs/Q0dLT1NXW19jZ2tvc3d7f4OHi4+Tl5ufo6err7O3u7/Dx8vP0"
+                                           "9fb3+Pn6+/z9/v8AAQIDBAUGBwgJCgsMDQ4PEBESEw=="));
+
+    String* bd = decode_base64(be);
+    CHECK(std::string(reinterpret_cast<const char*>(bd->Bytes()), bd->Len()) == binary);
+
+    delete e;
+    delete d;
+    delete be;
+    delete bd;
+}
+
+TEST_CASE("base64 decoding with padding after vectorized blocks") {
+    Base64Converter dec(nullptr);
+    std::string input = "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVo=";
+    char* buf = nullptr;
+    int len = 0;
+
+    CHECK(dec.Decode(input.size(), input.data(), &len, &buf) == static_cast<int>(input.size()));
+    CHECK(std::string(buf, len) == "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+    CHECK(! dec.Errored());
+    delete[] buf;
+}
+
+TEST_SUITE_END();
+
 } // namespace zeek::detail
@@ -66,6 +66,9 @@ Connection::Connection(const detail::ConnKey& k, double t, const ConnTuple* id,
 
     finished = 0;
 
+    shunted = 0;
+    count_shunted = 0;
+
     adapter = nullptr;
     primary_PIA = nullptr;
 
@@ -245,6 +248,19 @@ const RecordValPtr& Connection::GetVal() {
     if ( adapter )
         adapter->UpdateConnVal(conn_val.get());
 
+    if ( count_shunted ) {
+        // The ConnSize analyzer has set its totals from before the shunt.
+        static const int pktidx = id::endpoint->FieldOffset("num_pkts");
+        static const int bytesidx = id::endpoint->FieldOffset("num_bytes_ip");
+
+        auto* orig_endp = conn_val->GetFieldAs<RecordVal>(1);
+        auto* resp_endp = conn_val->GetFieldAs<RecordVal>(2);
+        orig_endp->Assign(pktidx, orig_endp->GetFieldAs<CountVal>(pktidx) + shunted_pkts[1]);
+        orig_endp->Assign(bytesidx, orig_endp->GetFieldAs<CountVal>(bytesidx) + shunted_bytes[1]);
+        resp_endp->Assign(pktidx, resp_endp->GetFieldAs<CountVal>(pktidx) + shunted_pkts[0]);
+        resp_endp->Assign(bytesidx, resp_endp->GetFieldAs<CountVal>(bytesidx) + shunted_bytes[0]);
+    }
+
     conn_val->AssignTime(3, start_time); // ###
     conn_val->AssignInterval(4, last_time - start_time);
 
@@ -267,6 +283,17 @@ analyzer::Analyzer* Connection::FindAnalyzer(const zeek::Tag& tag) {
 
 analyzer::Analyzer* Connection::FindAnalyzer(const char* name) { return adapter->FindChild(name); }
 
+void Connection::Shunt() {
+    if ( shunted )
+        return;
+
+    shunted = 1;
+    count_shunted = adapter && adapter->FindChild("ConnSize");
+
+    if ( adapter )
+        adapter->SetSkip(true);
+}
+
 void Connection::Match(detail::Rule::PatternType type, const u_char* data, int len, bool is_orig, bool bol, bool eol,
                        bool clear_state) {
     if ( primary_PIA )
@@ -306,6 +333,9 @@ void Connection::FlipRoles() {
     resp_flow_label = orig_flow_label;
     orig_flow_label = tmp_flow;
 
+    std::swap(shunted_pkts[0], shunted_pkts[1]);
+    std::swap(shunted_bytes[0], shunted_bytes[1]);
+
     if ( conn_val )
         flip_conn_val(conn_val);
 
@@ -200,6 +200,27 @@ public:
     // Returns true once Done() is called.
     bool IsFinished() { return finished; }
 
+    /**
+     * Stops all analysis of the connection. Later packets only count toward
+     * the packet and byte totals of its endpoints, which requires that the
+     * connection is also added to the session manager's shunt table.
+     */
+    void Shunt();
+    bool IsShunted() const { return shunted; }
+
+    /**
+     * Accounts for a packet of a shunted connection.
+     *
+     * @param t The packet's timestamp.
+     * @param is_orig True if the packet came from the originator.
+     * @param ip_len The packet's length on the IP layer.
+     */
+    void ShuntedPacket(double t, bool is_orig, uint64_t ip_len) {
+        last_time = t;
+        ++shunted_pkts[is_orig];
+        shunted_bytes[is_orig] += ip_len;
+    }
+
 private:
     friend class session::detail::Timer;
 
@@ -221,6 +242,12 @@ private:
     unsigned int weird : 1;
     unsigned int finished : 1;
     unsigned int saw_first_orig_packet : 1, saw_first_resp_packet : 1;
+    unsigned int shunted : 1;
+    unsigned int count_shunted : 1; // Whether the endpoints report packet and byte totals.
+
+    // Totals of packets received while shunted, indexed by is_orig.
+    uint64_t shunted_pkts[2] = {0, 0};
+    uint64_t shunted_bytes[2] = {0, 0};
 
     packet_analysis::IP::SessionAdapter* adapter;
     analyzer::pia::PIA* primary_PIA;
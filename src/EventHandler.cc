@@ -2,13 +2,18 @@
 
 #include "zeek/Desc.h"
 #include "zeek/Event.h"
+#include "zeek/EventTrace.h"
 #include "zeek/Func.h"
 #include "zeek/ID.h"
 #include "zeek/NetVar.h"
 #include "zeek/Scope.h"
+#include "zeek/Stmt.h"
 #include "zeek/Var.h"
 #include "zeek/broker/Data.h"
 #include "zeek/broker/Manager.h"
+#include "zeek/plugin/Manager.h"
+#include "zeek/script_opt/ProfileFunc.h"
+#include "zeek/telemetry/InvocationProfile.h"
 #include "zeek/telemetry/Manager.h"
 
 namespace zeek {
@@ -91,9 +96,14 @@ void EventHandler::Call(Args* vl, bool no_remote, double ts) {
         }
     }
 
-    if ( local )
+    if ( local ) {
+        telemetry::detail::InvocationTimer timer(
+            telemetry::detail::InvocationProfile::Sample(invocation_profile,
+                                                         telemetry::detail::InvocationProfile::EVENT_HANDLER, name));
+
         // No try/catch here; we pass exceptions upstream.
         local->Invoke(vl);
+    }
 }
 
 void EventHandler::NewEvent(Args* vl) {
@@ -113,6 +123,45 @@ void EventHandler::NewEvent(Args* vl) {
     event_mgr.Dispatch(ev);
 }
 
+bool EventHandler::ArgUsed(size_t idx) {
+    if ( new_event || generate_always || ! auto_publish.empty() || detail::etm ||
+         plugin_mgr->HavePluginForHook(plugin::HOOK_QUEUE_EVENT) ||
+         plugin_mgr->HavePluginForHook(plugin::HOOK_CALL_FUNCTION) )
+        return true;
+
+    if ( ! used_args ) {
+        const auto& ft = GetType();
+        if ( ! ft )
+            return true;
+
+        auto num_params = static_cast<size_t>(ft->Params()->NumFields());
+        used_args = std::vector<bool>(num_params, false);
+
+        if ( local ) {
+            for ( const auto& b : local->GetBodies() ) {
+                auto tag = b.stmts->Tag();
+
+                if ( tag == detail::STMT_ZAM || tag == detail::STMT_CPP ) {
+                    // Compiled bodies don't retain an AST we could inspect.
+                    used_args->assign(num_params, true);
+                    break;
+                }
+
+                // The profile identifies parameters by their frame offsets,
+                // which also holds for bodies using alternate prototypes.
+                detail::ProfileFunc pf(local.get(), b.stmts, false);
+
+                for ( const auto* p : pf.Params() ) {
+                    if ( static_cast<size_t>(p->Offset()) < num_params )
+                        (*used_args)[p->Offset()] = true;
+                }
+            }
+        }
+    }
+
+    return idx >= used_args->size() || (*used_args)[idx];
+}
+
 uint64_t EventHandler::CallCount() const { return call_count ? call_count->Value() : 0; }
 
 } // namespace zeek
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "zeek/Type.h"
 #include "zeek/ZeekArgs.h"
@@ -18,7 +19,11 @@ extern double network_time;
 
 namespace telemetry {
 class Counter;
+
+namespace detail {
+class InvocationProfile;
 }
+} // namespace telemetry
 
 class Func;
 using FuncPtr = IntrusivePtr<Func>;
@@ -65,6 +70,13 @@ public:
     // Returns the number of times this EventHandler has been called since startup.
     uint64_t CallCount() const;
 
+    // Returns false if nothing will look at the value of the event's idx'th
+    // argument when it's raised: no handler body references the parameter,
+    // and neither new_event(), auto-publishing, event tracing, nor plugin
+    // hooks get to see the arguments. Callers may then skip building the
+    // full value and pass a placeholder of the right type instead.
+    bool ArgUsed(size_t idx);
+
 private:
     void NewEvent(zeek::Args* vl); // Raise new_event() meta event.
 
@@ -79,7 +91,15 @@ private:
     // Initialize this lazy, so we don't expose metrics for 0 values.
     std::shared_ptr<zeek::telemetry::Counter> call_count;
 
+    // Sampled invocation times, if enabled through Telemetry::invocation_sample_rate.
+    std::shared_ptr<zeek::telemetry::detail::InvocationProfile> invocation_profile;
+
     std::unordered_set<std::string> auto_publish;
+
+    // Per parameter, whether any of the local bodies references it. Computed
+    // on first use of ArgUsed(), as the bodies are fixed once scripts have
+    // been parsed.
+    std::optional<std::vector<bool>> used_args;
 };
 
 // Encapsulates a ptr to an event handler to overload the boolean operator.
@@ -39,6 +39,7 @@
 #include "zeek/module_util.h"
 #include "zeek/plugin/Manager.h"
 #include "zeek/session/Manager.h"
+#include "zeek/telemetry/InvocationProfile.h"
 
 // Ignore clang-format's reordering of include files here so that it doesn't
 // break what symbols are available when, which keeps the build from breaking.
@@ -331,6 +332,12 @@ ValPtr ScriptFunc::Invoke(zeek::Args* args, Frame* parent) const {
         return Flavor() == FUNC_FLAVOR_HOOK ? val_mgr->True() : nullptr;
     }
 
+    using telemetry::detail::InvocationProfile;
+    telemetry::detail::InvocationTimer invocation_timer(
+        Flavor() != FUNC_FLAVOR_EVENT ?
+            InvocationProfile::Sample(invocation_profile, InvocationProfile::FUNCTION, GetName()) :
+            nullptr);
+
     auto f = make_intrusive<Frame>(frame_size, this, args);
 
     // Hand down any trigger.
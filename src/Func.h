@@ -40,6 +40,10 @@ class FunctionIngredients;
 
 } // namespace detail
 
+namespace telemetry::detail {
+class InvocationProfile;
+}
+
 class EventGroup;
 using EventGroupPtr = std::shared_ptr<EventGroup>;
 
@@ -326,6 +330,11 @@ private:
 
     // ... and its priority.
     int current_priority = 0;
+
+    // Sampled invocation times, if enabled through
+    // Telemetry::invocation_sample_rate. Events are covered by their
+    // EventHandler instead.
+    mutable std::shared_ptr<zeek::telemetry::detail::InvocationProfile> invocation_profile;
 };
 
 using built_in_func = ValPtr (*)(Frame* frame, const Args* args);
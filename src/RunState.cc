@@ -37,6 +37,8 @@ extern "C" {
 #include "zeek/packet_analysis/Manager.h"
 #include "zeek/plugin/Manager.h"
 #include "zeek/session/Manager.h"
+#include "zeek/telemetry/PhaseTimers.h"
+#include "zeek/threading/MsgThread.h"
 
 static double last_watchdog_proc_time = 0.0; // value of above during last watchdog
 extern int signal_val;
@@ -158,6 +160,8 @@ static void forward_network_time_if_applicable() {
     return;
 }
 
+static telemetry::detail::PhaseTimers phase_timers;
+
 void init_run(const std::optional<std::string>& interface, const std::optional<std::string>& pcap_input_file,
               const std::optional<std::string>& pcap_output_file, bool do_watchdog) {
     if ( pcap_input_file ) {
@@ -206,6 +210,8 @@ void init_run(const std::optional<std::string>& interface, const std::optional<s
 
     session_mgr = new session::Manager();
 
+    phase_timers.InitPostScript();
+
     if ( do_watchdog ) {
         // Set up the watchdog to make sure we don't wedge.
         (void)setsignal(SIGALRM, watchdog);
@@ -246,10 +252,20 @@ void dispatch_packet(Packet* pkt, iosource::PktSrc* pkt_src) {
     // network_time never goes back.
     update_network_time(zeek::detail::timer_mgr->Time() < t ? t : zeek::detail::timer_mgr->Time());
     processing_start_time = t;
+
+    // Split the packet's processing into its phases, so that script
+    // execution doesn't count as packet processing.
+    using Phase = telemetry::detail::PhaseTimers::Phase;
+    phase_timers.Mark(Phase::PACKETS);
+
     expire_timers();
+    phase_timers.Mark(Phase::TIMERS);
 
     packet_mgr->ProcessPacket(pkt);
+    phase_timers.Mark(Phase::PACKETS);
+
     event_mgr.Drain();
+    phase_timers.Mark(Phase::EVENTS);
 
     processing_start_time = 0.0; // = "we're not processing now"
     current_dispatched = 0;
@@ -265,8 +281,13 @@ void run_loop() {
     ready.reserve(iosource_mgr->TotalSize());
 
     while ( iosource_mgr->Size() || (BifConst::exit_only_after_terminate && ! terminating) ) {
+        using Phase = telemetry::detail::PhaseTimers::Phase;
+
+        phase_timers.Begin();
+
         time_updated = false;
         iosource_mgr->FindReadySources(&ready);
+        phase_timers.Mark(Phase::POLL);
 
 #ifdef DEBUG
         static int loop_counter = 0;
@@ -291,6 +312,15 @@ void run_loop() {
                     iosrc->ProcessFd(src.fd, src.flags);
                 else
                     iosrc->Process();
+
+                if ( iosrc == iosource_mgr->GetPktSrc() )
+                    phase_timers.Mark(Phase::PACKETS);
+                else if ( iosrc == zeek::detail::timer_mgr )
+                    phase_timers.Mark(Phase::TIMERS);
+                else if ( threading::MsgThread::IsMsgThreadSource(iosrc) )
+                    phase_timers.Mark(Phase::THREADS);
+                else
+                    phase_timers.Mark(Phase::SOURCES);
             }
         }
         else if ( (have_pending_timers || BifConst::exit_only_after_terminate) && pseudo_realtime == 0.0 ) {
@@ -314,8 +344,12 @@ void run_loop() {
         if ( ! time_updated )
             forward_network_time_if_applicable();
 
+        phase_timers.Mark(Phase::TIMERS);
+
         event_mgr.Drain();
 
+        phase_timers.Mark(Phase::EVENTS);
+
         processing_start_time = 0.0; // = "we're not processing now"
         current_dispatched = 0;
         current_iosrc = nullptr;
@@ -338,6 +372,8 @@ void run_loop() {
             if ( ps && ! ps->IsOpen() )
                 iosource_mgr->Terminate();
         }
+
+        phase_timers.End();
     }
 
     // Get the final statistics now, and not when finish_run() is
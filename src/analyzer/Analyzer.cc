@@ -501,7 +501,7 @@ void Analyzer::CleanupChildren() {
     }
 }
 
-analyzer_list::iterator Analyzer::DeleteChild(analyzer_list::iterator i) {
+analyzer_list::iterator Analyzer::DeleteChild(const analyzer_list::iterator& i) {
     Analyzer* child = *i;
 
     // Analyzer must have already been finished or marked for removal.
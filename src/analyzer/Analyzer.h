@@ -13,6 +13,7 @@
 #include "zeek/Obj.h"
 #include "zeek/Tag.h"
 #include "zeek/Timer.h"
+#include "zeek/analyzer/ChildList.h"
 
 namespace zeek {
 
@@ -45,12 +46,11 @@ class AnalyzerTimer;
 class SupportAnalyzer;
 class OutputHandler;
 
-// This needs to remain a std::list because of the usage of iterators in the
-// Analyzer::Forward methods. These methods have the chance to loop back
-// into the same analyzer in the case of tunnels. If the recursive call adds
-// to the children list, it can invalidate iterators in the outer call,
-// causing a crash.
-using analyzer_list = std::list<Analyzer*>;
+// The Analyzer::Forward methods have the chance to loop back into the same
+// analyzer in the case of tunnels. If the recursive call adds to or removes
+// from the children list, that must not invalidate iterators in the outer
+// call. ChildList guarantees that, like a std::list would.
+using analyzer_list = ChildList;
 using ID = uint32_t;
 using analyzer_timer_func = void (Analyzer::*)(double t);
 
@@ -733,7 +733,7 @@ private:
     // Internal method to eventually delete a child analyzer that's
     // already Done(). Returns an iterator pointing to the next element after
     // the just-removed element.
-    analyzer_list::iterator DeleteChild(analyzer_list::iterator i);
+    analyzer_list::iterator DeleteChild(const analyzer_list::iterator& i);
 
     // Helper for the ctors.
     void CtorInit(const zeek::Tag& tag, Connection* conn);
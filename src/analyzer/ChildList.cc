@@ -0,0 +1,157 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/analyzer/ChildList.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "zeek/3rdparty/doctest.h"
+
+namespace zeek::analyzer {
+
+ChildList::ChildList(const ChildList& other) {
+    for ( auto* a : other )
+        push_back(a);
+}
+
+ChildList& ChildList::operator=(const ChildList& other) {
+    if ( this == &other )
+        return *this;
+
+    clear();
+
+    for ( auto* a : other )
+        push_back(a);
+
+    return *this;
+}
+
+ChildList::~ChildList() {
+    if ( slots != inline_slots )
+        delete[] slots;
+}
+
+ChildList::iterator ChildList::erase(const iterator& i) {
+    assert(i.list == this && i.idx < used && slots[i.idx]);
+
+    if ( iterators > 1 ) {
+        // Somebody else may be iterating, leave the positions alone.
+        slots[i.idx] = nullptr;
+        ++holes;
+        return {this, Next(i.idx + 1), true};
+    }
+
+    std::copy(slots + i.idx + 1, slots + used, slots + i.idx);
+    --used;
+    return {this, Next(i.idx), true};
+}
+
+void ChildList::clear() {
+    if ( iterators > 0 ) {
+        for ( uint32_t i = 0; i < used; ++i )
+            slots[i] = nullptr;
+
+        holes = used;
+    }
+    else
+        used = holes = 0;
+}
+
+void ChildList::Grow() {
+    auto* new_slots = new Analyzer*[capacity * 2];
+    std::copy(slots, slots + used, new_slots);
+
+    if ( slots != inline_slots )
+        delete[] slots;
+
+    slots = new_slots;
+    capacity *= 2;
+}
+
+void ChildList::Compact() {
+    used = std::remove(slots, slots + used, nullptr) - slots;
+    holes = 0;
+}
+
+} // namespace zeek::analyzer
+
+namespace {
+
+zeek::analyzer::Analyzer* fake(uintptr_t i) { return reinterpret_cast<zeek::analyzer::Analyzer*>(i * 8); }
+
+std::vector<uintptr_t> contents(const zeek::analyzer::ChildList& l) {
+    std::vector<uintptr_t> result;
+
+    for ( auto* a : l )
+        result.push_back(reinterpret_cast<uintptr_t>(a) / 8);
+
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("analyzer child list append and erase") {
+    zeek::analyzer::ChildList l;
+    CHECK(l.empty());
+    CHECK(l.begin() == l.end());
+
+    // Grows beyond the inline storage.
+    for ( uintptr_t i = 1; i <= 5; ++i )
+        l.push_back(fake(i));
+
+    CHECK(l.size() == 5);
+    CHECK(contents(l) == std::vector<uintptr_t>{1, 2, 3, 4, 5});
+
+    for ( auto i = l.begin(); i != l.end(); ) {
+        if ( reinterpret_cast<uintptr_t>(*i) / 8 % 2 == 0 )
+            i = l.erase(i);
+        else
+            ++i;
+    }
+
+    CHECK(l.size() == 3);
+    CHECK(contents(l) == std::vector<uintptr_t>{1, 3, 5});
+
+    auto copy = l;
+    l.clear();
+    CHECK(l.empty());
+    CHECK(contents(copy) == std::vector<uintptr_t>{1, 3, 5});
+}
+
+TEST_CASE("analyzer child list nested modification") {
+    zeek::analyzer::ChildList l;
+    l.push_back(fake(1));
+    l.push_back(fake(2));
+    l.push_back(fake(3));
+
+    std::vector<uintptr_t> seen;
+
+    for ( auto i = l.begin(); i != l.end(); ++i ) {
+        auto v = reinterpret_cast<uintptr_t>(*i) / 8;
+        seen.push_back(v);
+
+        if ( v != 1 )
+            continue;
+
+        // A nested loop erasing an element behind the outer position and
+        // appending one, as a looping-back Forward call might.
+        for ( auto j = l.begin(); j != l.end(); ) {
+            if ( *j == fake(2) )
+                j = l.erase(j);
+            else
+                ++j;
+        }
+
+        l.push_back(fake(4));
+        CHECK(l.size() == 3);
+    }
+
+    CHECK(seen == std::vector<uintptr_t>{1, 3, 4});
+    CHECK(contents(l) == std::vector<uintptr_t>{1, 3, 4});
+
+    // Once the outer iterator is gone, the hole has been compacted away.
+    auto i = l.begin();
+    ++i;
+    CHECK(*i == fake(3));
+}
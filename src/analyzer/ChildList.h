@@ -0,0 +1,160 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace zeek::analyzer {
+
+class Analyzer;
+
+/**
+ * The container holding an analyzer's children. Most analyzer trees have
+ * only one or two children per node, so the first ones are stored inline
+ * and dispatching data to them doesn't chase list nodes.
+ *
+ * Like a std::list, the container keeps iterators valid while elements are
+ * appended or erased through other iterators. The Forward methods rely on
+ * that, since a child can loop back into its parent for tunnels. Iterators
+ * refer to positions rather than addresses, so appending may relocate the
+ * storage. Erasing an element while other iterators are live only clears
+ * its slot, which iteration skips. The slots get compacted once the last of
+ * these iterators is gone.
+ *
+ * The container doesn't take ownership of the analyzers, and it cannot hold
+ * null pointers.
+ */
+class ChildList {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Analyzer*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Analyzer* const*;
+        using reference = Analyzer* const&;
+
+        iterator() = default;
+        iterator(const iterator& other) : list(other.list), idx(other.idx), locking(other.locking) { Lock(); }
+        ~iterator() { Unlock(); }
+
+        iterator& operator=(const iterator& other) {
+            // Lock first, so that the list doesn't get compacted in between.
+            other.Lock();
+            Unlock();
+            list = other.list;
+            idx = other.idx;
+            locking = other.locking;
+            return *this;
+        }
+
+        reference operator*() const { return list->slots[idx]; }
+        pointer operator->() const { return &list->slots[idx]; }
+
+        iterator& operator++() {
+            idx = list->Next(idx + 1);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const iterator& other) const { return Pos() == other.Pos(); }
+        bool operator!=(const iterator& other) const { return Pos() != other.Pos(); }
+
+    private:
+        friend class ChildList;
+
+        iterator(ChildList* arg_list, uint32_t arg_idx, bool arg_locking)
+            : list(arg_list), idx(arg_idx), locking(arg_locking) {
+            Lock();
+        }
+
+        uint32_t Pos() const { return list && idx < list->used ? idx : end_pos; }
+
+        void Lock() const {
+            if ( locking )
+                ++list->iterators;
+        }
+
+        void Unlock() const {
+            if ( locking && --list->iterators == 0 && list->holes )
+                list->Compact();
+        }
+
+        ChildList* list = nullptr;
+        uint32_t idx = end_pos;
+        bool locking = false; // False for end(), which doesn't pin positions.
+    };
+
+    using const_iterator = iterator;
+    using value_type = Analyzer*;
+    using size_type = size_t;
+
+    ChildList() = default;
+    ChildList(const ChildList& other);
+    ChildList& operator=(const ChildList& other);
+    ~ChildList();
+
+    // Compaction is not observable through the interface, hence const
+    // iterators can trigger it.
+    iterator begin() const { return {Mutable(), Next(0), true}; }
+    iterator end() const { return {Mutable(), end_pos, false}; }
+    iterator cbegin() const { return begin(); }
+    iterator cend() const { return end(); }
+
+    size_t size() const { return used - holes; }
+    bool empty() const { return used == holes; }
+
+    /**
+     * Appends an analyzer.
+     */
+    void push_back(Analyzer* a) {
+        if ( used == capacity )
+            Grow();
+
+        slots[used++] = a;
+    }
+
+    /**
+     * Removes the element an iterator refers to.
+     *
+     * @return an iterator to the next element.
+     */
+    iterator erase(const iterator& i);
+
+    /**
+     * Removes all elements.
+     */
+    void clear();
+
+private:
+    static constexpr uint32_t end_pos = UINT32_MAX;
+    static constexpr uint32_t inline_capacity = 2;
+
+    ChildList* Mutable() const { return const_cast<ChildList*>(this); }
+
+    uint32_t Next(uint32_t idx) const {
+        while ( idx < used && ! slots[idx] )
+            ++idx;
+
+        return idx;
+    }
+
+    void Grow();
+    void Compact();
+
+    Analyzer* inline_slots[inline_capacity];
+    Analyzer** slots = inline_slots;
+    uint32_t used = 0; // Slots in use, including holes.
+    uint32_t capacity = inline_capacity;
+    uint32_t holes = 0;     // Slots cleared while iterators were live.
+    uint32_t iterators = 0; // Live iterators, excluding end().
+};
+
+} // namespace zeek::analyzer
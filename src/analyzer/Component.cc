@@ -22,6 +22,11 @@ void Component::Initialize() {
     analyzer_mgr->RegisterComponent(this, "ANALYZER_");
 }
 
+void Component::SetEnabled(bool arg_enabled) {
+    plugin::Component::SetEnabled(arg_enabled);
+    analyzer_mgr->BumpConfigGeneration();
+}
+
 void Component::DoDescribe(ODesc* d) const {
     if ( factory ) {
         d->Add("ANALYZER_");
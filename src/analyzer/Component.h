@@ -85,6 +85,12 @@ public:
      */
     bool Partial() const { return partial; }
 
+    /**
+     * Overridden from plugin::Component to let the manager know that the
+     * set of enabled analyzers changed.
+     */
+    void SetEnabled(bool arg_enabled) override;
+
 protected:
     /**
      * Overridden from plugin::Component.
@@ -266,11 +266,15 @@ Analyzer* Manager::InstantiateAnalyzer(const zeek::Tag& tag, Connection* conn) {
         return nullptr;
     }
 
+    return InstantiateAnalyzer(c, conn);
+}
+
+Analyzer* Manager::InstantiateAnalyzer(Component* c, Connection* conn) {
     if ( ! c->Enabled() )
         return nullptr;
 
     if ( ! c->Factory() ) {
-        reporter->InternalWarning("analyzer %s cannot be instantiated dynamically", GetComponentName(tag).c_str());
+        reporter->InternalWarning("analyzer %s cannot be instantiated dynamically", c->CanonicalName().c_str());
         return nullptr;
     }
 
@@ -281,7 +285,7 @@ Analyzer* Manager::InstantiateAnalyzer(const zeek::Tag& tag, Connection* conn) {
         return nullptr;
     }
 
-    a->SetAnalyzerTag(tag);
+    a->SetAnalyzerTag(c->Tag());
 
     return a;
 }
@@ -391,6 +395,9 @@ bool Manager::ApplyScheduledAnalyzers(Connection* conn, bool init, packet_analys
     if ( ! parent )
         return false;
 
+    if ( conns.empty() )
+        return false;
+
     tag_set expected = GetScheduled(conn);
 
     for ( tag_set::iterator it = expected.begin(); it != expected.end(); ++it ) {
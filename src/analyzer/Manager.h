@@ -237,6 +237,32 @@ public:
      */
     Analyzer* InstantiateAnalyzer(const char* name, Connection* c);
 
+    /**
+     * Instantiates a new analyzer instance for a connection.
+     *
+     * @param c The analyzer's component.
+     *
+     * @param conn The connection the analyzer is to be associated with.
+     *
+     * @return The new analyzer instance. Note that the analyzer will not
+     * have been added to the connection's analyzer tree yet. Returns
+     * null if the requested analyzer is disabled or can't be instantiated.
+     */
+    Analyzer* InstantiateAnalyzer(Component* c, Connection* conn);
+
+    /**
+     * Returns a counter that changes whenever analyzers get enabled or
+     * disabled, or their port registrations change. Callers caching
+     * decisions derived from that state compare it to invalidate them.
+     */
+    uint64_t ConfigGeneration() const { return config_generation; }
+
+    /**
+     * Marks cached decisions derived from the analyzer configuration as
+     * stale. See ConfigGeneration().
+     */
+    void BumpConfigGeneration() { ++config_generation; }
+
     /**
      * Schedules a particular analyzer for an upcoming connection. Once
      * the connection is seen, BuildInitAnalyzerTree() will add the
@@ -371,6 +397,7 @@ private:
         std::priority_queue<ScheduledAnalyzer*, std::vector<ScheduledAnalyzer*>, ScheduledAnalyzer::Comparator>;
 
     bool initialized = false;
+    uint64_t config_generation = 0;
     protocol_analyzers pending_analyzers_for_ports;
 
     conns_map conns;
@@ -11,10 +11,13 @@
 #include <cctype>
 
 #include "zeek/Event.h"
+#include "zeek/Func.h"
 #include "zeek/NetVar.h"
 #include "zeek/RunState.h"
 #include "zeek/ZeekString.h"
+#include "zeek/analyzer/protocol/dns/consts.bif.h"
 #include "zeek/analyzer/protocol/dns/events.bif.h"
+#include "zeek/logging/Manager.h"
 #include "zeek/session/Manager.h"
 
 namespace zeek::analyzer::dns {
@@ -30,6 +33,14 @@ DNS_Interpreter::DNS_Interpreter(analyzer::Analyzer* arg_analyzer) {
     first_message = true;
     is_netbios =
         ntohs(analyzer->Conn()->OrigPort()) == NETBIOS_PORT || ntohs(analyzer->Conn()->RespPort()) == NETBIOS_PORT;
+
+    if ( BifConst::DNS::native_logging )
+        native_log = std::make_unique<DNS_NativeLog>(analyzer);
+}
+
+void DNS_Interpreter::Done() {
+    if ( native_log )
+        native_log->Flush();
 }
 
 void DNS_Interpreter::ParseMessage(const u_char* data, int len, int is_query) {
@@ -70,6 +81,9 @@ void DNS_Interpreter::ParseMessage(const u_char* data, int len, int is_query) {
         analyzer->EnqueueConnEvent(dns_message, analyzer->ConnVal(), val_mgr->Bool(is_query), msg.BuildHdrVal(),
                                    val_mgr->Count(len));
 
+    if ( native_log )
+        native_log->BeginMessage(&msg);
+
     // There is a great deal of non-DNS traffic that runs on port 53.
     // This should weed out most of it.
     if ( zeek::detail::dns_max_queries > 0 && msg.qdcount > zeek::detail::dns_max_queries ) {
@@ -137,6 +151,9 @@ void DNS_Interpreter::ParseMessage(const u_char* data, int len, int is_query) {
 void DNS_Interpreter::EndMessage(detail::DNS_MsgInfo* msg) {
     if ( dns_end )
         analyzer->EnqueueConnEvent(dns_end, analyzer->ConnVal(), msg->BuildHdrVal());
+
+    if ( native_log )
+        native_log->EndMessage(msg);
 }
 
 bool DNS_Interpreter::ParseQuestions(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, const u_char* msg_start) {
@@ -182,7 +199,7 @@ bool DNS_Interpreter::ParseQuestion(detail::DNS_MsgInfo* msg, const u_char*& dat
     else
         dns_event = dns_query_reply;
 
-    if ( dns_event && ! msg->skip_event ) {
+    if ( (dns_event || native_log) && ! msg->skip_event ) {
         String* original_name = new String(name, name_end - name, true);
 
         // Downcase the Name to normalize it
@@ -309,6 +326,9 @@ bool DNS_Interpreter::ParseAnswer(detail::DNS_MsgInfo* msg, const u_char*& data,
                 analyzer->EnqueueConnEvent(dns_unknown_reply, analyzer->ConnVal(), msg->BuildHdrVal(),
                                            msg->BuildAnswerVal());
 
+            if ( LogReply(msg) )
+                native_log->Reply(msg, util::fmt("<unknown type=%d>", msg->atype));
+
             analyzer->Weird("DNS_RR_unknown_type", util::fmt("%d", msg->atype));
             data += rdlength;
             len -= rdlength;
@@ -496,6 +516,9 @@ bool DNS_Interpreter::ParseRR_Name(detail::DNS_MsgInfo* msg, const u_char*& data
         analyzer->EnqueueConnEvent(reply_event, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    make_intrusive<StringVal>(new String(name, name_end - name, true)));
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, std::string(reinterpret_cast<const char*>(name), name_end - name));
+
     return true;
 }
 
@@ -544,6 +567,9 @@ bool DNS_Interpreter::ParseRR_SOA(detail::DNS_MsgInfo* msg, const u_char*& data,
                                    std::move(r));
     }
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, std::string(reinterpret_cast<const char*>(mname), mname_end - mname));
+
     return true;
 }
 
@@ -568,6 +594,9 @@ bool DNS_Interpreter::ParseRR_MX(detail::DNS_MsgInfo* msg, const u_char*& data,
                                    make_intrusive<StringVal>(new String(name, name_end - name, true)),
                                    val_mgr->Count(preference));
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, std::string(reinterpret_cast<const char*>(name), name_end - name));
+
     return true;
 }
 
@@ -601,6 +630,9 @@ bool DNS_Interpreter::ParseRR_SRV(detail::DNS_MsgInfo* msg, const u_char*& data,
                                    make_intrusive<StringVal>(new String(name, name_end - name, true)),
                                    val_mgr->Count(priority), val_mgr->Count(weight), val_mgr->Count(port));
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, std::string(reinterpret_cast<const char*>(name), name_end - name));
+
     return true;
 }
 
@@ -891,7 +923,7 @@ bool DNS_Interpreter::ParseRR_TKEY(detail::DNS_MsgInfo* msg, const u_char*& data
 
 bool DNS_Interpreter::ParseRR_RRSIG(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                     const u_char* msg_start) {
-    if ( ! dns_RRSIG || msg->skip_event ) {
+    if ( (! dns_RRSIG && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -960,13 +992,20 @@ bool DNS_Interpreter::ParseRR_RRSIG(detail::DNS_MsgInfo* msg, const u_char*& dat
         analyzer->EnqueueConnEvent(dns_RRSIG, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    msg->BuildRRSIG_Val(&rrsig));
     }
+    else
+        delete sign;
+
+    if ( LogReply(msg) ) {
+        std::string signer(reinterpret_cast<const char*>(name), name_end - name);
+        native_log->Reply(msg, util::fmt("RRSIG %u %s", type_covered, signer.empty() ? "<Root>" : signer.c_str()));
+    }
 
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_DNSKEY(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                      const u_char* msg_start) {
-    if ( ! dns_DNSKEY || msg->skip_event ) {
+    if ( (! dns_DNSKEY && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1036,13 +1075,18 @@ bool DNS_Interpreter::ParseRR_DNSKEY(detail::DNS_MsgInfo* msg, const u_char*& da
         analyzer->EnqueueConnEvent(dns_DNSKEY, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    msg->BuildDNSKEY_Val(&dnskey));
     }
+    else
+        delete key;
+
+    if ( LogReply(msg) )
+        native_log->Reply(msg, util::fmt("DNSKEY %u", dalgorithm));
 
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_NSEC(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                    const u_char* msg_start) {
-    if ( ! dns_NSEC || msg->skip_event ) {
+    if ( (! dns_NSEC && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1080,12 +1124,20 @@ bool DNS_Interpreter::ParseRR_NSEC(detail::DNS_MsgInfo* msg, const u_char*& data
                                    make_intrusive<StringVal>(new String(name, name_end - name, true)),
                                    std::move(char_strings));
 
+    if ( LogReply(msg) ) {
+        std::string reply = "NSEC ";
+        reply.append(reinterpret_cast<const char*>(msg->query_name->Bytes()), msg->query_name->Len());
+        reply.append(" ");
+        reply.append(reinterpret_cast<const char*>(name), name_end - name);
+        native_log->Reply(msg, std::move(reply));
+    }
+
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_NSEC3(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                     const u_char* msg_start) {
-    if ( ! dns_NSEC3 || msg->skip_event ) {
+    if ( (! dns_NSEC3 && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1153,13 +1205,20 @@ bool DNS_Interpreter::ParseRR_NSEC3(detail::DNS_MsgInfo* msg, const u_char*& dat
         analyzer->EnqueueConnEvent(dns_NSEC3, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    msg->BuildNSEC3_Val(&nsec3));
     }
+    else {
+        delete salt_val;
+        delete hash_val;
+    }
+
+    if ( LogReply(msg) )
+        native_log->Reply(msg, "NSEC3");
 
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_NSEC3PARAM(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                          const u_char* msg_start) {
-    if ( ! dns_NSEC3PARAM || msg->skip_event ) {
+    if ( (! dns_NSEC3PARAM && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1194,13 +1253,18 @@ bool DNS_Interpreter::ParseRR_NSEC3PARAM(detail::DNS_MsgInfo* msg, const u_char*
         analyzer->EnqueueConnEvent(dns_NSEC3PARAM, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    msg->BuildNSEC3PARAM_Val(&nsec3param));
     }
+    else
+        delete salt_value;
+
+    if ( LogReply(msg) )
+        native_log->Reply(msg, "NSEC3PARAM");
 
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_DS(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                  const u_char* msg_start) {
-    if ( ! dns_DS || msg->skip_event ) {
+    if ( (! dns_DS && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1236,13 +1300,18 @@ bool DNS_Interpreter::ParseRR_DS(detail::DNS_MsgInfo* msg, const u_char*& data,
         analyzer->EnqueueConnEvent(dns_DS, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    msg->BuildDS_Val(&ds));
     }
+    else
+        delete ds_digest;
+
+    if ( LogReply(msg) )
+        native_log->Reply(msg, util::fmt("DS %u %u", ds_algo, ds_dtype));
 
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_BINDS(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                     const u_char* msg_start) {
-    if ( ! dns_BINDS || msg->skip_event ) {
+    if ( (! dns_BINDS && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1272,13 +1341,18 @@ bool DNS_Interpreter::ParseRR_BINDS(detail::DNS_MsgInfo* msg, const u_char*& dat
         analyzer->EnqueueConnEvent(dns_BINDS, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    msg->BuildBINDS_Val(&binds));
     }
+    else
+        delete completeflag;
+
+    if ( LogReply(msg) )
+        native_log->Reply(msg, "BIND9 signing signal");
 
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_SSHFP(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                     const u_char* msg_start) {
-    if ( ! dns_SSHFP || msg->skip_event ) {
+    if ( (! dns_SSHFP && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1293,18 +1367,29 @@ bool DNS_Interpreter::ParseRR_SSHFP(detail::DNS_MsgInfo* msg, const u_char*& dat
 
     String* fingerprint = ExtractStream(data, len, rdlength - 2);
 
+    if ( LogReply(msg) ) {
+        std::string reply = "SSHFP: ";
+
+        for ( int i = 0; i < fingerprint->Len(); ++i )
+            reply.append(util::fmt("%02x", fingerprint->Bytes()[i]));
+
+        native_log->Reply(msg, std::move(reply));
+    }
+
     if ( dns_SSHFP ) {
         analyzer->EnqueueConnEvent(dns_SSHFP, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    val_mgr->Count(algo), val_mgr->Count(fptype),
                                    make_intrusive<StringVal>(fingerprint));
     }
+    else
+        delete fingerprint;
 
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_LOC(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                   const u_char* msg_start) {
-    if ( ! dns_LOC || msg->skip_event ) {
+    if ( (! dns_LOC && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1345,6 +1430,9 @@ bool DNS_Interpreter::ParseRR_LOC(detail::DNS_MsgInfo* msg, const u_char*& data,
                                    msg->BuildLOC_Val(&loc));
     }
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, util::fmt("LOC:  %u %u %u", size, horiz_pre, vert_pre));
+
     return true;
 }
 
@@ -1360,6 +1448,12 @@ bool DNS_Interpreter::ParseRR_A(detail::DNS_MsgInfo* msg, const u_char*& data, i
         analyzer->EnqueueConnEvent(dns_A_reply, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    make_intrusive<AddrVal>(htonl(addr)));
 
+    if ( LogReply(msg) ) {
+        in_addr a;
+        a.s_addr = htonl(addr);
+        native_log->Reply(msg, IPAddr(a).AsString());
+    }
+
     return true;
 }
 
@@ -1388,18 +1482,25 @@ bool DNS_Interpreter::ParseRR_AAAA(detail::DNS_MsgInfo* msg, const u_char*& data
         analyzer->EnqueueConnEvent(event, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    make_intrusive<AddrVal>(addr));
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, IPAddr(IPv6, addr, IPAddr::Network).AsString());
+
     return true;
 }
 
 bool DNS_Interpreter::ParseRR_WKS(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength) {
-    if ( ! dns_WKS_reply || msg->skip_event ) {
+    if ( (! dns_WKS_reply && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
     }
 
     // TODO: Pass the ports as parameters to the event
-    analyzer->EnqueueConnEvent(dns_WKS_reply, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal());
+    if ( dns_WKS_reply )
+        analyzer->EnqueueConnEvent(dns_WKS_reply, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal());
+
+    if ( LogReply(msg) )
+        native_log->Reply(msg, "");
 
     // TODO: Return a status which reflects if the port parameters were successfully parsed
     return true;
@@ -1429,6 +1530,23 @@ static StringValPtr extract_char_string(analyzer::Analyzer* analyzer, const u_ch
     return rval;
 }
 
+// The dns.log summary of TXT and SPF records.
+static std::string char_strings_reply(const char* type, const VectorValPtr& char_strings) {
+    std::string reply;
+
+    for ( unsigned int i = 0; i < char_strings->Size(); ++i ) {
+        const auto* s = char_strings->StringAt(i);
+
+        if ( i > 0 )
+            reply.append(" ");
+
+        reply.append(util::fmt("%s %d ", type, s->Len()));
+        reply.append(reinterpret_cast<const char*>(s->Bytes()), s->Len());
+    }
+
+    return reply;
+}
+
 bool DNS_Interpreter::ParseRR_HINFO(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength) {
     if ( ! dns_HINFO_reply || msg->skip_event ) {
         data += rdlength;
@@ -1447,7 +1565,7 @@ bool DNS_Interpreter::ParseRR_HINFO(detail::DNS_MsgInfo* msg, const u_char*& dat
 
 bool DNS_Interpreter::ParseRR_TXT(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                   const u_char* msg_start) {
-    if ( ! dns_TXT_reply || msg->skip_event ) {
+    if ( (! dns_TXT_reply && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1459,6 +1577,9 @@ bool DNS_Interpreter::ParseRR_TXT(detail::DNS_MsgInfo* msg, const u_char*& data,
     while ( (char_string = extract_char_string(analyzer, data, len, rdlength)) )
         char_strings->Assign(char_strings->Size(), std::move(char_string));
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, char_strings_reply("TXT", char_strings));
+
     if ( dns_TXT_reply )
         analyzer->EnqueueConnEvent(dns_TXT_reply, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    std::move(char_strings));
@@ -1468,7 +1589,7 @@ bool DNS_Interpreter::ParseRR_TXT(detail::DNS_MsgInfo* msg, const u_char*& data,
 
 bool DNS_Interpreter::ParseRR_SPF(detail::DNS_MsgInfo* msg, const u_char*& data, int& len, int rdlength,
                                   const u_char* msg_start) {
-    if ( ! dns_SPF_reply || msg->skip_event ) {
+    if ( (! dns_SPF_reply && ! LogReply(msg)) || msg->skip_event ) {
         data += rdlength;
         len -= rdlength;
         return true;
@@ -1480,6 +1601,9 @@ bool DNS_Interpreter::ParseRR_SPF(detail::DNS_MsgInfo* msg, const u_char*& data,
     while ( (char_string = extract_char_string(analyzer, data, len, rdlength)) )
         char_strings->Assign(char_strings->Size(), std::move(char_string));
 
+    if ( LogReply(msg) )
+        native_log->Reply(msg, char_strings_reply("SPF", char_strings));
+
     if ( dns_SPF_reply )
         analyzer->EnqueueConnEvent(dns_SPF_reply, analyzer->ConnVal(), msg->BuildHdrVal(), msg->BuildAnswerVal(),
                                    std::move(char_strings));
@@ -1582,7 +1706,14 @@ void DNS_Interpreter::SendReplyOrRejectEvent(detail::DNS_MsgInfo* msg, EventHand
     detail::RR_Type qtype = detail::RR_Type(ExtractShort(data, len));
     int qclass = ExtractShort(data, len);
 
-    assert(event);
+    if ( native_log )
+        native_log->Question(msg, question_name, qtype, qclass);
+
+    if ( ! event ) {
+        delete question_name;
+        delete original_name;
+        return;
+    }
 
     analyzer->EnqueueConnEvent(event, analyzer->ConnVal(), msg->BuildHdrVal(), make_intrusive<StringVal>(question_name),
                                val_mgr->Count(qtype), val_mgr->Count(qclass), make_intrusive<StringVal>(original_name));
@@ -1890,6 +2021,273 @@ RecordValPtr DNS_MsgInfo::BuildSVCB_Val(const SVCB_DATA& svcb) {
     return r;
 }
 
+namespace {
+
+// Offsets of the DNS::Info fields the native dns.log mode fills in.
+struct InfoFields {
+    RecordTypePtr type = id::find_type<RecordType>("DNS::Info");
+    int ts = type->FieldOffset("ts");
+    int uid = type->FieldOffset("uid");
+    int id = type->FieldOffset("id");
+    int proto = type->FieldOffset("proto");
+    int trans_id = type->FieldOffset("trans_id");
+    int rtt = type->FieldOffset("rtt");
+    int query = type->FieldOffset("query");
+    int qclass = type->FieldOffset("qclass");
+    int qclass_name = type->FieldOffset("qclass_name");
+    int qtype = type->FieldOffset("qtype");
+    int qtype_name = type->FieldOffset("qtype_name");
+    int rcode = type->FieldOffset("rcode");
+    int rcode_name = type->FieldOffset("rcode_name");
+    int AA = type->FieldOffset("AA");
+    int TC = type->FieldOffset("TC");
+    int RD = type->FieldOffset("RD");
+    int RA = type->FieldOffset("RA");
+    int Z = type->FieldOffset("Z");
+    int answers = type->FieldOffset("answers");
+    int TTLs = type->FieldOffset("TTLs");
+    int rejected = type->FieldOffset("rejected");
+    int total_answers = type->FieldOffset("total_answers");
+    int total_replies = type->FieldOffset("total_replies");
+    int saw_query = type->FieldOffset("saw_query");
+    int saw_reply = type->FieldOffset("saw_reply");
+};
+
+const InfoFields& info_fields() {
+    static const InfoFields fields;
+    return fields;
+}
+
+} // namespace
+
+DNS_NativeLog::DNS_NativeLog(analyzer::Analyzer* arg_analyzer) : analyzer(arg_analyzer) {}
+
+void DNS_NativeLog::BeginMessage(const DNS_MsgInfo* msg) {
+    // Currently only standard queries are tracked.
+    if ( msg->opcode == DNS_OP_QUERY )
+        SetSession(msg, ! msg->QR);
+}
+
+void DNS_NativeLog::Question(const DNS_MsgInfo* msg, const String* query, int qtype, int qclass) {
+    const auto& f = info_fields();
+
+    if ( msg->QR ) {
+        // Same condition as for raising dns_rejected.
+        if ( current && msg->ancount == 0 && msg->nscount == 0 && msg->arcount == 0 )
+            current->Assign(f.rejected, true);
+
+        return;
+    }
+
+    if ( msg->opcode != DNS_OP_QUERY )
+        return;
+
+    static auto classes = id::find_val<TableVal>("DNS::classes");
+    static auto query_types = id::find_val<TableVal>("DNS::query_types");
+
+    auto qtype_name = query_types->FindOrDefault(val_mgr->Count(qtype));
+    auto query_val = make_intrusive<StringVal>(new String(*query));
+
+    current->Assign(f.RD, static_cast<bool>(msg->RD));
+    current->Assign(f.TC, static_cast<bool>(msg->TC));
+    current->Assign(f.qclass, qclass);
+    current->Assign(f.qclass_name, classes->FindOrDefault(val_mgr->Count(qclass)));
+    current->Assign(f.qtype, qtype);
+    current->Assign(f.Z, msg->Z);
+
+    // Decode NetBIOS name queries.
+    if ( analyzer->Conn()->ConnTransport() == TRANSPORT_UDP && ntohs(analyzer->Conn()->RespPort()) == NETBIOS_PORT ) {
+        static auto decode_netbios_name = id::find_func("decode_netbios_name");
+        auto decoded = decode_netbios_name->Invoke(query_val);
+
+        if ( decoded && decoded->AsString()->Len() != 0 )
+            query_val = cast_intrusive<StringVal>(std::move(decoded));
+
+        // The SRV RFC used the ID used for NetBIOS Status RRs.
+        if ( qtype_name->AsString()->CheckString() == std::string_view("SRV") )
+            qtype_name = make_intrusive<StringVal>("NBSTAT");
+    }
+
+    current->Assign(f.qtype_name, std::move(qtype_name));
+    current->Assign(f.query, std::move(query_val));
+}
+
+void DNS_NativeLog::Reply(const DNS_MsgInfo* msg, std::string reply) {
+    if ( ! current )
+        return;
+
+    const auto& f = info_fields();
+
+    if ( ! current->HasField(f.query) )
+        current->Assign(f.query, msg->query_name);
+
+    current->Assign(f.AA, static_cast<bool>(msg->AA));
+    current->Assign(f.RA, static_cast<bool>(msg->RA));
+
+    if ( ! current->HasField(f.rtt) ) {
+        // A zero RTT likely means that only the reply was seen.
+        double rtt = run_state::network_time - current->GetFieldAs<TimeVal>(f.ts);
+
+        if ( rtt != 0.0 )
+            current->AssignInterval(f.rtt, rtt);
+    }
+
+    if ( reply.empty() )
+        return;
+
+    if ( ! current->HasField(f.answers) ) {
+        current->Assign(f.answers, make_intrusive<VectorVal>(f.type->GetFieldType<VectorType>(f.answers)));
+        current->Assign(f.TTLs, make_intrusive<VectorVal>(f.type->GetFieldType<VectorType>(f.TTLs)));
+    }
+
+    auto answers = current->GetField<VectorVal>(f.answers);
+    answers->Assign(answers->Size(), make_intrusive<StringVal>(std::move(reply)));
+
+    auto ttls = current->GetField<VectorVal>(f.TTLs);
+    ttls->Assign(ttls->Size(), make_intrusive<IntervalVal>(double(msg->ttl)));
+}
+
+void DNS_NativeLog::EndMessage(const DNS_MsgInfo* msg) {
+    if ( ! current )
+        return;
+
+    const auto& f = info_fields();
+    current->Assign(msg->QR ? f.saw_reply : f.saw_query, true);
+
+    if ( current->GetFieldAs<BoolVal>(f.saw_reply) && current->GetFieldAs<BoolVal>(f.saw_query) ) {
+        Write(current);
+        current = nullptr;
+    }
+}
+
+void DNS_NativeLog::Flush() {
+    if ( pending_query ) {
+        Write(pending_query);
+        pending_query = nullptr;
+    }
+
+    WriteAll(pending_queries);
+    WriteAll(pending_replies);
+}
+
+RecordValPtr DNS_NativeLog::NewSession(int trans_id) {
+    const auto& f = info_fields();
+    auto conn_val = analyzer->ConnVal();
+    auto info = make_intrusive<RecordVal>(f.type);
+
+    info->AssignTime(f.ts, run_state::network_time);
+    info->Assign(f.uid, conn_val->GetField("uid"));
+    info->Assign(f.id, conn_val->GetField("id"));
+    info->Assign(f.proto, id::transport_proto->GetEnumVal(analyzer->Conn()->ConnTransport()));
+    info->Assign(f.trans_id, trans_id);
+
+    return info;
+}
+
+void DNS_NativeLog::SetSession(const DNS_MsgInfo* msg, bool is_query) {
+    if ( is_query ) {
+        auto it = pending_replies.find(msg->id);
+
+        if ( it != pending_replies.end() )
+            // Match this query with what's at the head of the pending reply queue.
+            current = Pop(pending_replies, msg->id);
+        else {
+            // Wait for a matching reply.
+            current = NewSession(msg->id);
+
+            if ( ! pending_query )
+                pending_query = current;
+            else
+                Enqueue(pending_queries, msg->id, current);
+        }
+    }
+    else {
+        const auto& f = info_fields();
+
+        if ( pending_query && pending_query->GetFieldAs<CountVal>(f.trans_id) == static_cast<zeek_uint_t>(msg->id) ) {
+            current = std::move(pending_query);
+
+            // Refill the fast path from the pending queries, preferring one
+            // with the same ID, so that queries keep their overall order.
+            if ( pending_queries.count(msg->id) )
+                pending_query = Pop(pending_queries, msg->id);
+            else if ( ! pending_queries.empty() )
+                pending_query = Pop(pending_queries, pending_queries.begin()->first);
+        }
+        else if ( pending_queries.count(msg->id) )
+            // Match this reply with what's at the head of the pending query queue.
+            current = Pop(pending_queries, msg->id);
+        else {
+            // Wait for a matching query.
+            current = NewSession(msg->id);
+            Enqueue(pending_replies, msg->id, current);
+        }
+
+        current->Assign(f.rcode, msg->rcode);
+
+        static auto base_errors = id::find_val<TableVal>("DNS::base_errors");
+        current->Assign(f.rcode_name, base_errors->FindOrDefault(val_mgr->Count(msg->rcode)));
+
+        if ( ! current->HasField(f.total_answers) )
+            current->Assign(f.total_answers, msg->ancount);
+
+        if ( ! current->HasField(f.total_replies) )
+            current->Assign(f.total_replies, msg->ancount + msg->arcount + msg->nscount);
+
+        if ( msg->rcode != 0 && msg->qdcount == 0 )
+            current->Assign(f.rejected, true);
+    }
+}
+
+void DNS_NativeLog::Enqueue(PendingMessages& msgs, int id, RecordValPtr info) {
+    static const auto& max_pending_msgs = id::find("DNS::max_pending_msgs");
+    static const auto& max_pending_query_ids = id::find("DNS::max_pending_query_ids");
+
+    auto it = msgs.find(id);
+
+    if ( it == msgs.end() ) {
+        // Throw away all unmatched on the assumption they'll never be matched.
+        if ( msgs.size() > max_pending_query_ids->GetVal()->AsCount() )
+            WriteAll(msgs);
+
+        it = msgs.emplace(id, std::deque<RecordValPtr>{}).first;
+    }
+    else if ( it->second.size() > max_pending_msgs->GetVal()->AsCount() ) {
+        for ( const auto& i : it->second )
+            Write(i);
+
+        it->second.clear();
+    }
+
+    it->second.push_back(std::move(info));
+}
+
+RecordValPtr DNS_NativeLog::Pop(PendingMessages& msgs, int id) {
+    auto it = msgs.find(id);
+    auto info = std::move(it->second.front());
+    it->second.pop_front();
+
+    if ( it->second.empty() )
+        msgs.erase(it);
+
+    return info;
+}
+
+void DNS_NativeLog::Write(const RecordValPtr& info) {
+    static auto log_ids = id::find_type<EnumType>("Log::ID");
+    static auto log_id = log_ids->GetEnumVal(log_ids->Lookup("DNS", "LOG"));
+
+    log_mgr->Write(log_id.get(), info.get());
+}
+
+void DNS_NativeLog::WriteAll(PendingMessages& msgs) {
+    for ( const auto& [_, q] : msgs )
+        for ( const auto& info : q )
+            Write(info);
+
+    msgs.clear();
+}
+
 } // namespace detail
 
 Contents_DNS::Contents_DNS(Connection* conn, bool orig, detail::DNS_Interpreter* arg_interp)
@@ -1999,6 +2397,8 @@ void DNS_Analyzer::Done() {
         Event(udp_session_done);
     else
         interp->Timeout();
+
+    interp->Done();
 }
 
 void DNS_Analyzer::DeliverPacket(int len, const u_char* data, bool orig, uint64_t seq, const IP_Hdr* ip, int caplen) {
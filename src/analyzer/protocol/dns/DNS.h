@@ -2,6 +2,11 @@
 
 #pragma once
 
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+
 #include "zeek/analyzer/protocol/tcp/TCP.h"
 #include "zeek/binpac_zeek.h"
 
@@ -328,6 +333,72 @@ public:
     ///< for forward lookups
 };
 
+/**
+ * Builds the connection's dns.log records in the analyzer when
+ * DNS::native_logging is set, instead of base/protocols/dns assembling them
+ * from the analyzer's events. It follows what that script does: queries and
+ * replies get matched by transaction ID, the answers section of replies is
+ * summarized into the answers and TTLs columns, and a record gets written
+ * once both its query and reply have been seen.
+ */
+class DNS_NativeLog final {
+public:
+    explicit DNS_NativeLog(analyzer::Analyzer* analyzer);
+
+    /**
+     * Starts a message, after its header has been parsed. Corresponds to
+     * the script's dns_message handler.
+     */
+    void BeginMessage(const DNS_MsgInfo* msg);
+
+    /**
+     * Records a question of the current message. Corresponds to the
+     * script's dns_request and dns_rejected handlers.
+     */
+    void Question(const DNS_MsgInfo* msg, const String* query, int qtype, int qclass);
+
+    /**
+     * Returns whether Reply() wants a summary of the resource record
+     * that's being parsed.
+     */
+    bool WantsReply(const DNS_MsgInfo* msg) const {
+        return msg->opcode == DNS_OP_QUERY && msg->QR && msg->answer_type == DNS_ANSWER && ! msg->skip_event;
+    }
+
+    /**
+     * Adds the summary of a resource record in the answers section.
+     * Corresponds to the script's DNS::do_reply hook.
+     */
+    void Reply(const DNS_MsgInfo* msg, std::string reply);
+
+    /**
+     * Finishes a message, writing the current record if both its query
+     * and reply have been seen.
+     */
+    void EndMessage(const DNS_MsgInfo* msg);
+
+    /**
+     * Writes all records still waiting for their query or reply.
+     */
+    void Flush();
+
+private:
+    using PendingMessages = std::map<int, std::deque<RecordValPtr>>;
+
+    RecordValPtr NewSession(int trans_id);
+    void SetSession(const DNS_MsgInfo* msg, bool is_query);
+    void Enqueue(PendingMessages& msgs, int id, RecordValPtr info);
+    RecordValPtr Pop(PendingMessages& msgs, int id);
+    void Write(const RecordValPtr& info);
+    void WriteAll(PendingMessages& msgs);
+
+    analyzer::Analyzer* analyzer;
+    RecordValPtr current;       // The script's c$dns.
+    RecordValPtr pending_query; // The script's c$dns_state fields.
+    PendingMessages pending_queries;
+    PendingMessages pending_replies;
+};
+
 class DNS_Interpreter final {
 public:
     explicit DNS_Interpreter(analyzer::Analyzer* analyzer);
@@ -336,6 +407,12 @@ public:
 
     void Timeout() {}
 
+    /**
+     * Called when the analyzer is done, writes what the native dns.log
+     * mode still has pending.
+     */
+    void Done();
+
 protected:
     void EndMessage(detail::DNS_MsgInfo* msg);
 
@@ -388,9 +465,14 @@ protected:
     void SendReplyOrRejectEvent(detail::DNS_MsgInfo* msg, EventHandlerPtr event, const u_char*& data, int& len,
                                 String* question_name, String* original_name);
 
+    // Whether the native dns.log mode wants a summary of the current
+    // resource record.
+    bool LogReply(const detail::DNS_MsgInfo* msg) const { return native_log && native_log->WantsReply(msg); }
+
     analyzer::Analyzer* analyzer;
     bool first_message;
     bool is_netbios;
+    std::unique_ptr<DNS_NativeLog> native_log; // Set if DNS::native_logging is.
 };
 
 enum TCP_DNS_state {
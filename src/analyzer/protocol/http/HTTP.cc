@@ -321,7 +321,9 @@ void HTTP_Entity::SetPlainDelivery(int64_t length) {
 }
 
 void HTTP_Entity::SubmitHeader(analyzer::mime::MIME_Header* h) {
-    if ( analyzer::mime::istrequal(h->get_name(), "content-length") ) {
+    int name = h->get_known_name();
+
+    if ( name == analyzer::mime::MIME_HEADER_CONTENT_LENGTH ) {
         data_chunk_t vt = h->get_value_token();
         if ( ! analyzer::mime::is_null_data_chunk(vt) ) {
             int64_t n;
@@ -343,7 +345,7 @@ void HTTP_Entity::SubmitHeader(analyzer::mime::MIME_Header* h) {
     }
 
     // Figure out content-length for HTTP 206 Partial Content response
-    else if ( analyzer::mime::istrequal(h->get_name(), "content-range") &&
+    else if ( name == analyzer::mime::MIME_HEADER_CONTENT_RANGE &&
               http_message->MyHTTP_Analyzer()->HTTP_ReplyCode() == 206 ) {
         data_chunk_t vt = h->get_value_token();
         string byte_unit(vt.data, vt.length);
@@ -421,7 +423,7 @@ void HTTP_Entity::SubmitHeader(analyzer::mime::MIME_Header* h) {
         }
     }
 
-    else if ( analyzer::mime::istrequal(h->get_name(), "transfer-encoding") ) {
+    else if ( name == analyzer::mime::MIME_HEADER_TRANSFER_ENCODING ) {
         HTTP_Analyzer::HTTP_VersionNumber http_version;
 
         if ( http_message->analyzer->GetRequestOngoing() )
@@ -434,7 +436,7 @@ void HTTP_Entity::SubmitHeader(analyzer::mime::MIME_Header* h) {
             chunked_transfer_state = BEFORE_CHUNK;
     }
 
-    else if ( analyzer::mime::istrequal(h->get_name(), "content-encoding") ) {
+    else if ( name == analyzer::mime::MIME_HEADER_CONTENT_ENCODING ) {
         data_chunk_t vt = h->get_value_token();
         if ( analyzer::mime::istrequal(vt, "gzip") || analyzer::mime::istrequal(vt, "x-gzip") )
             encoding = GZIP;
@@ -1532,19 +1534,21 @@ void HTTP_Analyzer::HTTP_Header(bool is_orig, analyzer::mime::MIME_Header* h) {
     // side, and if seen assume the connection to be persistent.
     // This seems fairly safe - at worst, the client does indeed
     // send additional requests, and the server ignores them.
-    if ( is_orig && analyzer::mime::istrequal(h->get_name(), "connection") ) {
+    int name = h->get_known_name();
+
+    if ( is_orig && name == analyzer::mime::MIME_HEADER_CONNECTION ) {
         if ( analyzer::mime::istrequal(h->get_value_token(), "keep-alive") )
             keep_alive = 1;
     }
 
-    if ( ! is_orig && analyzer::mime::istrequal(h->get_name(), "connection") ) {
+    if ( ! is_orig && name == analyzer::mime::MIME_HEADER_CONNECTION ) {
         if ( analyzer::mime::istrequal(h->get_value_token(), "close") )
             connection_close = 1;
         else if ( analyzer::mime::istrequal(h->get_value_token(), "upgrade") )
             upgrade_connection = true;
     }
 
-    if ( ! is_orig && analyzer::mime::istrequal(h->get_name(), "upgrade") )
+    if ( ! is_orig && name == analyzer::mime::MIME_HEADER_UPGRADE )
         upgrade_protocol.assign(h->get_value_token().data, h->get_value_token().length);
 
     if ( http_header ) {
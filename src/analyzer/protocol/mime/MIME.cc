@@ -3,6 +3,8 @@
 #include "zeek/zeek-config.h"
 
 #include <openssl/evp.h>
+#include <array>
+#include <cstring>
 
 #include "zeek/Base64.h"
 #include "zeek/NetVar.h"
@@ -12,6 +14,8 @@
 #include "zeek/digest.h"
 #include "zeek/file_analysis/Manager.h"
 
+#include "zeek/3rdparty/doctest.h"
+
 // Here are a few things to do:
 //
 // 1. Add a Zeek internal function 'stop_deliver_data_of_entity' so
@@ -30,12 +34,6 @@ int mime_header_only = 0;
 int mime_decode_data = 1;
 int mime_submit_data = 1;
 
-enum MIME_HEADER_FIELDS {
-    MIME_CONTENT_TYPE,
-    MIME_CONTENT_TRANSFER_ENCODING,
-    MIME_FIELD_OTHER,
-};
-
 enum MIME_CONTENT_SUBTYPE {
     CONTENT_SUBTYPE_MIXED,       // for multipart
     CONTENT_SUBTYPE_ALTERNATIVE, // for multipart
@@ -65,9 +63,12 @@ enum MIME_BOUNDARY_DELIMITER {
     MULTIPART_CLOSING_BOUNDARY,
 };
 
-static const char* MIMEHeaderName[] = {
-    "content-type",
-    "content-transfer-encoding",
+// Indexed by MIME_KNOWN_HEADER.
+static const char* MIMEKnownHeaderName[] = {
+    "content-type",     "content-transfer-encoding",
+    "content-length",   "content-range",
+    "content-encoding", "transfer-encoding",
+    "connection",       "upgrade",
     nullptr,
 };
 
@@ -136,6 +137,34 @@ bool istrequal(data_chunk_t s, const char* t) {
     return strncasecmp(s.data, t, len) == 0;
 }
 
+int MIME_lookup_known_header(data_chunk_t name) {
+    // The names' lengths are distinct modulo the table size, which makes
+    // them a perfect hash: each name needs to be compared against at most
+    // one candidate. The assertion catches additions that break this.
+    static const auto table = [] {
+        std::array<int, 16> t;
+        t.fill(MIME_HEADER_OTHER);
+
+        for ( int i = 0; MIMEKnownHeaderName[i] != nullptr; ++i ) {
+            auto slot = strlen(MIMEKnownHeaderName[i]) % t.size();
+            assert(t[slot] == MIME_HEADER_OTHER);
+            t[slot] = i;
+        }
+
+        return t;
+    }();
+
+    if ( name.length <= 0 )
+        return MIME_HEADER_OTHER;
+
+    int i = table[name.length % table.size()];
+
+    if ( i != MIME_HEADER_OTHER && istrequal(name, MIMEKnownHeaderName[i]) )
+        return i;
+
+    return MIME_HEADER_OTHER;
+}
+
 int MIME_count_leading_lws(int len, const char* data) {
     int i;
     for ( i = 0; i < len; ++i )
@@ -382,10 +411,18 @@ void MIME_Multiline::append(int len, const char* data) { buffer.push_back(new St
 
 String* MIME_Multiline::get_concatenated_line() {
     if ( buffer.empty() )
-        return nullptr;
+        return line;
 
     delete line;
-    line = concatenate(buffer);
+
+    if ( buffer.size() == 1 ) {
+        // Most headers fit on a single line, so take over its copy rather
+        // than making another one.
+        line = const_cast<String*>(buffer.front());
+        buffer.clear();
+    }
+    else
+        line = concatenate(buffer);
 
     return line;
 }
@@ -393,6 +430,7 @@ String* MIME_Multiline::get_concatenated_line() {
 MIME_Header::MIME_Header(MIME_Multiline* hl) {
     lines = hl;
     name = value = value_token = rest_value = null_data_chunk;
+    known_name = MIME_HEADER_OTHER;
 
     String* s = hl->get_concatenated_line();
     int len = s->Len();
@@ -414,9 +452,13 @@ MIME_Header::MIME_Header(MIME_Multiline* hl) {
             ++value.data;
         }
     }
-    else
+    else {
         // malformed header line
         name = null_data_chunk;
+        return;
+    }
+
+    known_name = MIME_lookup_known_header(name);
 }
 
 MIME_Header::~MIME_Header() { delete lines; }
@@ -464,7 +506,7 @@ void MIME_Entity::init() {
     end_of_data = 0;
 
     current_header_line = nullptr;
-    current_field_type = MIME_FIELD_OTHER;
+    current_field_type = MIME_HEADER_OTHER;
 
     need_to_parse_parameters = 0;
 
@@ -654,25 +696,25 @@ void MIME_Entity::FinishHeader() {
 }
 
 int MIME_Entity::LookupMIMEHeaderName(data_chunk_t name) {
-    // A linear lookup should be fine for now.
-    // header names are case-insensitive (RFC 822, 2822, 2045).
-
-    for ( int i = 0; MIMEHeaderName[i] != nullptr; ++i )
-        if ( istrequal(name, MIMEHeaderName[i]) )
-            return i;
-    return -1;
+    // Only the two names the entity parses itself are known here, as
+    // before MIME_lookup_known_header() existed. Others give -1.
+    switch ( int i = MIME_lookup_known_header(name) ) {
+        case MIME_HEADER_CONTENT_TYPE:
+        case MIME_HEADER_CONTENT_TRANSFER_ENCODING: return i;
+        default: return -1;
+    }
 }
 
 void MIME_Entity::ParseMIMEHeader(MIME_Header* h) {
     if ( h == nullptr )
         return;
 
-    current_field_type = LookupMIMEHeaderName(h->get_name());
+    current_field_type = h->get_known_name();
 
     switch ( current_field_type ) {
-        case MIME_CONTENT_TYPE: ParseContentTypeField(h); break;
+        case MIME_HEADER_CONTENT_TYPE: ParseContentTypeField(h); break;
 
-        case MIME_CONTENT_TRANSFER_ENCODING: ParseContentEncodingField(h); break;
+        case MIME_HEADER_CONTENT_TRANSFER_ENCODING: ParseContentEncodingField(h); break;
     }
 }
 
@@ -769,7 +811,7 @@ bool MIME_Entity::ParseFieldParameters(int len, const char* data) {
 
         String* val = nullptr;
 
-        if ( current_field_type == MIME_CONTENT_TYPE && content_type == CONTENT_TYPE_MULTIPART &&
+        if ( current_field_type == MIME_HEADER_CONTENT_TYPE && content_type == CONTENT_TYPE_MULTIPART &&
              istrequal(attr, "boundary") ) {
             // token or quoted-string (and some lenience for characters
             // not explicitly allowed by the RFC, but encountered in the wild)
@@ -1333,3 +1375,36 @@ void MIME_Mail::SubmitEvent(int event_type, const char* detail) {
 }
 
 } // namespace zeek::analyzer::mime
+
+namespace {
+
+zeek::data_chunk_t chunk(const char* s) { return {static_cast<int>(strlen(s)), s}; }
+
+} // namespace
+
+TEST_SUITE_BEGIN("mime known headers");
+
+TEST_CASE("known names in any case") {
+    using namespace zeek::analyzer::mime;
+    CHECK(MIME_lookup_known_header(chunk("Content-Type")) == MIME_HEADER_CONTENT_TYPE);
+    CHECK(MIME_lookup_known_header(chunk("content-transfer-encoding")) == MIME_HEADER_CONTENT_TRANSFER_ENCODING);
+    CHECK(MIME_lookup_known_header(chunk("CONTENT-LENGTH")) == MIME_HEADER_CONTENT_LENGTH);
+    CHECK(MIME_lookup_known_header(chunk("Content-Range")) == MIME_HEADER_CONTENT_RANGE);
+    CHECK(MIME_lookup_known_header(chunk("Content-Encoding")) == MIME_HEADER_CONTENT_ENCODING);
+    CHECK(MIME_lookup_known_header(chunk("Transfer-Encoding")) == MIME_HEADER_TRANSFER_ENCODING);
+    CHECK(MIME_lookup_known_header(chunk("Connection")) == MIME_HEADER_CONNECTION);
+    CHECK(MIME_lookup_known_header(chunk("upgrade")) == MIME_HEADER_UPGRADE);
+}
+
+TEST_CASE("other names") {
+    using namespace zeek::analyzer::mime;
+    CHECK(MIME_lookup_known_header(chunk("")) == MIME_HEADER_OTHER);
+    CHECK(MIME_lookup_known_header(chunk("Host")) == MIME_HEADER_OTHER);
+    // Same length as a known name.
+    CHECK(MIME_lookup_known_header(chunk("User-Agent")) == MIME_HEADER_OTHER);
+    CHECK(MIME_lookup_known_header(chunk("Content-Typo")) == MIME_HEADER_OTHER);
+    // Same slot as a known name, but a different length.
+    CHECK(MIME_lookup_known_header(chunk("X-Content-Type-Options-Upgrade")) == MIME_HEADER_OTHER);
+}
+
+TEST_SUITE_END();
@@ -41,6 +41,19 @@ enum MIME_CONTENT_TYPE {
     CONTENT_TYPE_OTHER, // image | audio | video | application | <other>
 };
 
+// Header names that the MIME and HTTP analyzers act upon.
+enum MIME_KNOWN_HEADER {
+    MIME_HEADER_CONTENT_TYPE,
+    MIME_HEADER_CONTENT_TRANSFER_ENCODING,
+    MIME_HEADER_CONTENT_LENGTH,
+    MIME_HEADER_CONTENT_RANGE,
+    MIME_HEADER_CONTENT_ENCODING,
+    MIME_HEADER_TRANSFER_ENCODING,
+    MIME_HEADER_CONNECTION,
+    MIME_HEADER_UPGRADE,
+    MIME_HEADER_OTHER,
+};
+
 enum MIME_EVENT_TYPE {
     MIME_EVENT_ILLEGAL_FORMAT,
     MIME_EVENT_ILLEGAL_ENCODING,
@@ -63,6 +76,9 @@ public:
     ~MIME_Multiline();
 
     void append(int len, const char* data);
+
+    // Joins the lines appended so far. Must be called only once all of
+    // them have been appended.
     String* get_concatenated_line();
 
 protected:
@@ -78,6 +94,10 @@ public:
     data_chunk_t get_name() const { return name; }
     data_chunk_t get_value() const { return value; }
 
+    // Returns the MIME_KNOWN_HEADER value for the name, so that analyzers
+    // don't need to compare it against each name they are interested in.
+    int get_known_name() const { return known_name; }
+
     data_chunk_t get_value_token();
     data_chunk_t get_value_after_token();
 
@@ -88,6 +108,7 @@ protected:
     data_chunk_t name;
     data_chunk_t value;
     data_chunk_t value_token, rest_value;
+    int known_name;
 };
 
 using MIME_HeaderList = std::vector<MIME_Header*>;
@@ -272,6 +293,7 @@ extern StringValPtr to_string_val(const char* data, const char* end_of_data);
 extern StringValPtr to_string_val(const data_chunk_t buf);
 extern int fputs(data_chunk_t b, FILE* fp);
 extern bool istrequal(data_chunk_t s, const char* t);
+extern int MIME_lookup_known_header(data_chunk_t name);
 extern bool is_lws(char ch);
 extern bool MIME_is_field_name_char(char ch);
 extern int MIME_count_leading_lws(int len, const char* data);
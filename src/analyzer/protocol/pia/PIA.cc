@@ -1,5 +1,7 @@
 #include "zeek/analyzer/protocol/pia/PIA.h"
 
+#include <algorithm>
+
 #include "zeek/DebugLogger.h"
 #include "zeek/Event.h"
 #include "zeek/IP.h"
@@ -9,48 +11,167 @@
 #include "zeek/RunState.h"
 #include "zeek/analyzer/protocol/tcp/TCP_Flags.h"
 #include "zeek/analyzer/protocol/tcp/TCP_Reassembler.h"
+#include "zeek/telemetry/Manager.h"
 
 namespace zeek::analyzer::pia {
 
+namespace {
+
+// Buffered payload goes into slabs with sizes in powers of two between
+// these bounds. Larger chunks get a slab of their own, which isn't pooled.
+constexpr size_t min_slab_size = 64;
+constexpr size_t max_slab_size = 4096;
+constexpr size_t num_slab_classes = 7;
+
+// Bytes of unused slabs kept around for reuse, per size class.
+constexpr size_t max_free_bytes = 1024 * 1024;
+
+// Hands out the slabs for all PIA buffers and tracks their memory against
+// dpd_buffer_budget.
+class BufferPool {
+public:
+    static BufferPool& Instance() {
+        // Never destroyed, so that PIAs outliving static destruction can
+        // still return their slabs.
+        static auto* pool = new BufferPool();
+        return *pool;
+    }
+
+    BufferPool() {
+        bytes_metric = telemetry_mgr->GaugeInstance("zeek", "dpd-buffer-bytes", {},
+                                                    "Payload bytes reserved for dynamic protocol detection", "",
+                                                    [this]() { return static_cast<double>(in_use); });
+        exceeded_metric =
+            telemetry_mgr->CounterInstance("zeek", "dpd-buffer-budget-exceeded", {},
+                                           "Buffers that stopped buffering for dynamic protocol detection "
+                                           "because of dpd_buffer_budget",
+                                           "", [this]() { return static_cast<double>(exceeded); });
+    }
+
+    // Returns a slab of at least the given size. Sets size to the slab's
+    // actual size.
+    u_char* Get(size_t* size) {
+        in_use += *size = SlabSize(*size);
+
+        if ( *size <= max_slab_size ) {
+            auto& unused = free_slabs[SlabClass(*size)];
+
+            if ( ! unused.empty() ) {
+                auto* data = unused.back();
+                unused.pop_back();
+                return data;
+            }
+        }
+
+        return new u_char[*size];
+    }
+
+    void Put(u_char* data, size_t size) {
+        in_use -= size;
+
+        if ( size <= max_slab_size ) {
+            auto& unused = free_slabs[SlabClass(size)];
+
+            if ( (unused.size() + 1) * size <= max_free_bytes ) {
+                unused.push_back(data);
+                return;
+            }
+        }
+
+        delete[] data;
+    }
+
+    // Returns true if the slabs in use exceed dpd_buffer_budget. Counts
+    // this as a buffer that stops buffering because of it.
+    bool BudgetExceeded() {
+        if ( ! zeek::detail::dpd_buffer_budget || in_use <= zeek::detail::dpd_buffer_budget )
+            return false;
+
+        ++exceeded;
+        return true;
+    }
+
+private:
+    static size_t SlabSize(size_t size) {
+        if ( size > max_slab_size )
+            return size;
+
+        size_t n = min_slab_size;
+
+        while ( n < size )
+            n *= 2;
+
+        return n;
+    }
+
+    static size_t SlabClass(size_t size) {
+        size_t c = 0;
+
+        for ( size_t n = min_slab_size; n < size; n *= 2 )
+            ++c;
+
+        return c;
+    }
+
+    std::vector<u_char*> free_slabs[num_slab_classes];
+    zeek_uint_t in_use = 0;
+    uint64_t exceeded = 0;
+
+    telemetry::GaugePtr bytes_metric;
+    telemetry::CounterPtr exceeded_metric;
+};
+
+} // namespace
+
 PIA::PIA(analyzer::Analyzer* arg_as_analyzer) : state(INIT), as_analyzer(arg_as_analyzer), conn(), current_packet() {}
 
 PIA::~PIA() { ClearBuffer(&pkt_buffer); }
 
 void PIA::ClearBuffer(Buffer* buffer) {
-    DataBlock* next = nullptr;
-    for ( DataBlock* b = buffer->head; b; b = next ) {
-        next = b->next;
-        delete b->ip;
-        delete[] b->data;
-        delete b;
-    }
+    for ( auto& b : buffer->blocks )
+        delete b.ip;
+
+    auto& pool = BufferPool::Instance();
 
-    buffer->head = buffer->tail = nullptr;
+    for ( const auto& slab : buffer->slabs )
+        pool.Put(slab.data, slab.size);
+
+    buffer->blocks.clear();
+    buffer->slabs.clear();
+    buffer->slab_used = 0;
     buffer->size = 0;
 }
 
 void PIA::AddToBuffer(Buffer* buffer, uint64_t seq, int len, const u_char* data, bool is_orig, const IP_Hdr* ip) {
-    u_char* tmp = nullptr;
+    const u_char* copy = nullptr;
 
     if ( data ) {
-        tmp = new u_char[len];
-        memcpy(tmp, data, len);
-    }
+        if ( buffer->slabs.empty() || buffer->slabs.back().size - buffer->slab_used < static_cast<size_t>(len) ) {
+            // Grow with what's buffered so far, but not beyond what
+            // dpd_buffer_size still lets in.
+            size_t size = static_cast<size_t>(buffer->size);
+            size_t limit = static_cast<size_t>(zeek::detail::dpd_buffer_size);
+            size_t left = size < limit ? limit - size : 0;
+
+            Slab slab;
+            slab.size = std::max(static_cast<size_t>(len), std::min(size, left));
+            slab.data = BufferPool::Instance().Get(&slab.size);
+            buffer->slabs.push_back(slab);
+            buffer->slab_used = 0;
+        }
 
-    DataBlock* b = new DataBlock;
-    b->ip = ip ? ip->Copy() : nullptr;
-    b->data = tmp;
-    b->is_orig = is_orig;
-    b->len = len;
-    b->seq = seq;
-    b->next = nullptr;
-
-    if ( buffer->tail ) {
-        buffer->tail->next = b;
-        buffer->tail = b;
+        auto* dst = buffer->slabs.back().data + buffer->slab_used;
+        memcpy(dst, data, len);
+        buffer->slab_used += len;
+        copy = dst;
     }
-    else
-        buffer->head = buffer->tail = b;
+
+    DataBlock& b = buffer->blocks.emplace_back();
+    b.ip = ip ? ip->Copy() : nullptr;
+    b.data = copy;
+    b.is_orig = is_orig;
+    b.len = len;
+    b.seq = seq;
 
     if ( data )
         buffer->size += len;
@@ -60,11 +181,13 @@ void PIA::AddToBuffer(Buffer* buffer, int len, const u_char* data, bool is_orig,
     AddToBuffer(buffer, -1, len, data, is_orig, ip);
 }
 
+bool PIA::BufferBudgetExceeded() { return BufferPool::Instance().BudgetExceeded(); }
+
 void PIA::ReplayPacketBuffer(analyzer::Analyzer* analyzer) {
     DBG_LOG(DBG_ANALYZER, "PIA replaying %" PRIu64 " total packet bytes", pkt_buffer.size);
 
-    for ( DataBlock* b = pkt_buffer.head; b; b = b->next )
-        analyzer->DeliverPacket(b->len, b->data, b->is_orig, -1, b->ip, 0);
+    for ( const auto& b : pkt_buffer.blocks )
+        analyzer->DeliverPacket(b.len, b.data, b.is_orig, -1, b.ip, 0);
 }
 
 void PIA::PIA_Done() { FinishEndpointMatcher(); }
@@ -86,7 +209,8 @@ void PIA::PIA_DeliverPacket(int len, const u_char* data, bool is_orig, uint64_t
 
     if ( (pkt_buffer.state == BUFFERING || new_state == BUFFERING) && len > 0 ) {
         AddToBuffer(&pkt_buffer, seq, len, data, is_orig, ip);
-        if ( pkt_buffer.size > zeek::detail::dpd_buffer_size || ++pkt_buffer.chunks > zeek::detail::dpd_max_packets )
+        if ( pkt_buffer.size > zeek::detail::dpd_buffer_size || ++pkt_buffer.chunks > zeek::detail::dpd_max_packets ||
+             BufferBudgetExceeded() )
             new_state = zeek::detail::dpd_match_only_beginning ? SKIPPING : MATCHING_ONLY;
     }
 
@@ -297,7 +421,7 @@ void PIA_TCP::DeliverStream(int len, const u_char* data, bool is_orig) {
     if ( stream_buffer.state == BUFFERING || new_state == BUFFERING ) {
         AddToBuffer(&stream_buffer, len, data, is_orig);
         if ( stream_buffer.size > zeek::detail::dpd_buffer_size ||
-             ++stream_buffer.chunks > zeek::detail::dpd_max_packets )
+             ++stream_buffer.chunks > zeek::detail::dpd_max_packets || BufferBudgetExceeded() )
             new_state = zeek::detail::dpd_match_only_beginning ? SKIPPING : MATCHING_ONLY;
     }
 
@@ -384,8 +508,8 @@ void PIA_TCP::ActivateAnalyzer(zeek::Tag tag, const zeek::detail::Rule* rule) {
         // we have been inserted somewhere further down in the
         // analyzer tree.  In this case, we will never have seen
         // any input at this point (because we don't get packets).
-        assert(! pkt_buffer.head);
-        assert(! stream_buffer.head);
+        assert(pkt_buffer.blocks.empty());
+        assert(stream_buffer.blocks.empty());
         return;
     }
 
@@ -398,15 +522,15 @@ void PIA_TCP::ActivateAnalyzer(zeek::Tag tag, const zeek::detail::Rule* rule) {
     uint64_t orig_seq = 0;
     uint64_t resp_seq = 0;
 
-    for ( DataBlock* b = pkt_buffer.head; b; b = b->next ) {
+    for ( const auto& b : pkt_buffer.blocks ) {
         // We don't have the TCP flags here during replay. We could
         // funnel them through, but it's non-trivial and doesn't seem
         // worth the effort.
 
-        if ( b->is_orig )
-            reass_orig->DataSent(run_state::network_time, orig_seq = b->seq, b->len, b->data, tcp::TCP_Flags(), true);
+        if ( b.is_orig )
+            reass_orig->DataSent(run_state::network_time, orig_seq = b.seq, b.len, b.data, tcp::TCP_Flags(), true);
         else
-            reass_resp->DataSent(run_state::network_time, resp_seq = b->seq, b->len, b->data, tcp::TCP_Flags(), true);
+            reass_resp->DataSent(run_state::network_time, resp_seq = b.seq, b.len, b.data, tcp::TCP_Flags(), true);
     }
 
     // We also need to pass the current packet on.
@@ -437,11 +561,11 @@ void PIA_TCP::DeactivateAnalyzer(zeek::Tag tag) { reporter->InternalError("PIA_T
 void PIA_TCP::ReplayStreamBuffer(analyzer::Analyzer* analyzer) {
     DBG_LOG(DBG_ANALYZER, "PIA_TCP replaying %" PRIu64 " total stream bytes", stream_buffer.size);
 
-    for ( DataBlock* b = stream_buffer.head; b; b = b->next ) {
-        if ( b->data )
-            analyzer->NextStream(b->len, b->data, b->is_orig);
+    for ( const auto& b : stream_buffer.blocks ) {
+        if ( b.data )
+            analyzer->NextStream(b.len, b.data, b.is_orig);
         else
-            analyzer->NextUndelivered(b->seq, b->len, b->is_orig);
+            analyzer->NextUndelivered(b.seq, b.len, b.is_orig);
     }
 }
 
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "zeek/RuleMatcher.h"
 #include "zeek/analyzer/Analyzer.h"
 #include "zeek/analyzer/protocol/tcp/TCP.h"
@@ -82,12 +84,20 @@ protected:
         size_t len = 0;
         size_t cap_len = 0;
         uint64_t seq = 0;
-        DataBlock* next = nullptr;
     };
 
+    // A slab of buffered payload, see BufferPool in PIA.cc.
+    struct Slab {
+        u_char* data = nullptr;
+        size_t size = 0;
+    };
+
+    // The chunks' payload gets appended to slabs taken from a pool shared
+    // by all PIAs. Replay passes it on from there without copying.
     struct Buffer {
-        DataBlock* head = nullptr;
-        DataBlock* tail = nullptr;
+        std::vector<DataBlock> blocks;
+        std::vector<Slab> slabs;
+        size_t slab_used = 0; // Bytes used in the last slab.
         int64_t size = 0;
         int64_t chunks = 0;
         State state = INIT;
@@ -98,6 +108,10 @@ protected:
     void AddToBuffer(Buffer* buffer, int len, const u_char* data, bool is_orig, const IP_Hdr* ip = nullptr);
     void ClearBuffer(Buffer* buffer);
 
+    // Returns true if all buffers together exceed dpd_buffer_budget, in
+    // which case the caller stops buffering.
+    bool BufferBudgetExceeded();
+
     DataBlock* CurrentPacket() { return &current_packet; }
 
     void DoMatch(const u_char* data, int len, bool is_orig, bool bol, bool eol, bool clear_state,
@@ -3,13 +3,17 @@
 #include <arpa/inet.h>
 #include <openssl/evp.h>
 #include <openssl/opensslv.h>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include "zeek/Reporter.h"
+#include "zeek/analyzer/protocol/ssl/consts.bif.h"
 #include "zeek/analyzer/protocol/ssl/events.bif.h"
 #include "zeek/analyzer/protocol/ssl/ssl_pac.h"
 #include "zeek/analyzer/protocol/ssl/tls-handshake_pac.h"
 #include "zeek/analyzer/protocol/tcp/TCP_Reassembler.h"
+#include "zeek/analyzer/protocol/tcp/events.bif.h"
 #include "zeek/util.h"
 
 #ifdef OPENSSL_HAVE_KDF_H
@@ -51,6 +55,9 @@ SSL_Analyzer::SSL_Analyzer(Connection* c) : analyzer::tcp::TCP_ApplicationAnalyz
     c_seq = 0;
     s_seq = 0;
     pia = nullptr;
+
+    for ( auto& t : record_trackers )
+        t.active = BifConst::SSL::encrypted_cut_through;
 }
 
 SSL_Analyzer::~SSL_Analyzer() {
@@ -95,13 +102,113 @@ void SSL_Analyzer::DeliverStream(int len, const u_char* data, bool orig) {
         // deliver data to the other side if the script layer can handle this.
         return;
 
+    if ( record_trackers[orig].active )
+        DeliverRecords(len, data, orig);
+    else
+        ParseRecords(data, data + len, orig);
+}
+
+void SSL_Analyzer::ParseRecords(const u_char* begin, const u_char* end, bool orig) {
+    if ( begin == end )
+        return;
+
     try {
-        interp->NewData(orig, data, data + len);
+        interp->NewData(orig, begin, end);
     } catch ( const binpac::Exception& e ) {
         AnalyzerViolation(util::fmt("Binpac exception: %s", e.c_msg()));
+        // The parser may have lost track of the record boundaries.
+        record_trackers[orig].active = false;
     }
 }
 
+void SSL_Analyzer::DeliverRecords(int len, const u_char* data, bool orig) {
+    auto& t = record_trackers[orig];
+    const u_char* end = data + len;
+    const u_char* unparsed = data; // Start of the data not yet passed to the parser.
+
+    // Like the parser, raise the event once a record is complete.
+    auto record_complete = [&]() {
+        if ( ssl_encrypted_data )
+            BifEvent::enqueue_ssl_encrypted_data(this, Conn(), orig ^ GetFlipped(), (t.header[1] << 8) | t.header[2],
+                                                 t.header[0], (t.header[3] << 8) | t.header[4]);
+    };
+
+    while ( data < end ) {
+        if ( t.remaining > 0 ) {
+            int n = std::min(t.remaining, static_cast<int>(end - data));
+            data += n;
+            t.remaining -= n;
+
+            if ( t.remaining == 0 && t.cut_through )
+                record_complete();
+
+            continue;
+        }
+
+        if ( t.header_len == 0 && ! t.cut_through && interp->cut_through_ready() ) {
+            // We're at a record boundary, so the parser will have consumed
+            // everything passed to it. From here on it doesn't get to see
+            // this direction's data anymore.
+            ParseRecords(unparsed, data, orig);
+
+            if ( ! t.active || Skipping() )
+                return;
+
+            t.cut_through = true;
+            ReleaseDeliveredData(orig);
+        }
+
+        int n = std::min(5 - t.header_len, static_cast<int>(end - data));
+        memcpy(t.header + t.header_len, data, n);
+        t.header_len += n;
+        data += n;
+
+        if ( t.header_len < 5 )
+            break;
+
+        t.header_len = 0;
+        t.remaining = (t.header[3] << 8) | t.header[4];
+
+        if ( ! t.cut_through ) {
+            if ( t.header[0] & 0x80 ) {
+                // SSLv2 framing depends on the parser's state, so leave
+                // the direction to it.
+                t.active = false;
+                break;
+            }
+
+            continue;
+        }
+
+        // Same check as the parser's, for SSLv3 to TLS 1.2 record versions.
+        uint16_t version = (t.header[1] << 8) | t.header[2];
+
+        if ( version < 0x0300 || version > 0x0303 ) {
+            AnalyzerViolation(
+                util::fmt("Invalid version late in TLS connection. Packet reported version: %d", version));
+            SetSkip(true);
+            return;
+        }
+
+        if ( t.remaining == 0 )
+            // An empty record is complete with its header.
+            record_complete();
+    }
+
+    if ( ! t.cut_through )
+        ParseRecords(unparsed, end, orig);
+}
+
+void SSL_Analyzer::ReleaseDeliveredData(bool orig) {
+    if ( ! TCP() || rexmit_inconsistency )
+        return;
+
+    auto* endp = orig ? TCP()->Orig() : TCP()->Resp();
+
+    if ( endp->contents_processor )
+        endp->contents_processor->SetReleaseDelivered(true);
+}
+
 void SSL_Analyzer::SendHandshake(uint16_t raw_tls_version, const u_char* begin, const u_char* end, bool orig) {
     handshake_interp->set_record_version(raw_tls_version);
     try {
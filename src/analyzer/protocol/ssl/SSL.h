@@ -155,6 +155,42 @@ protected:
      */
     void ForwardDecryptedData(const std::vector<u_char>& data, bool is_orig);
 
+    /**
+     * Passes data to the record parser.
+     */
+    void ParseRecords(const u_char* begin, const u_char* end, bool orig);
+
+    /**
+     * Delivers data while tracking record boundaries. Once the handshake is
+     * done and there is nothing to decrypt, records are no longer passed to
+     * the parser; only their headers are looked at.
+     *
+     * @param len Length of the data
+     *
+     * @param data Pointer to the data
+     *
+     * @param orig Direction of the connection
+     */
+    void DeliverRecords(int len, const u_char* data, bool orig);
+
+    /**
+     * Stops the TCP reassembler from holding on to delivered data until
+     * it's acknowledged, as there's no need to check it for inconsistent
+     * retransmissions.
+     *
+     * @param orig Direction of the connection
+     */
+    void ReleaseDeliveredData(bool orig);
+
+    // The record framing of one direction, as seen by DeliverRecords().
+    struct RecordTracker {
+        u_char header[5];
+        int header_len = 0; // Header bytes seen of the current record.
+        int remaining = 0;  // Body bytes still to come for the current record.
+        bool active = false; // False if the framing can't be tracked.
+        bool cut_through = false;
+    };
+
     binpac::SSL::SSL_Conn* interp;
     binpac::TLSHandshake::Handshake_Conn* handshake_interp;
     bool had_gap;
@@ -168,6 +204,9 @@ protected:
     std::vector<u_char> keys;
     // PIA, for decrypted data
     zeek::analyzer::pia::PIA_TCP* pia;
+
+    // Record framing for encrypted cut-through, indexed by direction.
+    RecordTracker record_trackers[2];
 };
 
 } // namespace zeek::analyzer::ssl
@@ -1,11 +1,75 @@
 #include "zeek/analyzer/protocol/tcp/ContentLine.h"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "zeek/3rdparty/doctest.h"
 #include "zeek/Reporter.h"
 #include "zeek/analyzer/protocol/tcp/TCP.h"
 #include "zeek/analyzer/protocol/tcp/events.bif.h"
 
 namespace zeek::analyzer::tcp {
 
+namespace {
+
+// Returns the first byte in [begin, end) that is a CR, an LF or equal to
+// \a c, or \a end if there's none.
+const u_char* find_line_special(const u_char* begin, const u_char* end, u_char c) {
+    const u_char* p = begin;
+
+#if defined(__SSE2__)
+    const __m128i vcr = _mm_set1_epi8('\r');
+    const __m128i vlf = _mm_set1_epi8('\n');
+    const __m128i vc = _mm_set1_epi8(static_cast<char>(c));
+
+    for ( ; end - p >= 16; p += 16 ) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, vcr), _mm_cmpeq_epi8(chunk, vlf)),
+                                    _mm_cmpeq_epi8(chunk, vc));
+        int mask = _mm_movemask_epi8(hits);
+
+        if ( mask != 0 )
+            return p + __builtin_ctz(mask);
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t vcr = vdupq_n_u8('\r');
+    const uint8x16_t vlf = vdupq_n_u8('\n');
+    const uint8x16_t vc = vdupq_n_u8(c);
+
+    for ( ; end - p >= 16; p += 16 ) {
+        uint8x16_t chunk = vld1q_u8(p);
+        uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(chunk, vcr), vceqq_u8(chunk, vlf)), vceqq_u8(chunk, vc));
+
+        // Four bits per input byte, as for the ASCII input reader's scanner.
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+
+        if ( mask != 0 )
+            return p + (__builtin_ctzll(mask) >> 2);
+    }
+#endif
+
+    for ( ; p < end; ++p ) {
+        if ( *p == '\r' || *p == '\n' || *p == c )
+            return p;
+    }
+
+    return end;
+}
+
+} // namespace
+
 ContentLine_Analyzer::ContentLine_Analyzer(Connection* conn, bool orig, int max_line_length)
     : TCP_SupportAnalyzer("CONTENTLINE", conn, orig), max_line_length(max_line_length) {
     InitState();
@@ -197,7 +261,43 @@ int ContentLine_Analyzer::DoDeliverOnce(int len, const u_char* data) {
     if ( len <= 0 )
         return 0;
 
+    // With NULs flagged, they need the per-byte treatment below. Otherwise,
+    // searching for a CR a second time is a no-op.
+    const u_char nul = flag_NULs ? '\0' : '\r';
+
+    if ( offset == 0 ) {
+        if ( int n = DeliverContiguousLine(len, data, nul) )
+            return n;
+    }
+
     for ( ; len > 0; --len, ++data ) {
+        if ( offset < max_line_length && *data != '\r' && *data != '\n' && *data != nul ) {
+            // Copy the run of bytes up to the next special one at once.
+            int max_run = std::min(len, max_line_length - offset);
+            int n = find_line_special(data, data + max_run, nul) - data;
+
+            if ( offset + n > buf_len ) {
+                int size = buf_len;
+                while ( offset + n > size )
+                    size *= 2;
+                InitBuffer(size);
+            }
+
+            memcpy(buf + offset, data, n);
+            offset += n;
+
+            if ( last_char == '\r' )
+                if ( ! suppress_weirds && Conn()->FlagEvent(SINGULAR_CR) )
+                    Weird("line_terminated_with_single_CR");
+
+            last_char = data[n - 1];
+            data += n;
+            len -= n;
+
+            if ( len == 0 )
+                break;
+        }
+
         if ( offset >= buf_len )
             InitBuffer(buf_len * 2);
 
@@ -283,6 +383,48 @@ int ContentLine_Analyzer::DoDeliverOnce(int len, const u_char* data) {
     return data - data_start;
 }
 
+int ContentLine_Analyzer::DeliverContiguousLine(int len, const u_char* data, u_char nul) {
+    const u_char* p = find_line_special(data, data + len, nul);
+    int n = p - data;
+
+    // Leave empty lines, lines without terminator in this delivery and
+    // overlong ones to DoDeliverOnce()'s loop.
+    if ( n == 0 || n == len || n >= max_line_length )
+        return 0;
+
+    int seq_len;
+    unsigned int terminator;
+
+    if ( *p == '\r' ) {
+        if ( n + 1 < len && p[1] == '\n' ) {
+            seq_len = n + 2;
+            terminator = '\n';
+        }
+        else if ( CR_LF_as_EOL & CR_as_EOL ) {
+            seq_len = n + 1;
+            terminator = '\r';
+        }
+        else
+            return 0;
+    }
+    else if ( *p == '\n' && (CR_LF_as_EOL & LF_as_EOL) ) {
+        seq_len = n + 1;
+        terminator = '\n';
+    }
+    else
+        return 0;
+
+    if ( last_char == '\r' )
+        if ( ! suppress_weirds && Conn()->FlagEvent(SINGULAR_CR) )
+            Weird("line_terminated_with_single_CR");
+
+    seq_delivered_in_lines = seq + seq_len;
+    last_char = terminator;
+    deliver_stream_remaining_length = len - seq_len;
+    ForwardStream(n, data, IsOrig());
+    return seq_len;
+}
+
 void ContentLine_Analyzer::CheckNUL() {
     // If this is the first byte seen on this connection,
     // and if the connection's state is PARTIAL, then we've
@@ -324,4 +466,242 @@ void ContentLine_Analyzer::SkipBytes(int64_t length) {
     seq_to_skip = SeqDelivered() + length;
 }
 
+TEST_SUITE_BEGIN("contentline");
+
+TEST_CASE("find_line_special") {
+    std::string s = "0123456789abcdefghijklmnopqrstuvwxyz\0foo\r\n";
+    auto b = reinterpret_cast<const u_char*>(s.data());
+    auto e = b + s.size();
+    CHECK(find_line_special(b, e, '\0') == b + 36);
+    CHECK(find_line_special(b, e, '\r') == b + 40);
+    CHECK(find_line_special(b, e, 'x') == b + 33);
+    CHECK(find_line_special(b + 41, e, '\r') == b + 41);
+    CHECK(find_line_special(b, b + 10, '\r') == b + 10);
+}
+
+namespace {
+
+// Collects the lines and gaps a ContentLine_Analyzer forwards.
+class LineCollector : public analyzer::OutputHandler {
+public:
+    void DeliverStream(int len, const u_char* data, bool orig) override {
+        lines.emplace_back(reinterpret_cast<const char*>(data), len);
+
+        if ( on_line )
+            on_line(lines.back());
+    }
+
+    void Undelivered(uint64_t seq, int len, bool orig) override { gaps.emplace_back(seq, len); }
+
+    std::function<void(const std::string&)> on_line;
+    std::vector<std::string> lines;
+    std::vector<std::pair<uint64_t, int>> gaps;
+};
+
+// A ContentLine_Analyzer below a TCP application analyzer, so that the NUL
+// check finds the connection's endpoints.
+struct LineSplitter {
+    explicit LineSplitter(int crlf) {
+        conn = std::make_unique<Connection>(zeek::detail::ConnKey(t), 0, &t, 0, &p);
+        auto* tcp = new packet_analysis::TCP::TCPSessionAdapter(conn.get());
+        conn->SetSessionAdapter(tcp, nullptr);
+        parent = std::make_unique<TCP_ApplicationAnalyzer>("CONTENTLINE", conn.get());
+        parent->SetTCP(tcp);
+
+        cl = new ContentLine_Analyzer(conn.get(), true);
+        cl->SetCRLFAsEOL(crlf);
+        out = new LineCollector();
+        cl->SetOutputHandler(out);
+        parent->AddSupportAnalyzer(cl);
+    }
+
+    ~LineSplitter() {
+        parent->Done();
+        conn->Done();
+    }
+
+    void Deliver(std::string_view data) {
+        cl->NextStream(data.size(), reinterpret_cast<const u_char*>(data.data()), true);
+    }
+
+    zeek::Packet p;
+    zeek::ConnTuple t;
+    std::unique_ptr<Connection> conn;
+    std::unique_ptr<TCP_ApplicationAnalyzer> parent;
+    ContentLine_Analyzer* cl; // Owned by parent.
+    LineCollector* out;       // Owned by cl.
+};
+
+std::vector<std::string> split(const std::vector<std::string>& deliveries, int crlf) {
+    LineSplitter s(crlf);
+
+    for ( const auto& d : deliveries )
+        s.Deliver(d);
+
+    return s.out->lines;
+}
+
+// Delivering one byte at a time keeps every line on the buffered path, so
+// this is what the contiguous fast path needs to agree with.
+std::vector<std::string> split_bytewise(const std::vector<std::string>& deliveries, int crlf) {
+    LineSplitter s(crlf);
+
+    for ( const auto& d : deliveries )
+        for ( char c : d )
+            s.Deliver(std::string_view(&c, 1));
+
+    return s.out->lines;
+}
+
+constexpr int all_crlf_modes[] = {CR_as_EOL | LF_as_EOL, CR_as_EOL, LF_as_EOL, 0};
+
+} // namespace
+
+TEST_CASE("CRLF split across deliveries") {
+    for ( int crlf : all_crlf_modes ) {
+        CAPTURE(crlf);
+        std::vector<std::string> expected = {"foo", "bar", "baz"};
+
+        CHECK(split({"foo\r", "\nbar\r\n", "baz\r\n"}, crlf) == expected);
+        CHECK(split({"foo", "\r", "\n", "bar\r", "\n", "baz", "\r\n"}, crlf) == expected);
+        CHECK(split_bytewise({"foo\r\nbar\r\nbaz\r\n"}, crlf) == expected);
+
+        LineSplitter s(crlf);
+        s.Deliver("foo\r");
+        s.Deliver("\nbar\r\n");
+        expected = {"foo", "bar"};
+        CHECK(s.out->lines == expected);
+        CHECK_FALSE(s.cl->HasPartialLine());
+        CHECK(s.conn->FlagEvent(SINGULAR_CR)); // Not raised before.
+    }
+}
+
+TEST_CASE("bare CR") {
+    for ( int crlf : all_crlf_modes ) {
+        CAPTURE(crlf);
+        std::vector<std::string> expected;
+
+        if ( crlf & CR_as_EOL )
+            expected = {"foo", "bar"};
+        else
+            expected = {"foo\rbar"};
+
+        CHECK(split({"foo\rbar\r\n"}, crlf) == expected);
+        CHECK(split({"foo\r", "bar\r\n"}, crlf) == expected);
+        CHECK(split_bytewise({"foo\rbar\r\n"}, crlf) == expected);
+
+        LineSplitter s(crlf);
+        s.Deliver("foo\rbar\r\n");
+        CHECK_FALSE(s.conn->FlagEvent(SINGULAR_CR));
+        CHECK(s.conn->FlagEvent(SINGULAR_LF));
+    }
+}
+
+TEST_CASE("bare LF") {
+    for ( int crlf : all_crlf_modes ) {
+        CAPTURE(crlf);
+        std::vector<std::string> expected;
+
+        if ( crlf & LF_as_EOL )
+            expected = {"foo", "bar"};
+        else
+            expected = {"foo\nbar"};
+
+        CHECK(split({"foo\nbar\r\n"}, crlf) == expected);
+        CHECK(split({"foo\n", "bar\r\n"}, crlf) == expected);
+        CHECK(split_bytewise({"foo\nbar\r\n"}, crlf) == expected);
+
+        LineSplitter s(crlf);
+        s.Deliver("foo\nbar\r\n");
+        CHECK(s.conn->FlagEvent(SINGULAR_LF) == ((crlf & LF_as_EOL) != 0));
+        CHECK(s.conn->FlagEvent(SINGULAR_CR));
+    }
+}
+
+TEST_CASE("NUL in line") {
+    using namespace std::string_literals;
+
+    SUBCASE("not sensitive") {
+        LineSplitter s(CR_as_EOL | LF_as_EOL);
+        s.Deliver("foo\0bar\r\n"s);
+        CHECK(s.out->lines == std::vector<std::string>{"foo\0bar"s});
+        CHECK(s.conn->FlagEvent(NUL_IN_LINE));
+    }
+
+    SUBCASE("first NUL dropped") {
+        // Only the first NUL gets flagged and removed, later ones are kept.
+        for ( bool bytewise : {false, true} ) {
+            CAPTURE(bytewise);
+            LineSplitter s(CR_as_EOL | LF_as_EOL);
+            s.cl->SetIsNULSensitive(true);
+
+            auto data = "foo\0bar\r\nbaz\0\r\n"s;
+
+            if ( bytewise )
+                for ( char c : data )
+                    s.Deliver(std::string_view(&c, 1));
+            else
+                s.Deliver(data);
+
+            std::vector<std::string> expected = {"foobar", "baz\0"s};
+            CHECK(s.out->lines == expected);
+            CHECK_FALSE(s.conn->FlagEvent(NUL_IN_LINE));
+        }
+    }
+}
+
+TEST_CASE("SkipBytesAfterThisLine") {
+    // Skips the three bytes following the line "skip", as HTTP does for
+    // bodies it isn't interested in.
+    auto skip_after = [](const std::vector<std::string>& deliveries) {
+        LineSplitter s(CR_as_EOL | LF_as_EOL);
+        s.out->on_line = [&s](const std::string& line) {
+            if ( line == "skip" )
+                s.cl->SkipBytesAfterThisLine(3);
+        };
+
+        for ( const auto& d : deliveries )
+            s.Deliver(d);
+
+        return std::make_pair(s.out->lines, s.out->gaps);
+    };
+
+    std::vector<std::string> lines = {"foo", "skip", "45bar", "baz"};
+
+    for ( const auto& deliveries : std::vector<std::vector<std::string>>{
+              {"foo\r\nskip\r\n12345bar\r\nbaz\r\n"},
+              {"foo\r\nskip\r\n1", "2345bar\r\nbaz\r\n"},
+              {"foo\r\nskip\r", "\n12345bar\r\nbaz\r\n"},
+              {"foo\r\nskip", "\r\n123", "45bar\r", "\nbaz\r\n"},
+          } ) {
+        CAPTURE(deliveries.size());
+        auto [got_lines, gaps] = skip_after(deliveries);
+        CHECK(got_lines == lines);
+
+        // Gaps may be split along deliveries, but cover the same range.
+        REQUIRE_FALSE(gaps.empty());
+        CHECK(gaps.front().first == 11);
+        int64_t total = 0;
+        for ( const auto& [seq, len] : gaps )
+            total += len;
+        CHECK(total == 3);
+    }
+}
+
+TEST_CASE("SkipBytes partway through a line") {
+    // SkipBytes() counts from the end of the last line, so the bytes of a
+    // partial line already buffered are passed on, and only the rest is
+    // skipped.
+    LineSplitter s(CR_as_EOL | LF_as_EOL);
+    s.Deliver("foo\r\nba");
+    s.cl->SkipBytes(4);
+    s.Deliver("r\r\nbaz\r\n");
+    std::vector<std::string> expected_lines = {"foo", "ba", "baz"};
+    std::vector<std::pair<uint64_t, int>> expected_gaps = {{7, 2}};
+    CHECK(s.out->lines == expected_lines);
+    CHECK(s.out->gaps == expected_gaps);
+}
+
+TEST_SUITE_END();
+
 } // namespace zeek::analyzer::tcp
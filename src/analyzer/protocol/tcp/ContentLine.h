@@ -12,6 +12,9 @@ namespace zeek::analyzer::tcp {
 // Slightly smaller than 16MB so that the buffer is not unnecessarily resized to 32M.
 constexpr auto DEFAULT_MAX_LINE_LENGTH = 16 * 1024 * 1024 - 100;
 
+// Lines are forwarded via ForwardStream() without their terminator. A line
+// that arrived in a single delivery is passed on in place, so the data is
+// not necessarily NUL-terminated.
 class ContentLine_Analyzer : public TCP_SupportAnalyzer {
 public:
     ContentLine_Analyzer(Connection* conn, bool orig, int max_line_length = DEFAULT_MAX_LINE_LENGTH);
@@ -74,6 +77,11 @@ protected:
     void InitBuffer(int size);
     virtual void DoDeliver(int len, const u_char* data);
     int DoDeliverOnce(int len, const u_char* data);
+
+    // Forwards a line found completely at the start of data straight from
+    // there, without copying it into buf. Returns the number of bytes
+    // consumed, or zero if the line needs DoDeliverOnce()'s regular path.
+    int DeliverContiguousLine(int len, const u_char* data, u_char nul);
     void CheckNUL();
 
     // Returns the sequence number delivered so far.
@@ -31,6 +31,7 @@ TCP_Reassembler::TCP_Reassembler(analyzer::Analyzer* arg_dst_analyzer,
     had_gap = false;
     deliver_tcp_contents = false;
     skip_deliveries = false;
+    release_delivered = false;
     did_EOF = false;
     seq_to_skip = 0;
     in_delivery = false;
@@ -370,9 +371,10 @@ void TCP_Reassembler::BlockInserted(DataBlockMap::const_iterator it) {
 
     TCP_Endpoint* e = endp;
 
-    if ( ! e->peer->HasContents() )
+    if ( ! e->peer->HasContents() || release_delivered )
         // Our endpoint's peer doesn't do reassembly and so
-        // (presumably) isn't processing acks.  So don't hold
+        // (presumably) isn't processing acks, or we've been
+        // asked not to keep delivered data.  So don't hold
         // the now-delivered data.
         TrimToSeq(last_reassem_seq);
 
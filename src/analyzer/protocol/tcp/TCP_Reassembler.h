@@ -57,6 +57,11 @@ public:
 
     void MatchUndelivered(uint64_t up_to_seq, bool use_last_upper);
 
+    // If enabled, delivered data is released right away rather than held
+    // until acknowledged. Retransmissions of it then aren't checked for
+    // inconsistencies anymore.
+    void SetReleaseDelivered(bool enable) { release_delivered = enable; }
+
     // Skip up to seq, as if there's a content gap.
     // Can be used to skip HTTP data for performance considerations.
     void SkipToSeq(uint64_t seq);
@@ -102,6 +107,7 @@ private:
     bool had_gap;
     bool did_EOF;
     bool skip_deliveries;
+    bool release_delivered;
 
     uint64_t seq_to_skip;
 
@@ -0,0 +1,155 @@
+#include "zeek/broker/LogBatch.h"
+
+#include <arpa/inet.h>
+#include <zlib.h>
+#include <cstring>
+
+#include "zeek/3rdparty/doctest.h"
+
+namespace zeek::Broker::detail {
+
+namespace {
+
+constexpr char magic[4] = {'Z', 'L', 'O', 'G'};
+
+// Zero field count, magic, record count and uncompressed size.
+constexpr size_t header_size = 16;
+
+// Upper bound for the uncompressed size a receiver accepts.
+constexpr uint32_t max_uncompressed_size = 256 * 1024 * 1024;
+
+void put_u32(char* p, uint32_t v) {
+    v = htonl(v);
+    memcpy(p, &v, sizeof(v));
+}
+
+uint32_t get_u32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return ntohl(v);
+}
+
+} // namespace
+
+void CompressedLogBatch::Add(const char* data, size_t len) {
+    char prefix[4];
+    put_u32(prefix, static_cast<uint32_t>(len));
+    buffer.append(prefix, sizeof(prefix));
+    buffer.append(data, len);
+    ++records;
+}
+
+std::optional<std::string> CompressedLogBatch::Take(int level) {
+    std::string result;
+    uLongf compressed_len = compressBound(buffer.size());
+    result.resize(header_size + compressed_len);
+
+    put_u32(result.data(), 0);
+    memcpy(result.data() + 4, magic, sizeof(magic));
+    put_u32(result.data() + 8, static_cast<uint32_t>(records));
+    put_u32(result.data() + 12, static_cast<uint32_t>(buffer.size()));
+
+    int rc = compress2(reinterpret_cast<Bytef*>(result.data() + header_size), &compressed_len,
+                       reinterpret_cast<const Bytef*>(buffer.data()), buffer.size(), level);
+
+    buffer.clear();
+    records = 0;
+
+    if ( rc != Z_OK )
+        return std::nullopt;
+
+    result.resize(header_size + compressed_len);
+    return result;
+}
+
+bool CompressedLogBatch::IsCompressed(std::string_view serial_data) {
+    return serial_data.size() >= header_size && get_u32(serial_data.data()) == 0 &&
+           memcmp(serial_data.data() + 4, magic, sizeof(magic)) == 0;
+}
+
+bool CompressedLogBatch::Decompress(std::string_view serial_data, std::string* buffer,
+                                    std::vector<std::string_view>* records) {
+    if ( ! IsCompressed(serial_data) )
+        return false;
+
+    uint32_t num_records = get_u32(serial_data.data() + 8);
+    uint32_t size = get_u32(serial_data.data() + 12);
+
+    // Every record takes at least its length prefix.
+    if ( size > max_uncompressed_size || num_records > size / 4 )
+        return false;
+
+    buffer->resize(size);
+    uLongf len = size;
+    int rc = uncompress(reinterpret_cast<Bytef*>(buffer->data()), &len,
+                        reinterpret_cast<const Bytef*>(serial_data.data() + header_size),
+                        serial_data.size() - header_size);
+
+    if ( rc != Z_OK || len != size )
+        return false;
+
+    records->clear();
+    records->reserve(num_records);
+
+    std::string_view rest = *buffer;
+
+    for ( uint32_t i = 0; i < num_records; ++i ) {
+        if ( rest.size() < 4 )
+            return false;
+
+        uint32_t record_len = get_u32(rest.data());
+        rest.remove_prefix(4);
+
+        if ( rest.size() < record_len )
+            return false;
+
+        records->push_back(rest.substr(0, record_len));
+        rest.remove_prefix(record_len);
+    }
+
+    return rest.empty();
+}
+
+TEST_SUITE_BEGIN("broker log batch");
+
+TEST_CASE("compress and decompress") {
+    CompressedLogBatch batch;
+    std::string r1(100, 'a');
+    std::string r2 = "";
+    std::string r3 = "third record";
+
+    batch.Add(r1.data(), r1.size());
+    batch.Add(r2.data(), r2.size());
+    batch.Add(r3.data(), r3.size());
+    CHECK(batch.Records() == 3);
+    CHECK(batch.Size() == 12 + r1.size() + r3.size());
+
+    auto data = batch.Take(1);
+    REQUIRE(data);
+    CHECK(batch.Records() == 0);
+    CHECK(CompressedLogBatch::IsCompressed(*data));
+
+    std::string buffer;
+    std::vector<std::string_view> records;
+    REQUIRE(CompressedLogBatch::Decompress(*data, &buffer, &records));
+    REQUIRE(records.size() == 3);
+    CHECK(records[0] == r1);
+    CHECK(records[1] == r2);
+    CHECK(records[2] == r3);
+
+    SUBCASE("truncated") {
+        data->resize(data->size() - 1);
+        CHECK_FALSE(CompressedLogBatch::Decompress(*data, &buffer, &records));
+    }
+}
+
+TEST_CASE("regular serial data") {
+    // A regular record starts with a non-zero field count.
+    std::string data("\x00\x00\x00\x02ZLOG\x00\x00\x00\x00\x00\x00\x00\x00", 16);
+    CHECK_FALSE(CompressedLogBatch::IsCompressed(data));
+    CHECK_FALSE(CompressedLogBatch::IsCompressed("short"));
+}
+
+TEST_SUITE_END();
+
+} // namespace zeek::Broker::detail
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zeek::Broker::detail {
+
+/**
+ * Serialized log records for one topic, writer and path, collected for
+ * sending them as a single compressed LogWrite message.
+ *
+ * A compressed batch travels as the serial data of a regular LogWrite. It
+ * starts with a zero field count, so that receivers without support for
+ * compressed batches skip it with a warning, followed by a magic value,
+ * the number of records, their uncompressed size and the zlib stream of
+ * the length-prefixed records.
+ */
+class CompressedLogBatch {
+public:
+    /**
+     * Appends a record's serial data.
+     */
+    void Add(const char* data, size_t len);
+
+    /**
+     * Returns the number of records added since the last Take().
+     */
+    size_t Records() const { return records; }
+
+    /**
+     * Returns the uncompressed size of the records added since the last
+     * Take().
+     */
+    size_t Size() const { return buffer.size(); }
+
+    /**
+     * Compresses the records into the serial data of a LogWrite message
+     * and resets the batch.
+     *
+     * @param level The zlib compression level, between 1 and 9.
+     *
+     * @return The message's serial data, or nothing if compression failed.
+     */
+    std::optional<std::string> Take(int level);
+
+    /**
+     * Returns true if a LogWrite's serial data holds a compressed batch.
+     */
+    static bool IsCompressed(std::string_view serial_data);
+
+    /**
+     * Decompresses a batch.
+     *
+     * @param serial_data The LogWrite's serial data.
+     *
+     * @param buffer Receives the uncompressed records.
+     *
+     * @param records Receives the serial data of the individual records.
+     * The views point into \a buffer.
+     *
+     * @return False if the batch is malformed.
+     */
+    static bool Decompress(std::string_view serial_data, std::string* buffer, std::vector<std::string_view>* records);
+
+private:
+    std::string buffer;
+    size_t records = 0;
+};
+
+} // namespace zeek::Broker::detail
@@ -5,6 +5,7 @@
 #include <broker/configuration.hh>
 #include <broker/zeek.hh>
 #include <unistd.h>
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <string>
@@ -253,11 +254,17 @@ std::string RenderEvent(const std::string& topic, const std::string& name, const
 } // namespace
 #endif
 
+static constexpr double log_batch_size_bounds[] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+static constexpr double log_batch_compression_ratio_bounds[] = {1.0, 2.0, 4.0, 8.0, 16.0, 32.0};
+
 Manager::Manager(bool arg_use_real_time) : Backend(nullptr, nullptr) {
     bound_port = 0;
     use_real_time = arg_use_real_time;
     peer_count = 0;
     log_batch_size = 0;
+    log_batch_max_size = 0;
+    log_batch_target_interval = 0.0;
+    log_batch_compression_level = 0;
     log_topic_func = nullptr;
     log_id_type = nullptr;
     writer_id_type = nullptr;
@@ -267,6 +274,16 @@ void Manager::DoInitPostScript() {
     DBG_LOG(DBG_BROKER, "Initializing");
 
     log_batch_size = get_option("Broker::log_batch_size")->AsCount();
+    log_batch_max_size = get_option("Broker::log_batch_max_size")->AsCount();
+    log_batch_target_interval = get_option("Broker::log_batch_target_interval")->AsInterval();
+    log_batch_compression_level = static_cast<int>(get_option("Broker::log_batch_compression_level")->AsCount());
+
+    if ( log_batch_compression_level > 9 ) {
+        reporter->Warning("Broker::log_batch_compression_level %d is out of range, using 9",
+                          log_batch_compression_level);
+        log_batch_compression_level = 9;
+    }
+
     default_log_topic_prefix = get_option("Broker::default_log_topic_prefix")->AsString()->CheckString();
     log_topic_func = get_option("Broker::log_topic")->AsFunc();
     log_id_type = id::find_type("Log::ID")->AsEnumType();
@@ -368,6 +385,14 @@ void Manager::DoInitPostScript() {
         telemetry_mgr->CounterInstance("zeek", "broker_incoming_ids", {}, "Total number of incoming ids via broker");
     num_ids_outgoing_metric =
         telemetry_mgr->CounterInstance("zeek", "broker_outgoing_ids", {}, "Total number of outgoing ids via broker");
+
+    log_batch_size_family =
+        telemetry_mgr->HistogramFamily("zeek", "broker-log-batch-size", {"stream"}, log_batch_size_bounds,
+                                       "Number of log writes sent per batch via broker.");
+    log_batch_compression_ratio_family =
+        telemetry_mgr->HistogramFamily("zeek", "broker-log-batch-compression-ratio", {"stream"},
+                                       log_batch_compression_ratio_bounds,
+                                       "Ratio of uncompressed to compressed size of log batches sent via broker.");
 }
 
 void Manager::InitializeBrokerStoreForwarding() {
@@ -733,12 +758,11 @@ bool Manager::PublishLogWrite(EnumVal* stream, EnumVal* writer, const string& pa
     }
 
     len = fmt.EndWrite(&data);
-    std::string serial_data(data, len);
-    free(data);
 
     auto v = log_topic_func->Invoke(IntrusivePtr{NewRef{}, stream}, make_intrusive<StringVal>(path));
 
     if ( ! v ) {
+        free(data);
         reporter->Error(
             "Failed to remotely log: log_topic func did not return"
             " a value for stream %s at path %s",
@@ -748,51 +772,130 @@ bool Manager::PublishLogWrite(EnumVal* stream, EnumVal* writer, const string& pa
 
     std::string topic = v->AsString()->CheckString();
 
-    auto bstream_id = broker::enum_value(std::move(stream_id));
-    auto bwriter_id = broker::enum_value(std::move(writer_id));
-    broker::zeek::LogWrite msg(std::move(bstream_id), std::move(bwriter_id), std::move(path), std::move(serial_data));
-
-    DBG_LOG(DBG_BROKER, "Buffering log record: %s", RenderMessage(topic, msg.as_data()).c_str());
-
     if ( log_buffers.size() <= (unsigned int)stream_id_num )
         log_buffers.resize(stream_id_num + 1);
 
     auto& lb = log_buffers[stream_id_num];
+
+    if ( ! lb.batch_size_metric ) {
+        lb.target_size = log_batch_size;
+        lb.last_flush = LogBatchTime();
+        lb.batch_size_metric = log_batch_size_family->GetOrAdd({{"stream", stream_id}});
+        lb.compression_ratio_metric = log_batch_compression_ratio_family->GetOrAdd({{"stream", stream_id}});
+    }
+
     ++lb.message_count;
-    lb.msgs[topic].add(std::move(msg));
 
-    if ( lb.message_count >= log_batch_size ) {
-        auto outgoing_logs = static_cast<double>(lb.Flush(bstate->endpoint, log_batch_size));
+    if ( log_batch_compression_level > 0 ) {
+        compressed_log_key.assign(topic);
+        compressed_log_key.push_back('\0');
+        compressed_log_key.append(writer_id);
+        compressed_log_key.push_back('\0');
+        compressed_log_key.append(path);
+
+        auto& cb = lb.compressed[compressed_log_key];
+
+        if ( cb.stream.empty() ) {
+            cb.topic = topic;
+            cb.stream = stream_id;
+            cb.writer = writer_id;
+            cb.path = path;
+        }
+
+        DBG_LOG(DBG_BROKER, "Buffering log record for compression: %s %s %s", cb.topic.c_str(), stream_id,
+                path.c_str());
+
+        cb.batch.Add(data, len);
+        free(data);
+    }
+    else {
+        std::string serial_data(data, len);
+        free(data);
+
+        auto bstream_id = broker::enum_value(std::move(stream_id));
+        auto bwriter_id = broker::enum_value(std::move(writer_id));
+        broker::zeek::LogWrite msg(std::move(bstream_id), std::move(bwriter_id), std::move(path),
+                                   std::move(serial_data));
+
+        DBG_LOG(DBG_BROKER, "Buffering log record: %s", RenderMessage(topic, msg.as_data()).c_str());
+
+        lb.msgs[topic].add(std::move(msg));
+    }
+
+    if ( lb.message_count >= lb.target_size ) {
+        auto outgoing_logs = static_cast<double>(FlushLogBuffer(lb, LogBatchTime()));
         num_logs_outgoing_metric->Inc(outgoing_logs);
     }
 
     return true;
 }
 
-size_t Manager::LogBuffer::Flush(broker::endpoint& endpoint, size_t log_batch_size) {
-    if ( endpoint.is_shutdown() )
+size_t Manager::FlushLogBuffer(LogBuffer& lb, double now) {
+    if ( bstate->endpoint.is_shutdown() )
         return 0;
 
-    if ( ! message_count )
+    if ( ! lb.message_count )
         // No logs buffered for this stream.
         return 0;
 
-    for ( auto& [topic, pending_batch] : msgs ) {
+    for ( auto& [key, cb] : lb.compressed ) {
+        if ( ! cb.batch.Records() )
+            continue;
+
+        auto uncompressed_size = cb.batch.Size();
+        auto serial_data = cb.batch.Take(log_batch_compression_level);
+
+        if ( ! serial_data ) {
+            reporter->Error("Failed to remotely log stream %s: compression failed", cb.stream.c_str());
+            continue;
+        }
+
+        lb.compression_ratio_metric->Observe(static_cast<double>(uncompressed_size) / serial_data->size());
+
+        broker::zeek::LogWrite msg(broker::enum_value(cb.stream), broker::enum_value(cb.writer), cb.path,
+                                   std::move(*serial_data));
+        lb.msgs[cb.topic].add(std::move(msg));
+    }
+
+    for ( auto& [topic, pending_batch] : lb.msgs ) {
         if ( ! pending_batch.empty() )
-            endpoint.publish(topic, pending_batch.build());
+            bstate->endpoint.publish(topic, pending_batch.build());
+    }
+
+    // Size the next batch so that it fills up within the target interval at
+    // the stream's current rate, which keeps busy streams from sending many
+    // small batches while quiet ones still go out with the periodic flush.
+    if ( log_batch_max_size > log_batch_size ) {
+        auto elapsed = now - lb.last_flush;
+
+        if ( elapsed > 0.0 ) {
+            auto current_rate = lb.message_count / elapsed;
+            lb.rate = lb.rate > 0.0 ? 0.8 * lb.rate + 0.2 * current_rate : current_rate;
+        }
+
+        auto target_size = static_cast<size_t>(lb.rate * log_batch_target_interval);
+        lb.target_size = std::clamp(target_size, log_batch_size, log_batch_max_size);
+        lb.last_flush = now;
     }
 
-    auto rval = message_count;
-    message_count = 0;
+    lb.batch_size_metric->Observe(static_cast<double>(lb.message_count));
+
+    auto rval = lb.message_count;
+    lb.message_count = 0;
     return rval;
 }
 
+double Manager::LogBatchTime() const {
+    return log_batch_max_size > log_batch_size ? util::current_time() : 0.0;
+}
+
 size_t Manager::FlushLogBuffers() {
     DBG_LOG(DBG_BROKER, "Flushing all log buffers");
     auto rval = 0u;
+    auto now = LogBatchTime();
 
     for ( auto& lb : log_buffers )
-        rval += lb.Flush(bstate->endpoint, log_batch_size);
+        rval += FlushLogBuffer(lb, now);
 
     num_logs_outgoing_metric->Inc(rval);
 
@@ -1356,7 +1459,6 @@ bool Manager::ProcessMessage(std::string_view, broker::zeek::LogWrite& lw) {
         return false;
     }
 
-    num_logs_incoming_metric->Inc();
     auto&& stream_id_name = lw.stream_id().name;
 
     // Get stream ID.
@@ -1380,6 +1482,31 @@ bool Manager::ProcessMessage(std::string_view, broker::zeek::LogWrite& lw) {
 
     auto serial_data = lw.serial_data_str();
 
+    if ( ! detail::CompressedLogBatch::IsCompressed(serial_data) ) {
+        num_logs_incoming_metric->Inc();
+        return ProcessLogRecord(stream_id->AsEnumVal(), writer_id->AsEnumVal(), path, serial_data, stream_id_name);
+    }
+
+    std::string buffer;
+    std::vector<std::string_view> records;
+
+    if ( ! detail::CompressedLogBatch::Decompress(serial_data, &buffer, &records) ) {
+        reporter->Warning("failed to decompress remote log batch for stream: %s", c_str_safe(stream_id_name).c_str());
+        return false;
+    }
+
+    num_logs_incoming_metric->Inc(static_cast<double>(records.size()));
+
+    for ( const auto& record : records ) {
+        if ( ! ProcessLogRecord(stream_id->AsEnumVal(), writer_id->AsEnumVal(), path, record, stream_id_name) )
+            return false;
+    }
+
+    return true;
+}
+
+bool Manager::ProcessLogRecord(EnumVal* stream_id, EnumVal* writer_id, const std::string& path,
+                               std::string_view serial_data, std::string_view stream_name) {
     zeek::detail::BinarySerializationFormat fmt;
     fmt.StartRead(serial_data.data(), serial_data.size());
 
@@ -1388,7 +1515,7 @@ bool Manager::ProcessMessage(std::string_view, broker::zeek::LogWrite& lw) {
 
     if ( ! success ) {
         reporter->Warning("failed to unserialize remote log num fields for stream: %s",
-                          c_str_safe(stream_id_name).c_str());
+                          c_str_safe(stream_name).c_str());
         return false;
     }
 
@@ -1397,13 +1524,13 @@ bool Manager::ProcessMessage(std::string_view, broker::zeek::LogWrite& lw) {
     for ( int i = 0; i < num_fields; ++i ) {
         if ( ! rec[i].Read(&fmt) ) {
             reporter->Warning("failed to unserialize remote log field %d for stream: %s", i,
-                              c_str_safe(stream_id_name).c_str());
+                              c_str_safe(stream_name).c_str());
 
             return false;
         }
     }
 
-    log_mgr->WriteFromRemote(stream_id->AsEnumVal(), writer_id->AsEnumVal(), path, std::move(rec));
+    log_mgr->WriteFromRemote(stream_id, writer_id, path, std::move(rec));
     fmt.EndRead();
     return true;
 }
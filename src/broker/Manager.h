@@ -17,6 +17,7 @@
 #include "zeek/IntrusivePtr.h"
 #include "zeek/Span.h"
 #include "zeek/broker/Data.h"
+#include "zeek/broker/LogBatch.h"
 #include "zeek/cluster/Backend.h"
 #include "zeek/iosource/IOSource.h"
 #include "zeek/logging/Types.h"
@@ -33,8 +34,12 @@ using TableValPtr = IntrusivePtr<TableVal>;
 namespace telemetry {
 class Gauge;
 class Counter;
+class Histogram;
+class HistogramFamily;
 using GaugePtr = std::shared_ptr<Gauge>;
 using CounterPtr = std::shared_ptr<Counter>;
+using HistogramPtr = std::shared_ptr<Histogram>;
+using HistogramFamilyPtr = std::shared_ptr<HistogramFamily>;
 } // namespace telemetry
 
 namespace detail {
@@ -443,14 +448,44 @@ private:
     const char* Tag() override { return "Broker::Manager"; }
     double GetNextTimeout() override { return -1; }
 
+    struct CompressedLogBuffer {
+        std::string topic;
+        std::string stream;
+        std::string writer;
+        std::string path;
+        detail::CompressedLogBatch batch;
+    };
+
     struct LogBuffer {
         // Indexed by topic string.
         std::unordered_map<std::string, broker::zeek::BatchBuilder> msgs;
-        size_t message_count;
-
-        size_t Flush(broker::endpoint& endpoint, size_t batch_size);
+        // Indexed by topic, writer and path, separated by NUL characters.
+        std::unordered_map<std::string, CompressedLogBuffer> compressed;
+        size_t message_count = 0;
+
+        // Number of messages after which the buffer flushes, adapted to
+        // the stream's rate of log writes.
+        size_t target_size = 0;
+        double rate = 0.0; // Smoothed log writes per second.
+        double last_flush = 0.0;
+
+        telemetry::HistogramPtr batch_size_metric;
+        telemetry::HistogramPtr compression_ratio_metric;
     };
 
+    // Sends out a stream's buffered log writes and adapts its flush
+    // threshold. Returns the number of log writes sent.
+    size_t FlushLogBuffer(LogBuffer& lb, double now);
+
+    // Returns the current time if batch sizes adapt to the streams' rates,
+    // and zero otherwise, as nothing else needs it.
+    double LogBatchTime() const;
+
+    // Forwards the serial data of a single remote log write to the logging
+    // manager.
+    bool ProcessLogRecord(EnumVal* stream_id, EnumVal* writer_id, const std::string& path,
+                          std::string_view serial_data, std::string_view stream_name);
+
     // Data stores
     using query_id = std::pair<broker::request_id, detail::StoreHandleVal*>;
 
@@ -478,6 +513,10 @@ private:
     int peer_count;
 
     size_t log_batch_size;
+    size_t log_batch_max_size;
+    double log_batch_target_interval;
+    int log_batch_compression_level;
+    std::string compressed_log_key; // Reused for looking up compressed log buffers.
     Func* log_topic_func;
     VectorTypePtr vector_of_data_type;
     EnumType* log_id_type;
@@ -496,6 +535,8 @@ private:
     telemetry::CounterPtr num_logs_outgoing_metric;
     telemetry::CounterPtr num_ids_incoming_metric;
     telemetry::CounterPtr num_ids_outgoing_metric;
+    telemetry::HistogramFamilyPtr log_batch_size_family;
+    telemetry::HistogramFamilyPtr log_batch_compression_ratio_family;
 }; // namespace zeek
 
 } // namespace Broker
@@ -0,0 +1,18 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "Plugin.h"
+
+#include "zeek/cluster/Component.h"
+
+#include "SHM.h"
+
+using namespace zeek::plugin::Zeek_Cluster_Backend_SHM;
+
+zeek::plugin::Configuration Plugin::Configure() {
+    AddComponent(new cluster::BackendComponent("SHM", zeek::cluster::shm::SHMBackend::Instantiate));
+
+    zeek::plugin::Configuration config;
+    config.name = "Zeek::Cluster_Backend_SHM";
+    config.description = "Cluster backend using shared memory between processes on the same host";
+    return config;
+}
@@ -0,0 +1,185 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/cluster/backend/shm/Ring.h"
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "zeek/3rdparty/doctest.h"
+
+namespace zeek::cluster::shm::detail {
+
+void Ring::Format(void* mem, uint32_t capacity) {
+    auto* ctl = new (mem) Control;
+    ctl->head.store(0, std::memory_order_relaxed);
+    ctl->tail.store(0, std::memory_order_relaxed);
+    ctl->consumer_waiting.store(0, std::memory_order_relaxed);
+    ctl->capacity = capacity;
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+Ring::Ring(void* mem)
+    : ctl(static_cast<Control*>(mem)), data(static_cast<std::byte*>(mem) + sizeof(Control)), capacity(ctl->capacity) {}
+
+std::byte* Ring::Reserve(size_t len) {
+    if ( len > MaxMessageSize() )
+        return nullptr;
+
+    size_t need = Align(HeaderSize + len);
+    uint64_t head = ctl->head.load(std::memory_order_relaxed);
+    uint64_t tail = ctl->tail.load(std::memory_order_acquire);
+    size_t pos = head & (capacity - 1);
+    size_t contiguous = capacity - pos;
+    size_t skip = contiguous < need ? contiguous : 0;
+
+    if ( head + skip + need - tail > capacity )
+        return nullptr;
+
+    if ( skip > 0 ) {
+        // Records are 8 byte aligned, so there's always room for the marker.
+        memcpy(data + pos, &WrapMarker, sizeof(WrapMarker));
+        pos = 0;
+    }
+
+    auto len32 = static_cast<uint32_t>(len);
+    memcpy(data + pos, &len32, sizeof(len32));
+    reserved_end = head + skip + need;
+
+    return data + pos + HeaderSize;
+}
+
+void Ring::Commit() { ctl->head.store(reserved_end, std::memory_order_seq_cst); }
+
+std::optional<Span<const std::byte>> Ring::Peek() {
+    uint64_t tail = ctl->tail.load(std::memory_order_relaxed);
+    uint64_t head = ctl->head.load(std::memory_order_acquire);
+
+    while ( tail != head ) {
+        size_t pos = tail & (capacity - 1);
+        uint32_t len;
+        memcpy(&len, data + pos, sizeof(len));
+
+        if ( len == WrapMarker ) {
+            tail += capacity - pos;
+            continue;
+        }
+
+        size_t size = Align(HeaderSize + len);
+
+        if ( len > MaxMessageSize() || pos + size > capacity || tail + size > head ) {
+            // Can only happen if the producer misbehaves. Discard
+            // everything rather than reading out of bounds.
+            ctl->tail.store(head, std::memory_order_release);
+            return std::nullopt;
+        }
+
+        peeked_end = tail + size;
+        return Span<const std::byte>{data + pos + HeaderSize, len};
+    }
+
+    return std::nullopt;
+}
+
+void Ring::Release() { ctl->tail.store(peeked_end, std::memory_order_release); }
+
+TEST_SUITE_BEGIN("cluster shm ring");
+
+namespace {
+
+struct TestRing {
+    explicit TestRing(uint32_t capacity) : mem(new(std::align_val_t{64}) std::byte[Ring::SizeFor(capacity)]) {
+        Ring::Format(mem, capacity);
+    }
+
+    ~TestRing() { operator delete[](mem, std::align_val_t{64}); }
+
+    bool Write(const std::string& s, Ring& ring) {
+        auto* p = ring.Reserve(s.size());
+        if ( ! p )
+            return false;
+
+        memcpy(p, s.data(), s.size());
+        ring.Commit();
+        return true;
+    }
+
+    std::string Read(Ring& ring) {
+        auto msg = ring.Peek();
+        if ( ! msg )
+            return "<none>";
+
+        std::string s(reinterpret_cast<const char*>(msg->data()), msg->size());
+        ring.Release();
+        return s;
+    }
+
+    std::byte* mem;
+};
+
+} // namespace
+
+TEST_CASE("write and read") {
+    TestRing t(4096);
+    Ring producer(t.mem);
+    Ring consumer(t.mem);
+
+    CHECK(consumer.Empty());
+    CHECK(t.Write("hello", producer));
+    CHECK(t.Write("", producer));
+    CHECK(t.Write("world", producer));
+    CHECK_FALSE(consumer.Empty());
+
+    CHECK(t.Read(consumer) == "hello");
+    CHECK(t.Read(consumer) == "");
+    CHECK(t.Read(consumer) == "world");
+    CHECK(t.Read(consumer) == "<none>");
+    CHECK(consumer.Empty());
+}
+
+TEST_CASE("full ring and wrap around") {
+    TestRing t(4096);
+    Ring producer(t.mem);
+    Ring consumer(t.mem);
+
+    CHECK(producer.Reserve(producer.MaxMessageSize() + 1) == nullptr);
+
+    // Messages of 1001 bytes take 1016 bytes each, so four fit.
+    std::string msg(1000, 'x');
+    int written = 0;
+
+    while ( t.Write(msg + std::to_string(written), producer) )
+        ++written;
+
+    CHECK(written == 4);
+
+    // Free up the first two slots; the next write doesn't fit before the
+    // end of the ring anymore and wraps to its start.
+    CHECK(t.Read(consumer) == msg + "0");
+    CHECK(t.Read(consumer) == msg + "1");
+    CHECK(t.Write(msg + "4", producer));
+    CHECK(t.Write(msg + "5", producer));
+    CHECK_FALSE(t.Write(msg + "6", producer));
+
+    CHECK(t.Read(consumer) == msg + "2");
+    CHECK(t.Read(consumer) == msg + "3");
+    CHECK(t.Read(consumer) == msg + "4");
+    CHECK(t.Read(consumer) == msg + "5");
+    CHECK(consumer.Empty());
+}
+
+TEST_CASE("consumer waiting flag") {
+    TestRing t(4096);
+    Ring ring(t.mem);
+
+    CHECK_FALSE(ring.ConsumerWaiting());
+    ring.SetConsumerWaiting(true);
+    CHECK(ring.ConsumerWaiting());
+    ring.SetConsumerWaiting(false);
+    CHECK_FALSE(ring.ConsumerWaiting());
+}
+
+TEST_SUITE_END();
+
+} // namespace zeek::cluster::shm::detail
@@ -0,0 +1,135 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+//
+// Single-producer single-consumer byte ring for exchanging messages through
+// shared memory.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "zeek/Span.h"
+
+namespace zeek::cluster::shm::detail {
+
+/**
+ * A ring of variable-length messages in a memory region that's shared
+ * between exactly one producer and one consumer, possibly in different
+ * processes. The ring holds no pointers, so the processes may map it at
+ * different addresses.
+ *
+ * Messages are stored contiguously with an 8 byte length prefix and padded
+ * to 8 bytes. A message that doesn't fit before the end of the ring is
+ * preceded by a wrap marker and stored at the start instead.
+ */
+class Ring {
+public:
+    /**
+     * The shared control block at the start of a ring's memory. Producer
+     * and consumer positions live on separate cache lines.
+     */
+    struct Control {
+        alignas(64) std::atomic<uint64_t> head; // Bytes ever written, owned by the producer.
+        alignas(64) std::atomic<uint64_t> tail; // Bytes ever consumed, owned by the consumer.
+        alignas(64) std::atomic<uint32_t> consumer_waiting;
+        uint32_t capacity;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    /**
+     * Returns the number of bytes a ring with the given capacity occupies.
+     */
+    static constexpr size_t SizeFor(uint32_t capacity) { return sizeof(Control) + capacity; }
+
+    /**
+     * Returns true if the capacity is usable: a power of two between 4 KiB
+     * and 2 GiB.
+     */
+    static constexpr bool ValidCapacity(uint64_t capacity) {
+        return capacity >= 4096 && capacity <= (uint64_t{1} << 31) && (capacity & (capacity - 1)) == 0;
+    }
+
+    /**
+     * Initializes an empty ring in the given memory, which must be at least
+     * SizeFor(capacity) bytes and aligned to 64 bytes. Must happen before
+     * either side attaches.
+     */
+    static void Format(void* mem, uint32_t capacity);
+
+    /**
+     * Attaches to a ring previously initialized with Format().
+     */
+    explicit Ring(void* mem);
+
+    /**
+     * Returns the largest message the ring accepts.
+     */
+    size_t MaxMessageSize() const { return capacity / 2 - HeaderSize; }
+
+    /**
+     * Producer side: reserves contiguous space for a message of \a len
+     * bytes. The message becomes visible to the consumer with Commit().
+     *
+     * @return A pointer to fill in, or nullptr if the ring doesn't have
+     * enough free space right now.
+     */
+    std::byte* Reserve(size_t len);
+
+    /**
+     * Producer side: publishes the message reserved last.
+     */
+    void Commit();
+
+    /**
+     * Consumer side: returns the oldest message without removing it, if
+     * there's one.
+     */
+    std::optional<Span<const std::byte>> Peek();
+
+    /**
+     * Consumer side: removes the message returned by the last Peek().
+     */
+    void Release();
+
+    /**
+     * Returns true if there's no message to consume.
+     */
+    bool Empty() const {
+        return ctl->head.load(std::memory_order_seq_cst) == ctl->tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Consumer side: announces whether the consumer is about to sleep.
+     * After setting this, the consumer must check Empty() again before
+     * actually sleeping.
+     */
+    void SetConsumerWaiting(bool waiting) { ctl->consumer_waiting.store(waiting ? 1 : 0, std::memory_order_seq_cst); }
+
+    /**
+     * Producer side: returns true if the consumer needs a wakeup after
+     * Commit().
+     */
+    bool ConsumerWaiting() const { return ctl->consumer_waiting.load(std::memory_order_seq_cst) != 0; }
+
+private:
+    static constexpr size_t HeaderSize = 8;
+    static constexpr uint32_t WrapMarker = 0xffffffff;
+
+    static constexpr size_t Align(size_t n) { return (n + 7) & ~size_t{7}; }
+
+    Control* ctl;
+    std::byte* data;
+    uint32_t capacity;
+
+    // Producer state between Reserve() and Commit().
+    uint64_t reserved_end = 0;
+
+    // Consumer state between Peek() and Release().
+    uint64_t peeked_end = 0;
+};
+
+} // namespace zeek::cluster::shm::detail
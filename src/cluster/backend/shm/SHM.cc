@@ -0,0 +1,898 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/cluster/backend/shm/SHM.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <optional>
+
+#include "zeek/ID.h"
+#include "zeek/Reporter.h"
+#include "zeek/Val.h"
+#include "zeek/cluster/Serializer.h"
+#include "zeek/cluster/backend/shm/Ring.h"
+#include "zeek/logging/Types.h"
+#include "zeek/util.h"
+
+namespace zeek::cluster::shm {
+
+namespace detail {
+
+namespace {
+
+// Message kinds, the first byte of every frame.
+constexpr uint8_t FRAME_EVENT = 1;
+constexpr uint8_t FRAME_LOG = 2;
+constexpr uint8_t FRAME_SUBSCRIBE = 3;
+constexpr uint8_t FRAME_UNSUBSCRIBE = 4;
+
+// Frames start with the kind, the topic length and the format length,
+// followed by the topic, the format and the payload.
+constexpr size_t FRAME_HEADER_SIZE = 8;
+
+// Tag of backend messages carrying warnings for the main thread.
+constexpr int MSG_WARNING = 1;
+
+struct Frame {
+    uint8_t kind;
+    std::string_view topic;
+    std::string_view format;
+    Span<const std::byte> payload;
+};
+
+size_t frame_size(std::string_view topic, std::string_view format, Span<const std::byte> payload) {
+    return FRAME_HEADER_SIZE + topic.size() + format.size() + payload.size();
+}
+
+void encode_frame(std::byte* out, uint8_t kind, std::string_view topic, std::string_view format,
+                  Span<const std::byte> payload) {
+    auto topic_len = static_cast<uint16_t>(topic.size());
+    auto format_len = static_cast<uint16_t>(format.size());
+
+    memset(out, 0, FRAME_HEADER_SIZE);
+    out[0] = static_cast<std::byte>(kind);
+    memcpy(out + 2, &topic_len, sizeof(topic_len));
+    memcpy(out + 4, &format_len, sizeof(format_len));
+    out += FRAME_HEADER_SIZE;
+
+    memcpy(out, topic.data(), topic.size());
+    out += topic.size();
+    memcpy(out, format.data(), format.size());
+    out += format.size();
+
+    if ( payload.size() > 0 )
+        memcpy(out, payload.data(), payload.size());
+}
+
+std::optional<Frame> decode_frame(Span<const std::byte> msg) {
+    if ( msg.size() < FRAME_HEADER_SIZE )
+        return std::nullopt;
+
+    uint16_t topic_len;
+    uint16_t format_len;
+    memcpy(&topic_len, msg.data() + 2, sizeof(topic_len));
+    memcpy(&format_len, msg.data() + 4, sizeof(format_len));
+
+    if ( msg.size() < FRAME_HEADER_SIZE + topic_len + format_len )
+        return std::nullopt;
+
+    const auto* p = reinterpret_cast<const char*>(msg.data()) + FRAME_HEADER_SIZE;
+    Frame f;
+    f.kind = static_cast<uint8_t>(msg[0]);
+    f.topic = {p, topic_len};
+    f.format = {p + topic_len, format_len};
+
+    size_t header_len = FRAME_HEADER_SIZE + topic_len + format_len;
+    f.payload = {msg.data() + header_len, msg.size() - header_len};
+
+    return f;
+}
+
+// The helpers below run on the hub and IO threads, so they avoid
+// util::fmt() and its static buffer.
+
+std::string errno_str() {
+    char buf[256];
+    util::zeek_strerror_r(errno, buf, sizeof(buf));
+    return buf;
+}
+
+std::string hub_fifo_path(const std::string& fifo_directory, const std::string& prefix) {
+    return fifo_directory + "/" + prefix + "-hub";
+}
+
+std::string node_fifo_path(const std::string& fifo_directory, const std::string& prefix, const std::string& node,
+                           const char* direction) {
+    return fifo_directory + "/" + prefix + "-" + node + "." + direction;
+}
+
+std::string segment_name(const std::string& prefix, const std::string& node) { return "/" + prefix + "-" + node; }
+
+} // namespace
+
+/**
+ * A node's shared memory segment. It holds a header, the ring for messages
+ * from the node to the hub, and the ring for messages the other way round.
+ */
+class Segment {
+public:
+    /**
+     * Creates a segment, replacing a stale one of a previous run. The
+     * segment is removed again when the returned object is destroyed.
+     */
+    static std::unique_ptr<Segment> Create(const std::string& name, uint32_t ring_size, std::string* error) {
+        shm_unlink(name.c_str());
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if ( fd < 0 ) {
+            *error = "shm_open(" + name + "): " + errno_str();
+            return nullptr;
+        }
+
+        size_t size = SizeFor(ring_size);
+
+        if ( ftruncate(fd, static_cast<off_t>(size)) < 0 ) {
+            *error = "ftruncate(" + name + "): " + errno_str();
+            close(fd);
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if ( mem == MAP_FAILED ) {
+            *error = "mmap(" + name + "): " + errno_str();
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        auto* base = static_cast<std::byte*>(mem);
+        Ring::Format(base + UpOffset(), ring_size);
+        Ring::Format(base + DownOffset(ring_size), ring_size);
+
+        // The hub checks the magic before attaching, so write it last.
+        auto* header = new (mem) Header;
+        header->ring_size = ring_size;
+        header->magic.store(Magic, std::memory_order_release);
+
+        return std::unique_ptr<Segment>(new Segment(name, mem, size, ring_size, true));
+    }
+
+    /**
+     * Attaches to a segment created by another process.
+     */
+    static std::unique_ptr<Segment> Open(const std::string& name, std::string* error) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if ( fd < 0 ) {
+            *error = "shm_open(" + name + "): " + errno_str();
+            return nullptr;
+        }
+
+        struct stat st;
+        if ( fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header) ) {
+            *error = "shm segment " + name + " has no header";
+            close(fd);
+            return nullptr;
+        }
+
+        size_t size = st.st_size;
+        void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if ( mem == MAP_FAILED ) {
+            *error = "mmap(" + name + "): " + errno_str();
+            return nullptr;
+        }
+
+        auto* header = static_cast<Header*>(mem);
+        bool valid = header->magic.load(std::memory_order_acquire) == Magic;
+        uint32_t ring_size = header->ring_size;
+
+        if ( ! valid || ! Ring::ValidCapacity(ring_size) || size != SizeFor(ring_size) ) {
+            *error = "shm segment " + name + " is not a valid Zeek segment";
+            munmap(mem, size);
+            return nullptr;
+        }
+
+        return std::unique_ptr<Segment>(new Segment(name, mem, size, ring_size, false));
+    }
+
+    ~Segment() {
+        munmap(mem, size);
+
+        if ( owner )
+            shm_unlink(name.c_str());
+    }
+
+    Ring& Up() { return *up; }
+    Ring& Down() { return *down; }
+
+private:
+    struct Header {
+        alignas(64) std::atomic<uint64_t> magic;
+        uint32_t ring_size;
+    };
+
+    static constexpr uint64_t Magic = 0x5a45454b53484d31; // "ZEEKSHM1"
+
+    static constexpr size_t UpOffset() { return sizeof(Header); }
+    static constexpr size_t DownOffset(uint32_t ring_size) { return UpOffset() + Ring::SizeFor(ring_size); }
+    static constexpr size_t SizeFor(uint32_t ring_size) { return DownOffset(ring_size) + Ring::SizeFor(ring_size); }
+
+    Segment(std::string name, void* mem, size_t size, uint32_t ring_size, bool owner)
+        : name(std::move(name)), mem(mem), size(size), owner(owner) {
+        auto* base = static_cast<std::byte*>(mem);
+        up.emplace(base + UpOffset());
+        down.emplace(base + DownOffset(ring_size));
+    }
+
+    std::string name;
+    void* mem;
+    size_t size;
+    bool owner;
+    std::optional<Ring> up;
+    std::optional<Ring> down;
+};
+
+/**
+ * A named FIFO used to wake up a sleeping ring consumer. Both sides open
+ * it read-write and non-blocking, so neither depends on the other having
+ * it open already.
+ */
+class Doorbell {
+public:
+    ~Doorbell() {
+        if ( fd >= 0 )
+            close(fd);
+
+        if ( owner )
+            unlink(path.c_str());
+    }
+
+    /**
+     * Creates the FIFO, replacing any stale file, and opens it. The FIFO
+     * is removed again on destruction.
+     */
+    static std::unique_ptr<Doorbell> Create(const std::string& path, std::string* error) {
+        unlink(path.c_str());
+
+        if ( mkfifo(path.c_str(), 0600) < 0 ) {
+            *error = "mkfifo(" + path + "): " + errno_str();
+            return nullptr;
+        }
+
+        auto bell = Open(path, error);
+
+        if ( bell )
+            bell->owner = true;
+        else
+            unlink(path.c_str());
+
+        return bell;
+    }
+
+    /**
+     * Opens an existing FIFO.
+     */
+    static std::unique_ptr<Doorbell> Open(const std::string& path, std::string* error) {
+        int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+        if ( fd < 0 ) {
+            *error = "open(" + path + "): " + errno_str();
+            return nullptr;
+        }
+
+        return std::unique_ptr<Doorbell>(new Doorbell(path, fd));
+    }
+
+    void Ring() {
+        char c = 0;
+
+        // A full FIFO means the consumer has a wakeup pending already.
+        [[maybe_unused]] auto n = write(fd, &c, 1);
+    }
+
+    void Drain() {
+        char buf[256];
+        while ( read(fd, buf, sizeof(buf)) > 0 )
+            ;
+    }
+
+    int FD() const { return fd; }
+
+private:
+    Doorbell(std::string path, int fd) : path(std::move(path)), fd(fd) {}
+
+    std::string path;
+    int fd = -1;
+    bool owner = false;
+};
+
+/**
+ * Routes messages between the rings of all registered nodes on its own
+ * thread. Nodes register and unregister by writing "HELLO <name>" and
+ * "BYE <name>" lines to the hub's FIFO.
+ *
+ * Events go to every node with a matching subscription. Log writes go to
+ * exactly one of the matching nodes, selected by a hash of the topic, so
+ * that all writes for a given stream and path end up on the same logger.
+ */
+class Hub {
+public:
+    using WarnCallback = std::function<void(std::string)>;
+
+    Hub(std::string fifo_directory, std::string prefix, size_t max_pending, WarnCallback warn)
+        : fifo_directory(std::move(fifo_directory)),
+          prefix(std::move(prefix)),
+          max_pending(max_pending),
+          warn(std::move(warn)) {}
+
+    ~Hub() { Stop(); }
+
+    bool Start(std::string* error) {
+        registrations = Doorbell::Create(hub_fifo_path(fifo_directory, prefix), error);
+        if ( ! registrations )
+            return false;
+
+        thread = std::thread([this]() { Run(); });
+        return true;
+    }
+
+    void Stop() {
+        if ( ! thread.joinable() )
+            return;
+
+        stopping = true;
+        registrations->Ring();
+        thread.join();
+        nodes.clear();
+    }
+
+private:
+    struct Node {
+        std::string name;
+        std::unique_ptr<Segment> segment;
+        std::unique_ptr<Doorbell> up_bell;
+        std::unique_ptr<Doorbell> down_bell;
+        std::vector<std::string> subscriptions;
+        std::deque<cluster::detail::byte_buffer> pending;
+        uint64_t dropped = 0;
+
+        bool Subscribed(std::string_view topic) const {
+            for ( const auto& s : subscriptions )
+                if ( util::starts_with(topic, s) )
+                    return true;
+
+            return false;
+        }
+    };
+
+    void Run() {
+        util::detail::set_thread_name("zk.shm-hub");
+
+        while ( ! stopping ) {
+            bool busy = ReadRegistrations();
+
+            for ( auto& [_, node] : nodes ) {
+                busy |= Flush(*node);
+                busy |= Poll(*node);
+            }
+
+            if ( ! busy )
+                Wait();
+        }
+    }
+
+    // Sleeps until a node's up ring has data or registrations arrive.
+    void Wait() {
+        bool have_pending = false;
+        bool ready = false;
+        std::vector<pollfd> fds;
+
+        fds.push_back({registrations->FD(), POLLIN, 0});
+
+        for ( auto& [_, node] : nodes ) {
+            node->segment->Up().SetConsumerWaiting(true);
+            fds.push_back({node->up_bell->FD(), POLLIN, 0});
+            have_pending |= ! node->pending.empty();
+        }
+
+        for ( auto& [_, node] : nodes )
+            ready |= ! node->segment->Up().Empty();
+
+        // With pending messages, retry periodically: the nodes don't ring
+        // the hub when they make room in their down rings.
+        if ( ! ready && ! stopping )
+            poll(fds.data(), fds.size(), have_pending ? 10 : -1);
+
+        for ( auto& [_, node] : nodes ) {
+            node->segment->Up().SetConsumerWaiting(false);
+            node->up_bell->Drain();
+        }
+    }
+
+    bool ReadRegistrations() {
+        char buf[4096];
+        bool busy = false;
+        ssize_t n;
+
+        while ( (n = read(registrations->FD(), buf, sizeof(buf))) > 0 )
+            registration_buffer.append(buf, n);
+
+        size_t eol;
+
+        while ( (eol = registration_buffer.find('\n')) != std::string::npos ) {
+            std::string line = registration_buffer.substr(0, eol);
+            registration_buffer.erase(0, eol + 1);
+
+            if ( util::starts_with(line, "HELLO ") )
+                Attach(line.substr(6));
+            else if ( util::starts_with(line, "BYE ") )
+                Detach(line.substr(4));
+
+            busy = true;
+        }
+
+        return busy;
+    }
+
+    void Attach(const std::string& name) {
+        // A node re-registering has restarted with a new segment.
+        nodes.erase(name);
+
+        std::string error;
+        auto node = std::make_unique<Node>();
+        node->name = name;
+        node->segment = Segment::Open(segment_name(prefix, name), &error);
+
+        if ( node->segment )
+            node->up_bell = Doorbell::Open(node_fifo_path(fifo_directory, prefix, name, "up"), &error);
+
+        if ( node->up_bell )
+            node->down_bell = Doorbell::Open(node_fifo_path(fifo_directory, prefix, name, "down"), &error);
+
+        if ( ! node->down_bell ) {
+            warn("shm hub: failed to attach node " + name + ": " + error);
+            return;
+        }
+
+        nodes.emplace(name, std::move(node));
+    }
+
+    void Detach(const std::string& name) {
+        auto it = nodes.find(name);
+        if ( it == nodes.end() )
+            return;
+
+        // Route what the node sent before leaving.
+        while ( Poll(*it->second) )
+            ;
+
+        nodes.erase(it);
+    }
+
+    // Routes up to a batch of messages a node sent to the hub.
+    bool Poll(Node& from) {
+        auto& ring = from.segment->Up();
+        int n = 0;
+
+        for ( ; n < 1024; ++n ) {
+            auto msg = ring.Peek();
+            if ( ! msg )
+                break;
+
+            Route(from, *msg);
+            ring.Release();
+        }
+
+        return n > 0;
+    }
+
+    void Route(Node& from, Span<const std::byte> msg) {
+        auto frame = decode_frame(msg);
+
+        if ( ! frame ) {
+            warn("shm hub: dropping malformed message from " + from.name);
+            return;
+        }
+
+        auto& subs = from.subscriptions;
+
+        switch ( frame->kind ) {
+            case FRAME_SUBSCRIBE:
+                if ( std::find(subs.begin(), subs.end(), frame->topic) == subs.end() )
+                    subs.emplace_back(frame->topic);
+                break;
+
+            case FRAME_UNSUBSCRIBE: subs.erase(std::remove(subs.begin(), subs.end(), frame->topic), subs.end()); break;
+
+            case FRAME_EVENT:
+                for ( auto& [_, node] : nodes )
+                    if ( node.get() != &from && node->Subscribed(frame->topic) )
+                        Deliver(*node, msg);
+                break;
+
+            case FRAME_LOG: {
+                std::vector<Node*> candidates;
+
+                for ( auto& [_, node] : nodes )
+                    if ( node.get() != &from && node->Subscribed(frame->topic) )
+                        candidates.push_back(node.get());
+
+                if ( ! candidates.empty() )
+                    Deliver(*candidates[std::hash<std::string_view>{}(frame->topic) % candidates.size()], msg);
+                break;
+            }
+
+            default:
+                warn("shm hub: dropping message of unknown kind " + std::to_string(frame->kind) + " from " + from.name);
+                break;
+        }
+    }
+
+    void Deliver(Node& to, Span<const std::byte> msg) {
+        if ( to.pending.empty() && Write(to, msg) )
+            return;
+
+        if ( to.pending.size() >= max_pending ) {
+            if ( to.dropped++ == 0 )
+                warn("shm hub: node " + to.name + " is not keeping up, dropping messages");
+
+            return;
+        }
+
+        to.pending.emplace_back(msg.begin(), msg.end());
+    }
+
+    bool Write(Node& to, Span<const std::byte> msg) {
+        auto& ring = to.segment->Down();
+        auto* p = ring.Reserve(msg.size());
+
+        if ( ! p )
+            return false;
+
+        memcpy(p, msg.data(), msg.size());
+        ring.Commit();
+
+        if ( ring.ConsumerWaiting() )
+            to.down_bell->Ring();
+
+        return true;
+    }
+
+    // Moves pending messages into a node's down ring as space permits.
+    bool Flush(Node& to) {
+        bool busy = false;
+
+        while ( ! to.pending.empty() && Write(to, to.pending.front()) ) {
+            to.pending.pop_front();
+            busy = true;
+        }
+
+        return busy;
+    }
+
+    std::string fifo_directory;
+    std::string prefix;
+    size_t max_pending;
+    WarnCallback warn;
+
+    std::unique_ptr<Doorbell> registrations;
+    std::string registration_buffer;
+    std::map<std::string, std::unique_ptr<Node>> nodes;
+
+    std::thread thread;
+    std::atomic<bool> stopping = false;
+};
+
+} // namespace detail
+
+SHMBackend::SHMBackend(std::unique_ptr<EventSerializer> es, std::unique_ptr<LogSerializer> ls)
+    : ThreadedBackend(std::move(es), std::move(ls)) {}
+
+SHMBackend::~SHMBackend() { DoTerminate(); }
+
+void SHMBackend::DoInitPostScript() {
+    ThreadedBackend::DoInitPostScript();
+
+    prefix = id::find_val<StringVal>("Cluster::Backend::SHM::prefix")->ToStdString();
+    fifo_directory = id::find_val<StringVal>("Cluster::Backend::SHM::fifo_directory")->ToStdString();
+    log_topic_prefix = id::find_val<StringVal>("Cluster::Backend::SHM::log_topic_prefix")->ToStdString();
+    run_hub = id::find_val<BoolVal>("Cluster::Backend::SHM::run_hub")->Get();
+    max_pending_messages = id::find_val<CountVal>("Cluster::Backend::SHM::max_pending_messages")->Get();
+
+    auto size = id::find_val<CountVal>("Cluster::Backend::SHM::ring_size")->Get();
+
+    if ( ! detail::Ring::ValidCapacity(size) )
+        reporter->FatalError("Cluster::Backend::SHM::ring_size must be a power of two between 4 KiB and 2 GiB");
+
+    ring_size = static_cast<uint32_t>(size);
+
+    node_name = id::find_val<StringVal>("Cluster::node")->ToStdString();
+
+    if ( node_name.empty() )
+        node_name = util::fmt("zeek-%d", getpid());
+
+    // The name becomes part of file and shared memory object names.
+    for ( auto& c : node_name )
+        if ( c == '/' || c == ' ' || c == '\n' )
+            c = '_';
+}
+
+bool SHMBackend::DoInit() {
+    if ( segment )
+        return true;
+
+    std::string error;
+
+    if ( run_hub ) {
+        hub = std::make_unique<detail::Hub>(fifo_directory, prefix, max_pending_messages,
+                                            [this](std::string msg) { Warn(std::move(msg)); });
+
+        if ( ! hub->Start(&error) ) {
+            reporter->Error("failed to start shm hub: %s", error.c_str());
+            hub.reset();
+            return false;
+        }
+    }
+
+    segment = detail::Segment::Create(detail::segment_name(prefix, node_name), ring_size, &error);
+
+    if ( segment )
+        up_bell = detail::Doorbell::Create(detail::node_fifo_path(fifo_directory, prefix, node_name, "up"), &error);
+
+    if ( up_bell )
+        down_bell = detail::Doorbell::Create(detail::node_fifo_path(fifo_directory, prefix, node_name, "down"), &error);
+
+    if ( ! down_bell ) {
+        reporter->Error("failed to set up shm cluster backend: %s", error.c_str());
+        DoTerminate();
+        return false;
+    }
+
+    // Announce subscriptions made before initialization. The hub reads
+    // them once it has processed the node's registration.
+    for ( const auto& s : subscriptions )
+        Send(detail::FRAME_SUBSCRIBE, s, "", {});
+
+    io_thread = std::thread([this]() { Run(); });
+
+    return ThreadedBackend::DoInit();
+}
+
+void SHMBackend::DoTerminate() {
+    if ( io_thread.joinable() ) {
+        stopping = true;
+        down_bell->Ring();
+        io_thread.join();
+    }
+
+    if ( registered ) {
+        // Best effort, the hub may be gone already.
+        int fd = open(detail::hub_fifo_path(fifo_directory, prefix).c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+        if ( fd >= 0 ) {
+            std::string msg = "BYE " + node_name + "\n";
+            [[maybe_unused]] auto n = write(fd, msg.data(), msg.size());
+            close(fd);
+        }
+
+        registered = false;
+    }
+
+    if ( hub )
+        hub->Stop();
+
+    hub.reset();
+    up_bell.reset();
+    down_bell.reset();
+    segment.reset();
+}
+
+bool SHMBackend::Send(uint8_t kind, std::string_view topic, std::string_view format,
+                      cluster::detail::byte_buffer_span payload) {
+    if ( ! segment )
+        // Not initialized, fire-and-forget semantics allow dropping.
+        return false;
+
+    auto& ring = segment->Up();
+    size_t len = detail::frame_size(topic, format, payload);
+
+    if ( topic.size() > UINT16_MAX || format.size() > UINT16_MAX || len > ring.MaxMessageSize() ) {
+        reporter->Error("shm cluster backend: message for topic %s too large (%zu bytes)", std::string(topic).c_str(),
+                        len);
+        return false;
+    }
+
+    std::scoped_lock lock(send_mtx);
+
+    if ( pending.empty() ) {
+        if ( auto* p = ring.Reserve(len) ) {
+            detail::encode_frame(p, kind, topic, format, payload);
+            ring.Commit();
+
+            if ( ring.ConsumerWaiting() )
+                up_bell->Ring();
+
+            return true;
+        }
+    }
+
+    if ( pending.size() >= max_pending_messages ) {
+        if ( dropped++ == 0 )
+            reporter->Warning("shm cluster backend: hub is not keeping up, dropping messages");
+
+        return false;
+    }
+
+    // Hand the message to the IO thread, waking it up if needed.
+    auto& buf = pending.emplace_back(len);
+    detail::encode_frame(buf.data(), kind, topic, format, payload);
+
+    if ( pending.size() == 1 )
+        down_bell->Ring();
+
+    return true;
+}
+
+bool SHMBackend::DoPublishEvent(const std::string& topic, const std::string& format,
+                                const cluster::detail::byte_buffer& buf) {
+    return Send(detail::FRAME_EVENT, topic, format, buf);
+}
+
+bool SHMBackend::DoPublishLogWrites(const logging::detail::LogWriteHeader& header, const std::string& format,
+                                    cluster::detail::byte_buffer& buf) {
+    auto topic = util::fmt("%s%s/%s", log_topic_prefix.c_str(), header.stream_name.c_str(), header.path.c_str());
+    return Send(detail::FRAME_LOG, topic, format, buf);
+}
+
+bool SHMBackend::DoSubscribe(const std::string& topic_prefix) {
+    if ( ! subscriptions.insert(topic_prefix).second )
+        return false;
+
+    Send(detail::FRAME_SUBSCRIBE, topic_prefix, "", {});
+    return true;
+}
+
+bool SHMBackend::DoUnsubscribe(const std::string& topic_prefix) {
+    if ( subscriptions.erase(topic_prefix) == 0 )
+        return false;
+
+    Send(detail::FRAME_UNSUBSCRIBE, topic_prefix, "", {});
+    return true;
+}
+
+bool SHMBackend::DoProcessBackendMessage(int tag, cluster::detail::byte_buffer_span payload) {
+    if ( tag != detail::MSG_WARNING )
+        return false;
+
+    std::string msg(reinterpret_cast<const char*>(payload.data()), payload.size());
+    reporter->Warning("%s", msg.c_str());
+    return true;
+}
+
+void SHMBackend::Warn(std::string msg) {
+    const auto* p = reinterpret_cast<const std::byte*>(msg.data());
+    QueueMessages messages;
+    messages.emplace_back(BackendMessage{detail::MSG_WARNING, cluster::detail::byte_buffer(p, p + msg.size())});
+    QueueForProcessing(std::move(messages));
+}
+
+void SHMBackend::Run() {
+    util::detail::set_thread_name("zk.shm-io");
+
+    while ( ! stopping ) {
+        if ( ! registered )
+            registered = Register();
+
+        bool busy = DrainPending();
+        busy |= Receive();
+
+        if ( ! busy ) {
+            bool have_pending = false;
+            {
+                std::scoped_lock lock(send_mtx);
+                have_pending = ! pending.empty();
+            }
+
+            // Poll while there's no hub to hand messages to.
+            Wait(registered && ! have_pending ? -1 : 10);
+        }
+    }
+}
+
+bool SHMBackend::Register() {
+    // Fails with ENXIO or ENOENT as long as the hub isn't running.
+    int fd = open(detail::hub_fifo_path(fifo_directory, prefix).c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+    if ( fd < 0 )
+        return false;
+
+    // Writes of less than PIPE_BUF bytes are atomic, so registrations of
+    // different nodes don't interleave.
+    std::string msg = "HELLO " + node_name + "\n";
+    bool ok = write(fd, msg.data(), msg.size()) == static_cast<ssize_t>(msg.size());
+    close(fd);
+
+    return ok;
+}
+
+bool SHMBackend::DrainPending() {
+    std::scoped_lock lock(send_mtx);
+    auto& ring = segment->Up();
+    bool busy = false;
+
+    while ( ! pending.empty() ) {
+        const auto& buf = pending.front();
+        auto* p = ring.Reserve(buf.size());
+
+        if ( ! p )
+            break;
+
+        memcpy(p, buf.data(), buf.size());
+        ring.Commit();
+        pending.pop_front();
+        busy = true;
+    }
+
+    if ( busy && ring.ConsumerWaiting() )
+        up_bell->Ring();
+
+    return busy;
+}
+
+bool SHMBackend::Receive() {
+    auto& ring = segment->Down();
+    QueueMessages messages;
+
+    while ( messages.size() < 1024 ) {
+        auto msg = ring.Peek();
+        if ( ! msg )
+            break;
+
+        auto frame = detail::decode_frame(*msg);
+
+        if ( ! frame )
+            Warn("shm cluster backend: dropping malformed message");
+        else if ( frame->kind == detail::FRAME_EVENT )
+            messages.emplace_back(EventMessage{std::string(frame->topic), std::string(frame->format),
+                                               cluster::detail::byte_buffer(frame->payload.begin(),
+                                                                            frame->payload.end())});
+        else if ( frame->kind == detail::FRAME_LOG )
+            messages.emplace_back(LogMessage{std::string(frame->format),
+                                             cluster::detail::byte_buffer(frame->payload.begin(),
+                                                                          frame->payload.end())});
+
+        ring.Release();
+    }
+
+    if ( messages.empty() )
+        return false;
+
+    QueueForProcessing(std::move(messages));
+    return true;
+}
+
+void SHMBackend::Wait(int timeout_ms) {
+    auto& ring = segment->Down();
+    ring.SetConsumerWaiting(true);
+
+    if ( ring.Empty() && ! stopping ) {
+        pollfd fd = {down_bell->FD(), POLLIN, 0};
+        poll(&fd, 1, timeout_ms);
+    }
+
+    ring.SetConsumerWaiting(false);
+    down_bell->Drain();
+}
+
+} // namespace zeek::cluster::shm
@@ -0,0 +1,117 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+// Cluster backend exchanging messages between Zeek processes on the same
+// host through shared memory rings.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "zeek/cluster/Backend.h"
+
+namespace zeek::cluster::shm {
+
+namespace detail {
+
+class Doorbell;
+class Hub;
+class Segment;
+
+} // namespace detail
+
+/**
+ * Cluster backend for nodes running on a single host.
+ *
+ * Every node owns a shared memory segment with one ring for messages to a
+ * hub and one for messages from it. The hub runs as a thread inside the
+ * node configured with Cluster::Backend::SHM::run_hub, usually the manager,
+ * and routes messages between the nodes' rings based on their
+ * subscriptions. Named FIFOs serve as doorbells to wake up a ring's
+ * consumer, but are only written to when the consumer actually sleeps.
+ */
+class SHMBackend : public cluster::ThreadedBackend {
+public:
+    SHMBackend(std::unique_ptr<EventSerializer> es, std::unique_ptr<LogSerializer> ls);
+
+    ~SHMBackend() override;
+
+    /**
+     * Component factory.
+     */
+    static std::unique_ptr<Backend> Instantiate(std::unique_ptr<EventSerializer> event_serializer,
+                                                std::unique_ptr<LogSerializer> log_serializer) {
+        return std::make_unique<SHMBackend>(std::move(event_serializer), std::move(log_serializer));
+    }
+
+    const char* Tag() override { return "SHM"; }
+
+private:
+    void DoInitPostScript() override;
+
+    bool DoInit() override;
+
+    void DoTerminate() override;
+
+    bool DoPublishEvent(const std::string& topic, const std::string& format,
+                        const cluster::detail::byte_buffer& buf) override;
+
+    bool DoSubscribe(const std::string& topic_prefix) override;
+
+    bool DoUnsubscribe(const std::string& topic_prefix) override;
+
+    bool DoPublishLogWrites(const logging::detail::LogWriteHeader& header, const std::string& format,
+                            cluster::detail::byte_buffer& buf) override;
+
+    bool DoProcessBackendMessage(int tag, cluster::detail::byte_buffer_span payload) override;
+
+    // Sends a message to the hub. Main thread only.
+    bool Send(uint8_t kind, std::string_view topic, std::string_view format, cluster::detail::byte_buffer_span payload);
+
+    // The IO thread's main loop.
+    void Run();
+
+    // IO thread helpers.
+    bool Register();
+    bool DrainPending();
+    bool Receive();
+    void Wait(int timeout_ms);
+
+    // Reports a problem from any thread on the main thread.
+    void Warn(std::string msg);
+
+    // Configuration from Cluster::Backend::SHM.
+    std::string prefix;
+    std::string fifo_directory;
+    std::string log_topic_prefix;
+    uint32_t ring_size = 0;
+    bool run_hub = false;
+    size_t max_pending_messages = 0;
+
+    std::string node_name;
+    std::set<std::string> subscriptions;
+
+    std::unique_ptr<detail::Hub> hub;
+    std::unique_ptr<detail::Segment> segment;
+    std::unique_ptr<detail::Doorbell> up_bell;   // Wakes up the hub.
+    std::unique_ptr<detail::Doorbell> down_bell; // Wakes up the IO thread.
+
+    // Messages that didn't fit into the up ring, drained by the IO thread.
+    std::mutex send_mtx;
+    std::deque<cluster::detail::byte_buffer> pending;
+    uint64_t dropped = 0;
+
+    std::thread io_thread;
+    std::atomic<bool> stopping = false;
+    bool registered = false; // IO thread only.
+};
+
+} // namespace zeek::cluster::shm
@@ -0,0 +1,24 @@
+#include "Plugin.h"
+
+#include <memory>
+
+#include "zeek/cluster/Component.h"
+
+#include "Serializer.h"
+
+using namespace zeek::cluster;
+using namespace zeek::plugin::Binary_Serializer;
+
+zeek::plugin::Configuration Plugin::Configure() {
+    AddComponent(new EventSerializerComponent("ZEEK_BIN_V1", []() -> std::unique_ptr<EventSerializer> {
+        return std::make_unique<cluster::detail::ZeekBinV1_Serializer>();
+    }));
+    AddComponent(new LogSerializerComponent("ZEEK_BIN_V1", []() -> std::unique_ptr<LogSerializer> {
+        return std::make_unique<cluster::detail::ZeekBinV1_LogSerializer>();
+    }));
+
+    zeek::plugin::Configuration config;
+    config.name = "Zeek::Binary_Serializer";
+    config.description = "Event and log serialization using Zeek's compact binary format";
+    return config;
+}
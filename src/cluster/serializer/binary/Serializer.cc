@@ -0,0 +1,1324 @@
+#include "zeek/cluster/serializer/binary/Serializer.h"
+
+#include <cinttypes>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "zeek/Desc.h"
+#include "zeek/EventRegistry.h"
+#include "zeek/Func.h"
+#include "zeek/ID.h"
+#include "zeek/IPAddr.h"
+#include "zeek/RE.h"
+#include "zeek/Reporter.h"
+#include "zeek/Scope.h"
+#include "zeek/Val.h"
+#include "zeek/cluster/Backend.h"
+#include "zeek/module_util.h"
+
+#include "zeek/3rdparty/doctest.h"
+
+using namespace zeek::cluster;
+using zeek::threading::Value;
+
+namespace {
+
+// Every message starts with these two magic bytes, the format version and
+// the kind of message.
+constexpr uint8_t magic[] = {'Z', 'B'};
+constexpr uint8_t version = 1;
+constexpr uint8_t kind_event = 1;
+constexpr uint8_t kind_log_write = 2;
+
+// Limit on the nesting of values when unserializing, protecting the stack
+// against deeply nested recursive types.
+constexpr int max_depth = 64;
+
+class Encoder {
+public:
+    explicit Encoder(detail::byte_buffer& buf) : buf(buf) {}
+
+    void Byte(uint8_t b) { buf.push_back(static_cast<std::byte>(b)); }
+
+    void Varint(uint64_t v) {
+        while ( v >= 0x80 ) {
+            Byte(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+
+        Byte(static_cast<uint8_t>(v));
+    }
+
+    // Zigzag encoding keeps small negative numbers small.
+    void Signed(int64_t v) { Varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+
+    void Fixed64(uint64_t v) {
+        for ( int i = 0; i < 8; ++i )
+            Byte(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void Double(double d) {
+        uint64_t v;
+        memcpy(&v, &d, sizeof(v));
+        Fixed64(v);
+    }
+
+    void Bytes(const void* data, size_t len) {
+        auto p = static_cast<const std::byte*>(data);
+        buf.insert(buf.end(), p, p + len);
+    }
+
+    void String(std::string_view s) {
+        Varint(s.size());
+        Bytes(s.data(), s.size());
+    }
+
+    void Bitmap(const std::vector<bool>& bits) {
+        for ( size_t i = 0; i < bits.size(); i += 8 ) {
+            uint8_t b = 0;
+
+            for ( size_t j = i; j < bits.size() && j < i + 8; ++j )
+                if ( bits[j] )
+                    b |= 1 << (j - i);
+
+            Byte(b);
+        }
+    }
+
+private:
+    detail::byte_buffer& buf;
+};
+
+class Decoder {
+public:
+    explicit Decoder(detail::byte_buffer_span buf) : p(buf.data()), end(buf.data() + buf.size()) {}
+
+    size_t Remaining() const { return end - p; }
+
+    bool Byte(uint8_t* b) {
+        if ( p == end )
+            return false;
+
+        *b = static_cast<uint8_t>(*p++);
+        return true;
+    }
+
+    bool Varint(uint64_t* v) {
+        *v = 0;
+
+        for ( int shift = 0; shift < 64; shift += 7 ) {
+            uint8_t b;
+
+            if ( ! Byte(&b) )
+                return false;
+
+            *v |= static_cast<uint64_t>(b & 0x7f) << shift;
+
+            if ( ! (b & 0x80) )
+                return true;
+        }
+
+        return false;
+    }
+
+    bool Signed(int64_t* v) {
+        uint64_t u;
+
+        if ( ! Varint(&u) )
+            return false;
+
+        *v = static_cast<int64_t>((u >> 1) ^ (~(u & 1) + 1));
+        return true;
+    }
+
+    bool Fixed64(uint64_t* v) {
+        if ( Remaining() < 8 )
+            return false;
+
+        *v = 0;
+
+        for ( int i = 0; i < 8; ++i )
+            *v |= static_cast<uint64_t>(p[i]) << (8 * i);
+
+        p += 8;
+        return true;
+    }
+
+    bool Double(double* d) {
+        uint64_t v;
+
+        if ( ! Fixed64(&v) )
+            return false;
+
+        memcpy(d, &v, sizeof(v));
+        return true;
+    }
+
+    bool Bytes(size_t len, const std::byte** data) {
+        if ( Remaining() < len )
+            return false;
+
+        *data = p;
+        p += len;
+        return true;
+    }
+
+    bool String(std::string_view* s) {
+        uint64_t len;
+        const std::byte* data;
+
+        if ( ! (Varint(&len) && Bytes(len, &data)) )
+            return false;
+
+        *s = {reinterpret_cast<const char*>(data), len};
+        return true;
+    }
+
+    // Reads a bitmap of n bits.
+    bool Bitmap(uint64_t n, std::vector<bool>* bits) {
+        const std::byte* data;
+
+        if ( ! Bytes((n + 7) / 8, &data) )
+            return false;
+
+        bits->resize(n);
+
+        for ( uint64_t i = 0; i < n; ++i )
+            (*bits)[i] = (static_cast<uint8_t>(data[i / 8]) >> (i % 8)) & 1;
+
+        return true;
+    }
+
+    // Reads the element count of a container, rejecting counts that can't
+    // possibly fit into the remaining bytes. Every element takes at least
+    // one byte.
+    bool Count(uint64_t* n) { return Varint(n) && *n <= Remaining(); }
+
+private:
+    const std::byte* p;
+    const std::byte* end;
+};
+
+void write_header(Encoder& e, uint8_t kind) {
+    e.Bytes(magic, sizeof(magic));
+    e.Byte(version);
+    e.Byte(kind);
+}
+
+bool read_header(Decoder& d, uint8_t kind) {
+    const std::byte* m;
+    uint8_t v, k;
+
+    if ( ! (d.Bytes(sizeof(magic), &m) && d.Byte(&v) && d.Byte(&k)) )
+        return false;
+
+    if ( memcmp(m, magic, sizeof(magic)) != 0 || v != version || k != kind ) {
+        zeek::reporter->Error("zeek-bin-v1: unexpected message header");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Computes a fingerprint over the structure of types: the type tags of
+ * all nested types, as well as record field names. Enum values are
+ * transmitted by name, so the enum's values are not part of it.
+ */
+class Fingerprinter {
+public:
+    void AddInt(uint64_t v) {
+        for ( int i = 0; i < 8; ++i )
+            AddByte(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void AddString(std::string_view s) {
+        AddInt(s.size());
+
+        for ( auto c : s )
+            AddByte(static_cast<uint8_t>(c));
+    }
+
+    void AddType(const zeek::Type* t) {
+        AddInt(t->Tag());
+
+        switch ( t->Tag() ) {
+            case zeek::TYPE_RECORD: {
+                auto rt = t->AsRecordType();
+
+                // Recursive types refer back to the record being visited.
+                for ( size_t i = 0; i < records.size(); ++i ) {
+                    if ( records[i] == rt ) {
+                        AddInt(UINT64_MAX);
+                        AddInt(i);
+                        return;
+                    }
+                }
+
+                records.push_back(rt);
+                AddInt(rt->NumFields());
+
+                for ( int i = 0; i < rt->NumFields(); ++i ) {
+                    AddString(rt->FieldName(i));
+                    AddType(rt->GetFieldType(i).get());
+                }
+
+                records.pop_back();
+                break;
+            }
+
+            case zeek::TYPE_TABLE: {
+                auto tt = t->AsTableType();
+                const auto& itypes = tt->GetIndexTypes();
+                AddInt(itypes.size());
+
+                for ( const auto& it : itypes )
+                    AddType(it.get());
+
+                if ( ! tt->IsSet() )
+                    AddType(tt->Yield().get());
+
+                break;
+            }
+
+            case zeek::TYPE_VECTOR: AddType(t->Yield().get()); break;
+
+            default: break;
+        }
+    }
+
+    uint64_t Hash() const { return hash; }
+
+private:
+    // 64-bit FNV-1a.
+    void AddByte(uint8_t b) {
+        hash ^= b;
+        hash *= 0x100000001b3ULL;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    std::vector<const zeek::RecordType*> records;
+};
+
+// Types that are transmitted without a name when they appear as an "any"
+// value.
+bool is_atomic(zeek::TypeTag tag) {
+    switch ( tag ) {
+        case zeek::TYPE_BOOL:
+        case zeek::TYPE_INT:
+        case zeek::TYPE_COUNT:
+        case zeek::TYPE_DOUBLE:
+        case zeek::TYPE_TIME:
+        case zeek::TYPE_INTERVAL:
+        case zeek::TYPE_STRING:
+        case zeek::TYPE_PATTERN:
+        case zeek::TYPE_ADDR:
+        case zeek::TYPE_SUBNET:
+        case zeek::TYPE_PORT: return true;
+
+        default: return false;
+    }
+}
+
+void encode_addr(Encoder& e, const zeek::IPAddr& a) {
+    const uint32_t* bytes;
+    int words = a.GetBytes(&bytes);
+    e.Byte(words == 1 ? 4 : 6);
+    e.Bytes(bytes, words * sizeof(uint32_t));
+}
+
+bool decode_addr(Decoder& d, zeek::IPAddr* a) {
+    uint8_t family;
+    const std::byte* data;
+
+    if ( ! d.Byte(&family) || (family != 4 && family != 6) )
+        return false;
+
+    size_t len = family == 4 ? 4 : 16;
+
+    if ( ! d.Bytes(len, &data) )
+        return false;
+
+    uint32_t bytes[4];
+    memcpy(bytes, data, len);
+    *a = zeek::IPAddr(family == 4 ? IPv4 : IPv6, bytes, zeek::IPAddr::Network);
+    return true;
+}
+
+bool decode_proto(uint8_t b, TransportProto* proto) {
+    switch ( b ) {
+        case TRANSPORT_UNKNOWN:
+        case TRANSPORT_TCP:
+        case TRANSPORT_UDP:
+        case TRANSPORT_ICMP: *proto = static_cast<TransportProto>(b); return true;
+
+        default: return false;
+    }
+}
+
+bool encode_val(Encoder& e, const zeek::Type* t, const zeek::Val* v) {
+    switch ( t->Tag() ) {
+        case zeek::TYPE_ANY: {
+            const auto& vt = v->GetType();
+            e.Byte(vt->Tag());
+
+            if ( ! is_atomic(vt->Tag()) ) {
+                // Other types need to be known to the receiver by name.
+                if ( vt->GetName().empty() ) {
+                    zeek::reporter->Error("zeek-bin-v1: cannot serialize unnamed %s type as any",
+                                          zeek::type_name(vt->Tag()));
+                    return false;
+                }
+
+                e.String(vt->GetName());
+            }
+
+            return encode_val(e, vt.get(), v);
+        }
+
+        case zeek::TYPE_BOOL: e.Byte(v->AsBool() ? 1 : 0); return true;
+
+        case zeek::TYPE_INT: e.Signed(v->AsInt()); return true;
+
+        case zeek::TYPE_COUNT: e.Varint(v->AsCount()); return true;
+
+        case zeek::TYPE_DOUBLE:
+        case zeek::TYPE_TIME:
+        case zeek::TYPE_INTERVAL: e.Double(v->AsDouble()); return true;
+
+        case zeek::TYPE_STRING: {
+            auto s = v->AsString();
+            e.String({reinterpret_cast<const char*>(s->Bytes()), static_cast<size_t>(s->Len())});
+            return true;
+        }
+
+        case zeek::TYPE_PATTERN: {
+            auto p = v->AsPattern();
+            e.String(p->PatternText());
+            e.String(p->AnywherePatternText());
+            return true;
+        }
+
+        case zeek::TYPE_ADDR: encode_addr(e, v->AsAddr()); return true;
+
+        case zeek::TYPE_SUBNET: {
+            const auto& s = v->AsSubNet();
+            encode_addr(e, s.Prefix());
+            e.Byte(s.Length());
+            return true;
+        }
+
+        case zeek::TYPE_PORT: {
+            auto p = v->AsPortVal();
+            e.Varint(p->Port());
+            e.Byte(p->PortType());
+            return true;
+        }
+
+        case zeek::TYPE_ENUM: {
+            auto name = t->AsEnumType()->Lookup(v->AsEnum());
+            e.String(name ? name : "<unknown enum>");
+            return true;
+        }
+
+        case zeek::TYPE_FUNC: {
+            const auto& name = v->AsFunc()->GetName();
+
+            if ( name.find("lambda_<") == 0 ) {
+                zeek::reporter->Error("zeek-bin-v1: cannot serialize lambda %s", name.c_str());
+                return false;
+            }
+
+            e.String(name);
+            return true;
+        }
+
+        case zeek::TYPE_RECORD: {
+            auto rt = t->AsRecordType();
+            auto rv = v->AsRecordVal();
+            std::vector<zeek::ValPtr> fields;
+            std::vector<bool> present;
+            fields.reserve(rt->NumFields());
+            present.reserve(rt->NumFields());
+
+            for ( int i = 0; i < rt->NumFields(); ++i ) {
+                fields.emplace_back(rv->GetFieldOrDefault(i));
+                present.push_back(fields.back() != nullptr);
+            }
+
+            e.Varint(fields.size());
+            e.Bitmap(present);
+
+            for ( size_t i = 0; i < fields.size(); ++i )
+                if ( fields[i] && ! encode_val(e, rt->GetFieldType(i).get(), fields[i].get()) )
+                    return false;
+
+            return true;
+        }
+
+        case zeek::TYPE_TABLE: {
+            auto tt = t->AsTableType();
+            auto tv = v->AsTableVal();
+            const auto& itypes = tt->GetIndexTypes();
+            e.Varint(tv->Size());
+
+            for ( const auto& te : *tv->AsTable() ) {
+                auto hk = te.GetHashKey();
+                auto idx = tv->RecreateIndex(*hk);
+
+                for ( int i = 0; i < idx->Length(); ++i )
+                    if ( ! encode_val(e, itypes[i].get(), idx->Idx(i).get()) )
+                        return false;
+
+                if ( ! tt->IsSet() && ! encode_val(e, tt->Yield().get(), te.value->GetVal().get()) )
+                    return false;
+            }
+
+            return true;
+        }
+
+        case zeek::TYPE_VECTOR: {
+            auto vv = v->AsVectorVal();
+            const auto& yield = t->Yield();
+            std::vector<bool> present;
+            present.reserve(vv->Size());
+
+            for ( unsigned int i = 0; i < vv->Size(); ++i )
+                present.push_back(vv->ValAt(i) != nullptr);
+
+            e.Varint(vv->Size());
+            e.Bitmap(present);
+
+            for ( unsigned int i = 0; i < vv->Size(); ++i ) {
+                auto item = vv->ValAt(i);
+
+                if ( item && ! encode_val(e, yield.get(), item.get()) )
+                    return false;
+            }
+
+            return true;
+        }
+
+        default:
+            zeek::reporter->Error("zeek-bin-v1: unsupported type for serialization: %s", zeek::type_name(t->Tag()));
+            return false;
+    }
+}
+
+zeek::ValPtr decode_val(Decoder& d, zeek::Type* t, int depth = 0) {
+    if ( depth > max_depth )
+        return nullptr;
+
+    switch ( t->Tag() ) {
+        case zeek::TYPE_ANY: {
+            uint8_t tag;
+
+            if ( ! d.Byte(&tag) )
+                return nullptr;
+
+            if ( is_atomic(static_cast<zeek::TypeTag>(tag)) )
+                return decode_val(d, zeek::base_type(static_cast<zeek::TypeTag>(tag)).get(), depth + 1);
+
+            std::string_view name;
+
+            if ( ! d.String(&name) )
+                return nullptr;
+
+            const auto& id = zeek::detail::global_scope()->Find(name);
+
+            if ( ! id || ! id->IsType() || id->GetType()->Tag() != tag ) {
+                zeek::reporter->Error("zeek-bin-v1: unknown type %s", std::string(name).c_str());
+                return nullptr;
+            }
+
+            return decode_val(d, id->GetType().get(), depth + 1);
+        }
+
+        case zeek::TYPE_BOOL: {
+            uint8_t b;
+
+            if ( ! d.Byte(&b) )
+                return nullptr;
+
+            return zeek::val_mgr->Bool(b != 0);
+        }
+
+        case zeek::TYPE_INT: {
+            int64_t i;
+
+            if ( ! d.Signed(&i) )
+                return nullptr;
+
+            return zeek::val_mgr->Int(i);
+        }
+
+        case zeek::TYPE_COUNT: {
+            uint64_t c;
+
+            if ( ! d.Varint(&c) )
+                return nullptr;
+
+            return zeek::val_mgr->Count(c);
+        }
+
+        case zeek::TYPE_DOUBLE:
+        case zeek::TYPE_TIME:
+        case zeek::TYPE_INTERVAL: {
+            double v;
+
+            if ( ! d.Double(&v) )
+                return nullptr;
+
+            if ( t->Tag() == zeek::TYPE_TIME )
+                return zeek::make_intrusive<zeek::TimeVal>(v);
+
+            if ( t->Tag() == zeek::TYPE_INTERVAL )
+                return zeek::make_intrusive<zeek::IntervalVal>(v);
+
+            return zeek::make_intrusive<zeek::DoubleVal>(v);
+        }
+
+        case zeek::TYPE_STRING: {
+            std::string_view s;
+
+            if ( ! d.String(&s) )
+                return nullptr;
+
+            return zeek::make_intrusive<zeek::StringVal>(s.size(), s.data());
+        }
+
+        case zeek::TYPE_PATTERN: {
+            std::string_view exact, anywhere;
+
+            if ( ! (d.String(&exact) && d.String(&anywhere)) )
+                return nullptr;
+
+            std::string exact_text(exact), anywhere_text(anywhere);
+            auto* re = new zeek::RE_Matcher(exact_text.c_str(), anywhere_text.c_str());
+
+            if ( ! re->Compile() ) {
+                zeek::reporter->Error("failed compiling unserialized pattern: %s, %s", exact_text.c_str(),
+                                      anywhere_text.c_str());
+                delete re;
+                return nullptr;
+            }
+
+            return zeek::make_intrusive<zeek::PatternVal>(re);
+        }
+
+        case zeek::TYPE_ADDR: {
+            zeek::IPAddr a;
+
+            if ( ! decode_addr(d, &a) )
+                return nullptr;
+
+            return zeek::make_intrusive<zeek::AddrVal>(a);
+        }
+
+        case zeek::TYPE_SUBNET: {
+            zeek::IPAddr a;
+            uint8_t length;
+
+            if ( ! (decode_addr(d, &a) && d.Byte(&length)) )
+                return nullptr;
+
+            if ( length > (a.GetFamily() == IPv4 ? 32 : 128) )
+                return nullptr;
+
+            return zeek::make_intrusive<zeek::SubNetVal>(zeek::IPPrefix(a, length));
+        }
+
+        case zeek::TYPE_PORT: {
+            uint64_t port;
+            uint8_t b;
+            TransportProto proto;
+
+            if ( ! (d.Varint(&port) && d.Byte(&b) && decode_proto(b, &proto)) || port > 65535 )
+                return nullptr;
+
+            return zeek::val_mgr->Port(port, proto);
+        }
+
+        case zeek::TYPE_ENUM: {
+            std::string_view name;
+
+            if ( ! d.String(&name) )
+                return nullptr;
+
+            auto etype = t->AsEnumType();
+            auto i = etype->Lookup(zeek::detail::GLOBAL_MODULE_NAME, std::string(name).c_str());
+
+            if ( i == -1 )
+                return nullptr;
+
+            return etype->GetEnumVal(i);
+        }
+
+        case zeek::TYPE_FUNC: {
+            std::string_view name;
+
+            if ( ! d.String(&name) )
+                return nullptr;
+
+            const auto& id = zeek::detail::global_scope()->Find(name);
+
+            if ( ! id || ! id->GetVal() || id->GetVal()->GetType()->Tag() != zeek::TYPE_FUNC )
+                return nullptr;
+
+            return id->GetVal();
+        }
+
+        case zeek::TYPE_RECORD: {
+            auto rt = t->AsRecordType();
+            uint64_t n;
+            std::vector<bool> present;
+
+            if ( ! d.Varint(&n) || n != static_cast<uint64_t>(rt->NumFields()) || ! d.Bitmap(n, &present) )
+                return nullptr;
+
+            auto rval = zeek::make_intrusive<zeek::RecordVal>(zeek::IntrusivePtr{zeek::NewRef{}, rt});
+
+            for ( uint64_t i = 0; i < n; ++i ) {
+                if ( ! present[i] )
+                    continue;
+
+                auto field = decode_val(d, rt->GetFieldType(i).get(), depth + 1);
+
+                if ( ! field )
+                    return nullptr;
+
+                rval->Assign(i, std::move(field));
+            }
+
+            return rval;
+        }
+
+        case zeek::TYPE_TABLE: {
+            auto tt = t->AsTableType();
+            const auto& itypes = tt->GetIndexTypes();
+            uint64_t n;
+
+            if ( ! d.Count(&n) )
+                return nullptr;
+
+            auto rval = zeek::make_intrusive<zeek::TableVal>(zeek::IntrusivePtr{zeek::NewRef{}, tt});
+
+            for ( uint64_t i = 0; i < n; ++i ) {
+                auto idx = zeek::make_intrusive<zeek::ListVal>(zeek::TYPE_ANY);
+
+                for ( const auto& it : itypes ) {
+                    auto v = decode_val(d, it.get(), depth + 1);
+
+                    if ( ! v )
+                        return nullptr;
+
+                    idx->Append(std::move(v));
+                }
+
+                zeek::ValPtr yield;
+
+                if ( ! tt->IsSet() && ! (yield = decode_val(d, tt->Yield().get(), depth + 1)) )
+                    return nullptr;
+
+                rval->Assign(std::move(idx), std::move(yield));
+            }
+
+            return rval;
+        }
+
+        case zeek::TYPE_VECTOR: {
+            auto vt = t->AsVectorType();
+            uint64_t n;
+            std::vector<bool> present;
+
+            if ( ! d.Varint(&n) || n > d.Remaining() * 8 || ! d.Bitmap(n, &present) )
+                return nullptr;
+
+            auto rval = zeek::make_intrusive<zeek::VectorVal>(zeek::IntrusivePtr{zeek::NewRef{}, vt});
+            rval->Resize(n);
+
+            for ( uint64_t i = 0; i < n; ++i ) {
+                if ( ! present[i] )
+                    continue;
+
+                auto item = decode_val(d, vt->Yield().get(), depth + 1);
+
+                if ( ! item )
+                    return nullptr;
+
+                rval->Assign(i, std::move(item));
+            }
+
+            return rval;
+        }
+
+        default: return nullptr;
+    }
+}
+
+void encode_log_addr(Encoder& e, const Value::addr_t& a) {
+    if ( a.family == IPv4 ) {
+        e.Byte(4);
+        e.Bytes(&a.in.in4, sizeof(a.in.in4));
+    }
+    else {
+        e.Byte(6);
+        e.Bytes(&a.in.in6, sizeof(a.in.in6));
+    }
+}
+
+bool decode_log_addr(Decoder& d, Value::addr_t* a) {
+    uint8_t family;
+    const std::byte* data;
+
+    if ( ! d.Byte(&family) )
+        return false;
+
+    if ( family == 4 && d.Bytes(sizeof(a->in.in4), &data) ) {
+        a->family = IPv4;
+        memcpy(&a->in.in4, data, sizeof(a->in.in4));
+        return true;
+    }
+
+    if ( family == 6 && d.Bytes(sizeof(a->in.in6), &data) ) {
+        a->family = IPv6;
+        memcpy(&a->in.in6, data, sizeof(a->in.in6));
+        return true;
+    }
+
+    return false;
+}
+
+bool encode_log_val(Encoder& e, zeek::TypeTag type, zeek::TypeTag subtype, const Value& v);
+
+// Encodes the elements of a set or vector.
+bool encode_log_elements(Encoder& e, zeek::TypeTag subtype, const Value::set_t& s) {
+    std::vector<bool> present;
+    present.reserve(s.size);
+
+    for ( zeek_int_t i = 0; i < s.size; ++i )
+        present.push_back(s.vals[i]->present);
+
+    e.Varint(s.size);
+    e.Bitmap(present);
+
+    for ( zeek_int_t i = 0; i < s.size; ++i )
+        if ( s.vals[i]->present && ! encode_log_val(e, subtype, zeek::TYPE_VOID, *s.vals[i]) )
+            return false;
+
+    return true;
+}
+
+bool encode_log_val(Encoder& e, zeek::TypeTag type, zeek::TypeTag subtype, const Value& v) {
+    if ( v.type != type ) {
+        zeek::reporter->Error("zeek-bin-v1: log value of type %s where %s was expected", zeek::type_name(v.type),
+                              zeek::type_name(type));
+        return false;
+    }
+
+    switch ( type ) {
+        case zeek::TYPE_BOOL:
+        case zeek::TYPE_INT: e.Signed(v.val.int_val); return true;
+
+        case zeek::TYPE_COUNT: e.Varint(v.val.uint_val); return true;
+
+        case zeek::TYPE_DOUBLE:
+        case zeek::TYPE_TIME:
+        case zeek::TYPE_INTERVAL: e.Double(v.val.double_val); return true;
+
+        case zeek::TYPE_PORT:
+            e.Varint(v.val.port_val.port);
+            e.Byte(v.val.port_val.proto);
+            return true;
+
+        case zeek::TYPE_ADDR: encode_log_addr(e, v.val.addr_val); return true;
+
+        case zeek::TYPE_SUBNET:
+            encode_log_addr(e, v.val.subnet_val.prefix);
+            e.Byte(v.val.subnet_val.length);
+            return true;
+
+        case zeek::TYPE_ENUM:
+        case zeek::TYPE_STRING:
+        case zeek::TYPE_FILE:
+        case zeek::TYPE_FUNC:
+            e.String({v.val.string_val.data, static_cast<size_t>(v.val.string_val.length)});
+            return true;
+
+        case zeek::TYPE_PATTERN: e.String(v.val.pattern_text_val); return true;
+
+        case zeek::TYPE_TABLE: return encode_log_elements(e, subtype, v.val.set_val);
+
+        case zeek::TYPE_VECTOR: return encode_log_elements(e, subtype, v.val.vector_val);
+
+        default:
+            zeek::reporter->Error("zeek-bin-v1: unsupported log value type: %s", zeek::type_name(type));
+            return false;
+    }
+}
+
+bool decode_log_val(Decoder& d, zeek::TypeTag type, zeek::TypeTag subtype, Value* v);
+
+bool decode_log_elements(Decoder& d, zeek::TypeTag subtype, Value::set_t* s) {
+    uint64_t n;
+    std::vector<bool> present;
+
+    // Containers of containers don't appear in logs.
+    if ( subtype == zeek::TYPE_TABLE || subtype == zeek::TYPE_VECTOR )
+        return false;
+
+    if ( ! d.Varint(&n) || n > d.Remaining() * 8 || ! d.Bitmap(n, &present) )
+        return false;
+
+    s->vals = new Value*[n];
+    s->size = 0;
+
+    for ( uint64_t i = 0; i < n; ++i ) {
+        auto* elem = new Value(subtype, present[i]);
+        s->vals[s->size++] = elem;
+
+        if ( present[i] && ! decode_log_val(d, subtype, zeek::TYPE_VOID, elem) )
+            return false;
+    }
+
+    return true;
+}
+
+bool decode_log_val(Decoder& d, zeek::TypeTag type, zeek::TypeTag subtype, Value* v) {
+    switch ( type ) {
+        case zeek::TYPE_BOOL:
+        case zeek::TYPE_INT: {
+            int64_t i;
+
+            if ( ! d.Signed(&i) )
+                return false;
+
+            v->val.int_val = i;
+            return true;
+        }
+
+        case zeek::TYPE_COUNT: {
+            uint64_t c;
+
+            if ( ! d.Varint(&c) )
+                return false;
+
+            v->val.uint_val = c;
+            return true;
+        }
+
+        case zeek::TYPE_DOUBLE:
+        case zeek::TYPE_TIME:
+        case zeek::TYPE_INTERVAL: return d.Double(&v->val.double_val);
+
+        case zeek::TYPE_PORT: {
+            uint64_t port;
+            uint8_t b;
+
+            if ( ! (d.Varint(&port) && d.Byte(&b)) )
+                return false;
+
+            v->val.port_val.port = port;
+            return decode_proto(b, &v->val.port_val.proto);
+        }
+
+        case zeek::TYPE_ADDR: return decode_log_addr(d, &v->val.addr_val);
+
+        case zeek::TYPE_SUBNET:
+            return decode_log_addr(d, &v->val.subnet_val.prefix) && d.Byte(&v->val.subnet_val.length);
+
+        case zeek::TYPE_ENUM:
+        case zeek::TYPE_STRING:
+        case zeek::TYPE_FILE:
+        case zeek::TYPE_FUNC: {
+            std::string_view s;
+
+            if ( ! d.String(&s) )
+                return false;
+
+            v->val.string_val.data = new char[s.size()];
+            v->val.string_val.length = static_cast<int>(s.size());
+            memcpy(v->val.string_val.data, s.data(), s.size());
+            return true;
+        }
+
+        case zeek::TYPE_PATTERN: {
+            std::string_view s;
+
+            if ( ! d.String(&s) )
+                return false;
+
+            v->val.pattern_text_val = zeek::util::copy_string(s.data(), s.size());
+            return true;
+        }
+
+        case zeek::TYPE_TABLE: return decode_log_elements(d, subtype, &v->val.set_val);
+
+        case zeek::TYPE_VECTOR: return decode_log_elements(d, subtype, &v->val.vector_val);
+
+        default: return false;
+    }
+}
+
+} // namespace
+
+uint64_t detail::ZeekBinV1_Serializer::Signature(EventHandlerPtr handler) {
+    if ( auto it = signatures.find(handler.Ptr()); it != signatures.end() )
+        return it->second;
+
+    Fingerprinter f;
+    const auto& ft = handler->GetType();
+
+    if ( ft ) {
+        const auto& params = ft->ParamList()->GetTypes();
+        f.AddInt(params.size());
+
+        for ( const auto& p : params )
+            f.AddType(p.get());
+    }
+
+    signatures.emplace(handler.Ptr(), f.Hash());
+    return f.Hash();
+}
+
+bool detail::ZeekBinV1_Serializer::SerializeEvent(detail::byte_buffer& buf, const detail::Event& event) {
+    EventHandlerPtr handler = event.Handler();
+    const auto& ft = handler->GetType();
+
+    if ( ! ft ) {
+        reporter->Error("zeek-bin-v1: no type for event '%s'", handler->Name());
+        return false;
+    }
+
+    const auto& params = ft->ParamList()->GetTypes();
+
+    if ( params.size() != event.args.size() ) {
+        reporter->Error("zeek-bin-v1: event '%s' expects %zu arguments, got %zu", handler->Name(), params.size(),
+                        event.args.size());
+        return false;
+    }
+
+    Encoder e(buf);
+    write_header(e, kind_event);
+    e.String(event.HandlerName());
+    e.Fixed64(Signature(handler));
+    e.Double(event.timestamp);
+    e.Varint(event.args.size());
+
+    for ( size_t i = 0; i < params.size(); ++i )
+        if ( ! encode_val(e, params[i].get(), event.args[i].get()) )
+            return false;
+
+    return true;
+}
+
+std::optional<detail::Event> detail::ZeekBinV1_Serializer::UnserializeEvent(detail::byte_buffer_span buf) {
+    Decoder d(buf);
+    std::string_view name;
+    uint64_t signature, nargs;
+    double ts;
+
+    if ( ! (read_header(d, kind_event) && d.String(&name) && d.Fixed64(&signature) && d.Double(&ts) &&
+            d.Varint(&nargs)) )
+        return std::nullopt;
+
+    std::string event_name(name);
+    EventHandlerPtr handler = event_registry->Lookup(event_name);
+
+    if ( ! handler ) {
+        reporter->Error("Failed to lookup handler for '%s'", event_name.c_str());
+        return std::nullopt;
+    }
+
+    const auto& ft = handler->GetType();
+
+    if ( ! ft || signature != Signature(handler) ) {
+        reporter->Error("Unserialize error for event '%s': mismatching parameter types", event_name.c_str());
+        return std::nullopt;
+    }
+
+    const auto& params = ft->ParamList()->GetTypes();
+
+    if ( params.size() != nargs ) {
+        reporter->Error("Unserialize error '%s' arg_types.size()=%zu and args.size()=%" PRIu64, event_name.c_str(),
+                        params.size(), nargs);
+        return std::nullopt;
+    }
+
+    zeek::Args vl;
+    vl.reserve(params.size());
+
+    for ( const auto& p : params ) {
+        auto val = decode_val(d, p.get());
+
+        if ( ! val ) {
+            reporter->Error("Unserialize error for event '%s': failed to decode %s argument", event_name.c_str(),
+                            obj_desc(p.get()).c_str());
+            return std::nullopt;
+        }
+
+        vl.emplace_back(std::move(val));
+    }
+
+    return detail::Event{handler, std::move(vl), ts};
+}
+
+bool detail::ZeekBinV1_LogSerializer::SerializeLogWrite(detail::byte_buffer& buf,
+                                                        const logging::detail::LogWriteHeader& header,
+                                                        zeek::Span<logging::detail::LogRecord> records) {
+    Encoder e(buf);
+    write_header(e, kind_log_write);
+    e.String(header.stream_name);
+    e.String(header.writer_name);
+    e.String(header.filter_name);
+    e.String(header.path);
+    e.Varint(header.fields.size());
+
+    for ( const auto& f : header.fields ) {
+        e.String(f.name ? f.name : "");
+        e.Byte(f.secondary_name ? 1 : 0);
+
+        if ( f.secondary_name )
+            e.String(f.secondary_name);
+
+        e.Byte(f.type);
+        e.Byte(f.subtype);
+        e.Byte(f.optional ? 1 : 0);
+    }
+
+    e.Varint(records.size());
+
+    std::vector<bool> present(header.fields.size());
+
+    for ( const auto& rec : records ) {
+        if ( rec.size() != header.fields.size() ) {
+            reporter->Error("zeek-bin-v1: log record with %zu fields for a schema of %zu", rec.size(),
+                            header.fields.size());
+            return false;
+        }
+
+        for ( size_t i = 0; i < rec.size(); ++i )
+            present[i] = rec[i].present;
+
+        e.Bitmap(present);
+
+        for ( size_t i = 0; i < rec.size(); ++i ) {
+            const auto& f = header.fields[i];
+
+            if ( rec[i].present && ! encode_log_val(e, f.type, f.subtype, rec[i]) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+std::optional<zeek::logging::detail::LogWriteBatch> detail::ZeekBinV1_LogSerializer::UnserializeLogWrite(
+    detail::byte_buffer_span buf) {
+    Decoder d(buf);
+    logging::detail::LogWriteBatch batch;
+    auto& header = batch.header;
+    std::string_view stream_name, writer_name, filter_name, path;
+    uint64_t num_fields, num_records;
+
+    if ( ! (read_header(d, kind_log_write) && d.String(&stream_name) && d.String(&writer_name) &&
+            d.String(&filter_name) && d.String(&path) && d.Count(&num_fields)) )
+        return std::nullopt;
+
+    header.stream_name = stream_name;
+    header.writer_name = writer_name;
+    header.filter_name = filter_name;
+    header.path = path;
+    header.fields.reserve(num_fields);
+
+    for ( uint64_t i = 0; i < num_fields; ++i ) {
+        std::string_view name, secondary_name;
+        uint8_t has_secondary, type, subtype, optional;
+
+        if ( ! (d.String(&name) && d.Byte(&has_secondary)) )
+            return std::nullopt;
+
+        if ( has_secondary && ! d.String(&secondary_name) )
+            return std::nullopt;
+
+        if ( ! (d.Byte(&type) && d.Byte(&subtype) && d.Byte(&optional)) )
+            return std::nullopt;
+
+        std::string n(name), sn(secondary_name);
+        header.fields.emplace_back(n.c_str(), has_secondary ? sn.c_str() : nullptr, static_cast<TypeTag>(type),
+                                   static_cast<TypeTag>(subtype), optional != 0);
+    }
+
+    if ( ! header.PopulateEnumVals() ) {
+        reporter->Error("zeek-bin-v1: unknown stream %s or writer %s", header.stream_name.c_str(),
+                        header.writer_name.c_str());
+        return std::nullopt;
+    }
+
+    if ( ! d.Varint(&num_records) || num_records > d.Remaining() )
+        return std::nullopt;
+
+    batch.records.reserve(num_records);
+
+    std::vector<bool> present;
+
+    for ( uint64_t r = 0; r < num_records; ++r ) {
+        if ( ! d.Bitmap(num_fields, &present) )
+            return std::nullopt;
+
+        auto& rec = batch.records.emplace_back();
+        rec.reserve(num_fields);
+
+        for ( uint64_t i = 0; i < num_fields; ++i ) {
+            const auto& f = header.fields[i];
+            auto& v = rec.emplace_back(f.type, f.subtype, present[i]);
+
+            if ( present[i] && ! decode_log_val(d, f.type, f.subtype, &v) ) {
+                reporter->Error("zeek-bin-v1: failed to decode log field %s", f.name);
+                return std::nullopt;
+            }
+        }
+    }
+
+    return batch;
+}
+
+TEST_SUITE_BEGIN("cluster serializer zeek-bin-v1");
+
+TEST_CASE("varints") {
+    detail::byte_buffer buf;
+    Encoder e(buf);
+    e.Varint(0);
+    e.Varint(127);
+    e.Varint(128);
+    e.Varint(UINT64_MAX);
+    e.Signed(-1);
+    e.Signed(INT64_MIN);
+
+    CHECK_EQ(buf.size(), 1 + 1 + 2 + 10 + 1 + 10);
+
+    Decoder d(buf);
+    uint64_t u;
+    int64_t i;
+    REQUIRE(d.Varint(&u));
+    CHECK_EQ(u, 0);
+    REQUIRE(d.Varint(&u));
+    CHECK_EQ(u, 127);
+    REQUIRE(d.Varint(&u));
+    CHECK_EQ(u, 128);
+    REQUIRE(d.Varint(&u));
+    CHECK_EQ(u, UINT64_MAX);
+    REQUIRE(d.Signed(&i));
+    CHECK_EQ(i, -1);
+    REQUIRE(d.Signed(&i));
+    CHECK_EQ(i, INT64_MIN);
+    CHECK_EQ(d.Remaining(), 0);
+    CHECK_FALSE(d.Varint(&u));
+}
+
+TEST_CASE("event roundtrip") {
+    auto* handler = zeek::event_registry->Lookup("Supervisor::node_status");
+    detail::Event e{handler, zeek::Args{zeek::make_intrusive<zeek::StringVal>("TEST"), zeek::val_mgr->Count(42)}};
+    detail::byte_buffer buf;
+    detail::ZeekBinV1_Serializer serializer;
+
+    REQUIRE(serializer.SerializeEvent(buf, e));
+
+    // Header, name, signature, timestamp, argument count, "TEST" and 42.
+    CHECK_EQ(buf.size(), 4 + 24 + 8 + 8 + 1 + 5 + 1);
+
+    auto result = serializer.UnserializeEvent(buf);
+    REQUIRE(result);
+    CHECK_EQ(result->Handler(), handler);
+    CHECK_EQ(result->HandlerName(), "Supervisor::node_status");
+    REQUIRE_EQ(result->args.size(), 2);
+    CHECK_EQ(result->args[0]->AsString()->CheckString(), std::string("TEST"));
+    CHECK_EQ(result->args[1]->AsCount(), 42);
+
+    SUBCASE("truncated") {
+        for ( size_t len = 0; len < buf.size(); ++len )
+            CHECK_FALSE(serializer.UnserializeEvent({buf.data(), len}));
+    }
+}
+
+TEST_CASE("log write roundtrip") {
+    zeek::logging::detail::LogWriteHeader header;
+    header.stream_name = "Conn::LOG";
+    header.writer_name = "Log::WRITER_ASCII";
+    header.filter_name = "default";
+    header.path = "conn";
+    header.fields.emplace_back("s", nullptr, zeek::TYPE_STRING, zeek::TYPE_VOID, true);
+    header.fields.emplace_back("c", nullptr, zeek::TYPE_COUNT, zeek::TYPE_VOID, false);
+    header.fields.emplace_back("v", nullptr, zeek::TYPE_VECTOR, zeek::TYPE_INT, false);
+
+    std::vector<zeek::logging::detail::LogRecord> records(2);
+
+    for ( auto& rec : records ) {
+        rec.emplace_back(zeek::TYPE_STRING, false);
+        rec.emplace_back(zeek::TYPE_COUNT);
+        rec.back().val.uint_val = 4711;
+        rec.emplace_back(zeek::TYPE_VECTOR, zeek::TYPE_INT);
+        rec.back().val.vector_val.size = 1;
+        rec.back().val.vector_val.vals = new Value*[1];
+        rec.back().val.vector_val.vals[0] = new Value(zeek::TYPE_INT);
+        rec.back().val.vector_val.vals[0]->val.int_val = -3;
+    }
+
+    records[0][0].present = true;
+    records[0][0].val.string_val.data = zeek::util::copy_string("abc");
+    records[0][0].val.string_val.length = 3;
+
+    detail::byte_buffer buf;
+    detail::ZeekBinV1_LogSerializer serializer;
+    REQUIRE(serializer.SerializeLogWrite(buf, header, records));
+
+    // Check the record encoding without needing the stream and writer enums.
+    Decoder d(buf);
+    std::string_view s;
+    uint64_t u;
+    int64_t i;
+    std::vector<bool> present;
+
+    REQUIRE(read_header(d, kind_log_write));
+
+    for ( int j = 0; j < 4; ++j )
+        REQUIRE(d.String(&s));
+
+    REQUIRE(d.Varint(&u));
+    REQUIRE_EQ(u, 3);
+
+    for ( int j = 0; j < 3; ++j ) {
+        uint8_t b;
+        REQUIRE(d.String(&s));
+        REQUIRE(d.Byte(&b));
+        CHECK_EQ(b, 0);
+        REQUIRE(d.Byte(&b));
+        CHECK_EQ(b, header.fields[j].type);
+        REQUIRE(d.Byte(&b));
+        REQUIRE(d.Byte(&b));
+    }
+
+    REQUIRE(d.Varint(&u));
+    CHECK_EQ(u, 2);
+
+    Value v(zeek::TYPE_STRING);
+    REQUIRE(d.Bitmap(3, &present));
+    CHECK(present[0]);
+    REQUIRE(decode_log_val(d, zeek::TYPE_STRING, zeek::TYPE_VOID, &v));
+    CHECK_EQ(std::string(v.val.string_val.data, v.val.string_val.length), "abc");
+    REQUIRE(d.Varint(&u));
+    CHECK_EQ(u, 4711);
+    REQUIRE(d.Varint(&u));
+    CHECK_EQ(u, 1);
+    REQUIRE(d.Bitmap(1, &present));
+    REQUIRE(d.Signed(&i));
+    CHECK_EQ(i, -3);
+
+    REQUIRE(d.Bitmap(3, &present));
+    CHECK_FALSE(present[0]);
+    CHECK(present[1]);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,42 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "zeek/EventHandler.h"
+#include "zeek/cluster/Serializer.h"
+
+namespace zeek::cluster::detail {
+
+// Implementation of the EventSerializer encoding event arguments directly
+// from their Vals, guided by the parameter types of the event.
+class ZeekBinV1_Serializer : public EventSerializer {
+public:
+    ZeekBinV1_Serializer() : EventSerializer("zeek-bin-v1") {}
+
+    bool SerializeEvent(detail::byte_buffer& buf, const detail::Event& event) override;
+
+    std::optional<detail::Event> UnserializeEvent(detail::byte_buffer_span buf) override;
+
+private:
+    uint64_t Signature(EventHandlerPtr handler);
+
+    // Fingerprints of event handlers' parameter types, computed on first use.
+    std::unordered_map<const EventHandler*, uint64_t> signatures;
+};
+
+// Implementation of the LogSerializer encoding log records directly from
+// their threading::Values, guided by the log schema in the header.
+class ZeekBinV1_LogSerializer : public LogSerializer {
+public:
+    ZeekBinV1_LogSerializer() : LogSerializer("zeek-bin-v1") {}
+
+    bool SerializeLogWrite(detail::byte_buffer& buf, const logging::detail::LogWriteHeader& header,
+                           zeek::Span<logging::detail::LogRecord> records) override;
+
+    std::optional<logging::detail::LogWriteBatch> UnserializeLogWrite(detail::byte_buffer_span buf) override;
+};
+
+} // namespace zeek::cluster::detail
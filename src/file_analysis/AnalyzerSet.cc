@@ -20,13 +20,17 @@ static void analyzer_del_func(void* v) {
 
 AnalyzerSet::AnalyzerSet(File* arg_file) : file(arg_file) { analyzer_map.SetDeleteFunc(analyzer_del_func); }
 
-AnalyzerSet::~AnalyzerSet() {
+AnalyzerSet::~AnalyzerSet() { Clear(); }
+
+void AnalyzerSet::Clear() {
     while ( ! mod_queue.empty() ) {
         Modification* mod = mod_queue.front();
         mod->Abort();
         delete mod;
         mod_queue.pop();
     }
+
+    analyzer_map.Clear();
 }
 
 Analyzer* AnalyzerSet::Find(const zeek::Tag& tag, RecordValPtr args) {
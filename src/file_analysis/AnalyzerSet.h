@@ -40,6 +40,12 @@ public:
      */
     ~AnalyzerSet();
 
+    /**
+     * Aborts any queued additions/removals and destroys all analyzers, like
+     * the destructor, leaving an empty set.
+     */
+    void Clear();
+
     /**
      * Looks up an analyzer by its tag and arguments.
      * @param tag an analyzer tag.
@@ -86,13 +86,44 @@ File::File(const std::string& file_id, const std::string& source_name, Connectio
       reassembly_enabled(false),
       postpone_timeout(false),
       done(false),
+      timer_deferred(false),
       analyzers(this) {
     StaticInit();
 
     DBG_LOG(DBG_FILE_ANALYSIS, "[%s] Creating new File object", file_id.c_str());
 
+    Init(source_name, conn, is_orig);
+}
+
+File::~File() {
+    DBG_LOG(DBG_FILE_ANALYSIS, "[%s] Destroying File object", id.c_str());
+    delete file_reassembler;
+
+    for ( auto a : done_analyzers )
+        delete a;
+}
+
+void File::Reuse(const std::string& file_id, const std::string& source_name, Connection* conn, zeek::Tag tag,
+                 bool is_orig) {
+    DBG_LOG(DBG_FILE_ANALYSIS, "[%s] Reusing File object of %s", file_id.c_str(), id.c_str());
+
+    Clear();
+
+    id = file_id;
+    stream_offset = 0;
+    reassembly_max_buffer = 0;
+    did_metadata_inference = false;
+    reassembly_enabled = false;
+    postpone_timeout = false;
+    done = false;
+    timer_deferred = false;
+
+    Init(source_name, conn, is_orig);
+}
+
+void File::Init(const std::string& source_name, Connection* conn, bool is_orig) {
     val = make_intrusive<RecordVal>(id::fa_file);
-    val->Assign(id_idx, file_id);
+    val->Assign(id_idx, id);
     SetSource(source_name);
 
     if ( conn ) {
@@ -103,12 +134,20 @@ File::File(const std::string& file_id, const std::string& source_name, Connectio
     UpdateLastActivityTime();
 }
 
-File::~File() {
-    DBG_LOG(DBG_FILE_ANALYSIS, "[%s] Destroying File object", id.c_str());
+void File::Clear() {
     delete file_reassembler;
+    file_reassembler = nullptr;
 
+    // Same order as in the destructor: removed analyzers first, then the
+    // ones still attached.
     for ( auto a : done_analyzers )
         delete a;
+
+    done_analyzers.clear();
+    analyzers.Clear();
+    bof_buffer.Clear();
+    weird_state.clear();
+    val = nullptr;
 }
 
 void File::UpdateLastActivityTime() { val->AssignTime(last_active_idx, run_state::network_time); }
@@ -222,6 +222,25 @@ protected:
     File(const std::string& file_id, const std::string& source_name, Connection* conn = nullptr,
          zeek::Tag tag = zeek::Tag::Error, bool is_orig = false);
 
+    /**
+     * Turns a removed file into a new one, with the same effect as
+     * destroying and constructing it again, but keeping its allocations.
+     * The parameters are those of the constructor.
+     */
+    void Reuse(const std::string& file_id, const std::string& source_name, Connection* conn = nullptr,
+               zeek::Tag tag = zeek::Tag::Error, bool is_orig = false);
+
+    /**
+     * Initializes the #val record for a new file.
+     */
+    void Init(const std::string& source_name, Connection* conn, bool is_orig);
+
+    /**
+     * Releases everything attached to the file: reassembler, analyzers and
+     * BOF buffer.
+     */
+    void Clear();
+
     /**
      * Updates the "conn_ids" and "conn_uids" fields in #val record with the
      * \c conn_id and UID taken from \a conn.
@@ -325,15 +344,22 @@ protected:
     bool reassembly_enabled;             /**< Whether file stream reassembly is needed. */
     bool postpone_timeout;               /**< Whether postponing timeout is requested. */
     bool done;                           /**< If this object is about to be deleted. */
+    bool timer_deferred;                 /**< If the Manager has yet to schedule the inactivity timer. */
     detail::AnalyzerSet analyzers;       /**< A set of attached file analyzers. */
     std::list<Analyzer*> done_analyzers; /**< Analyzers we're done with, remembered here until they
                                             can be safely deleted. */
 
     struct BOF_Buffer {
         BOF_Buffer() : full(false), size(0) {}
-        ~BOF_Buffer() {
+        ~BOF_Buffer() { Clear(); }
+
+        void Clear() {
             for ( size_t i = 0; i < chunks.size(); ++i )
                 delete chunks[i];
+
+            chunks.clear();
+            full = false;
+            size = 0;
         }
 
         bool full;
@@ -3,6 +3,7 @@
 #include "zeek/file_analysis/Manager.h"
 
 #include <openssl/md5.h>
+#include <algorithm>
 
 #include "zeek/CompHash.h"
 #include "zeek/Event.h"
@@ -18,6 +19,9 @@ using namespace std;
 
 namespace zeek::file_analysis {
 
+// Upper bound for the number of removed File objects kept for reuse.
+static constexpr size_t max_pooled_files = 1024;
+
 Manager::Manager()
     : plugin::ComponentManager<file_analysis::Component>("Files", "Tag", "AllAnalyzers"),
       current_file_id(),
@@ -34,6 +38,9 @@ Manager::~Manager() {
     for ( const auto& entry : id_map )
         delete entry.second;
 
+    for ( auto* f : file_pool )
+        delete f;
+
     delete magic_state;
     delete analyzer_hash;
 }
@@ -59,6 +66,9 @@ void Manager::Terminate() {
     for ( const auto& entry : id_map )
         keys.push_back(entry.first);
 
+    // Time out files in a deterministic order.
+    std::sort(keys.begin(), keys.end());
+
     for ( const string& key : keys )
         Timeout(key, true);
 
@@ -91,7 +101,7 @@ void Manager::SetHandle(const string& handle) {
 string Manager::DataIn(const u_char* data, uint64_t len, uint64_t offset, const zeek::Tag& tag, Connection* conn,
                        bool is_orig, const string& precomputed_id, const string& mime_type) {
     string id = precomputed_id.empty() ? GetFileID(tag, conn, is_orig) : precomputed_id;
-    File* file = GetFile(id, conn, tag, is_orig);
+    File* file = GetFileForDelivery(id, conn, tag, is_orig);
 
     if ( ! file )
         return "";
@@ -107,10 +117,8 @@ string Manager::DataIn(const u_char* data, uint64_t len, uint64_t offset, const
 
     file->DataIn(data, len, offset);
 
-    if ( file->IsComplete() ) {
-        RemoveFile(file->GetID());
+    if ( FinishDelivery(file) )
         return "";
-    }
 
     return id;
 }
@@ -120,7 +128,7 @@ string Manager::DataIn(const u_char* data, uint64_t len, const zeek::Tag& tag, C
     string id = precomputed_id.empty() ? GetFileID(tag, conn, is_orig) : precomputed_id;
     // Sequential data input shouldn't be going over multiple conns, so don't
     // do the check to update connection set.
-    File* file = GetFile(id, conn, tag, is_orig, false);
+    File* file = GetFileForDelivery(id, conn, tag, is_orig, false);
 
     if ( ! file )
         return "";
@@ -130,17 +138,15 @@ string Manager::DataIn(const u_char* data, uint64_t len, const zeek::Tag& tag, C
 
     file->DataIn(data, len);
 
-    if ( file->IsComplete() ) {
-        RemoveFile(file->GetID());
+    if ( FinishDelivery(file) )
         return "";
-    }
 
     return id;
 }
 
 void Manager::DataIn(const u_char* data, uint64_t len, const string& file_id, const string& source,
                      const string& mime_type) {
-    File* file = GetFile(file_id, nullptr, zeek::Tag::Error, false, false, source.c_str());
+    File* file = GetFileForDelivery(file_id, nullptr, zeek::Tag::Error, false, false, source.c_str());
 
     if ( ! file )
         return;
@@ -149,14 +155,12 @@ void Manager::DataIn(const u_char* data, uint64_t len, const string& file_id, co
         file->SetMime(mime_type);
 
     file->DataIn(data, len);
-
-    if ( file->IsComplete() )
-        RemoveFile(file->GetID());
+    FinishDelivery(file);
 }
 
 void Manager::DataIn(const u_char* data, uint64_t len, uint64_t offset, const string& file_id, const string& source,
                      const string& mime_type) {
-    File* file = GetFile(file_id, nullptr, zeek::Tag::Error, false, false, source.c_str());
+    File* file = GetFileForDelivery(file_id, nullptr, zeek::Tag::Error, false, false, source.c_str());
 
     if ( ! file )
         return;
@@ -165,9 +169,7 @@ void Manager::DataIn(const u_char* data, uint64_t len, uint64_t offset, const st
         file->SetMime(mime_type);
 
     file->DataIn(data, len, offset);
-
-    if ( file->IsComplete() )
-        RemoveFile(file->GetID());
+    FinishDelivery(file);
 }
 
 void Manager::EndOfFile(const zeek::Tag& tag, Connection* conn) {
@@ -284,6 +286,18 @@ bool Manager::RemoveAnalyzer(const string& file_id, const zeek::Tag& tag, Record
 
 File* Manager::GetFile(const string& file_id, Connection* conn, const zeek::Tag& tag, bool is_orig, bool update_conn,
                        const char* source_name) {
+    File* rval = GetFileForDelivery(file_id, conn, tag, is_orig, update_conn, source_name);
+
+    if ( rval && rval->timer_deferred ) {
+        rval->timer_deferred = false;
+        rval->ScheduleInactivityTimer();
+    }
+
+    return rval;
+}
+
+File* Manager::GetFileForDelivery(const string& file_id, Connection* conn, const zeek::Tag& tag, bool is_orig,
+                                  bool update_conn, const char* source_name) {
     if ( file_id.empty() )
         return nullptr;
 
@@ -293,14 +307,23 @@ File* Manager::GetFile(const string& file_id, Connection* conn, const zeek::Tag&
     File* rval = LookupFile(file_id);
 
     if ( ! rval ) {
-        rval = new File(file_id, source_name ? source_name : analyzer_mgr->GetComponentName(tag), conn, tag, is_orig);
+        std::string source = source_name ? source_name : analyzer_mgr->GetComponentName(tag);
+
+        if ( ! file_pool.empty() ) {
+            rval = file_pool.back();
+            file_pool.pop_back();
+            rval->Reuse(file_id, source, conn, tag, is_orig);
+        }
+        else
+            rval = new File(file_id, source, conn, tag, is_orig);
+
         id_map[file_id] = rval;
 
         ++cumulative_files;
         if ( id_map.size() > max_files )
             max_files = id_map.size();
 
-        rval->ScheduleInactivityTimer();
+        rval->timer_deferred = true;
 
         // Generate file_new after inserting it into manager's mapping
         // in case script-layer calls back into core from the event.
@@ -308,8 +331,12 @@ File* Manager::GetFile(const string& file_id, Connection* conn, const zeek::Tag&
         // Same for file_over_new_connection.
         rval->RaiseFileOverNewConnection(conn, is_orig);
 
-        if ( IsIgnored(file_id) )
+        if ( IsIgnored(file_id) ) {
+            // No delivery will follow, so the file needs its timer now.
+            rval->timer_deferred = false;
+            rval->ScheduleInactivityTimer();
             return nullptr;
+        }
     }
     else {
         rval->UpdateLastActivityTime();
@@ -321,6 +348,20 @@ File* Manager::GetFile(const string& file_id, Connection* conn, const zeek::Tag&
     return rval;
 }
 
+bool Manager::FinishDelivery(File* file) {
+    if ( file->IsComplete() ) {
+        RemoveFile(file);
+        return true;
+    }
+
+    if ( file->timer_deferred ) {
+        file->timer_deferred = false;
+        file->ScheduleInactivityTimer();
+    }
+
+    return false;
+}
+
 File* Manager::LookupFile(const string& file_id) const {
     const auto& entry = id_map.find(file_id);
     if ( entry == id_map.end() )
@@ -370,14 +411,24 @@ bool Manager::RemoveFile(const string& file_id) {
     if ( ! f )
         return false;
 
-    DBG_LOG(DBG_FILE_ANALYSIS, "[%s] Remove file", file_id.c_str());
+    RemoveFile(f);
+    return true;
+}
+
+void Manager::RemoveFile(File* f) {
+    DBG_LOG(DBG_FILE_ANALYSIS, "[%s] Remove file", f->GetID().c_str());
 
     f->EndOfFile();
 
-    id_map.erase(file_id);
-    ignored.erase(file_id);
-    delete f;
-    return true;
+    id_map.erase(f->GetID());
+    ignored.erase(f->GetID());
+
+    if ( file_pool.size() < max_pooled_files ) {
+        f->Clear();
+        file_pool.push_back(f);
+    }
+    else
+        delete f;
 }
 
 bool Manager::IsIgnored(const string& file_id) { return ignored.find(file_id) != ignored.end(); }
@@ -5,6 +5,9 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "zeek/RuleMatcher.h"
 #include "zeek/Tag.h"
@@ -396,6 +399,24 @@ protected:
     File* GetFile(const std::string& file_id, Connection* conn = nullptr, const zeek::Tag& tag = zeek::Tag::Error,
                   bool is_orig = false, bool update_conn = true, const char* source_name = nullptr);
 
+    /**
+     * Like GetFile(), but defers the inactivity timer of a new file to
+     * FinishDelivery(), which won't need it if the file completes with the
+     * data being delivered.
+     */
+    File* GetFileForDelivery(const std::string& file_id, Connection* conn, const zeek::Tag& tag, bool is_orig,
+                             bool update_conn = true, const char* source_name = nullptr);
+
+    /**
+     * Wraps up the delivery of data to a file obtained from
+     * GetFileForDelivery(): removes the file if it's complete, and otherwise
+     * makes sure it has an inactivity timer. Single-chunk files thus never
+     * need a timer, and their File object goes right back to the pool.
+     * @param file the file.
+     * @return true if the file was removed.
+     */
+    bool FinishDelivery(File* file);
+
     /**
      * Evaluate timeout policy for a file and remove the File object mapped to
      * \a file_id if needed.
@@ -412,6 +433,12 @@ protected:
      */
     bool RemoveFile(const std::string& file_id);
 
+    /**
+     * Removes the given file, which must be in #id_map, and recycles its
+     * File object.
+     */
+    void RemoveFile(File* f);
+
     /**
      * Check if analysis is available for files transferred over a given
      * network protocol.
@@ -428,8 +455,9 @@ private:
 
     TagSet* LookupMIMEType(const std::string& mtype, bool add_if_not_found);
 
-    std::map<std::string, File*> id_map;           /**< Map file ID to file_analysis::File records. */
-    std::set<std::string> ignored;                 /**< Ignored files.  Will be finally removed on EOF. */
+    std::unordered_map<std::string, File*> id_map; /**< Map file ID to file_analysis::File records. */
+    std::unordered_set<std::string> ignored;       /**< Ignored files.  Will be finally removed on EOF. */
+    std::vector<File*> file_pool;                  /**< Removed File objects kept for reuse. */
     std::string current_file_id;                   /**< Hash of what get_file_handle event sets. */
     zeek::detail::RuleFileMagicState* magic_state; /**< File magic signature match state. */
     MIMEMap mime_types;                            /**< Mapping of MIME types to analyzers. */
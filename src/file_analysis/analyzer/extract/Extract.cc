@@ -2,7 +2,6 @@
 
 #include "zeek/file_analysis/analyzer/extract/Extract.h"
 
-#include <fcntl.h>
 #include <string>
 
 #include "zeek/Event.h"
@@ -18,29 +17,10 @@ Extract::Extract(RecordValPtr args, file_analysis::File* file, const std::string
       limit(arg_limit),
       written(0),
       limit_includes_missing(arg_limit_includes_missing) {
-    char buf[128];
-    file_stream = fopen(filename.data(), "wb");
-
-    if ( file_stream ) {
-        // Try to ensure full buffering.
-        if ( util::detail::setvbuf(file_stream, nullptr, _IOFBF, BUFSIZ) ) {
-            util::zeek_strerror_r(errno, buf, sizeof(buf));
-            reporter->Warning("cannot set buffering mode for %s: %s", filename.data(), buf);
-        }
-    }
-    else {
-        util::zeek_strerror_r(errno, buf, sizeof(buf));
-        reporter->Error("cannot open %s: %s", filename.c_str(), buf);
-    }
+    file_stream = ExtractWriter::Instance()->Open(filename);
 }
 
-Extract::~Extract() {
-    if ( file_stream && fclose(file_stream) ) {
-        char buf[128];
-        util::zeek_strerror_r(errno, buf, sizeof(buf));
-        reporter->Error("cannot close %s: %s", filename.data(), buf);
-    }
-}
+Extract::~Extract() { EndOfFile(); }
 
 static ValPtr get_extract_field_val(const RecordValPtr& args, const char* name) {
     const auto& rval = args->GetField(name);
@@ -93,7 +73,9 @@ static bool check_limit_exceeded(uint64_t lim, uint64_t written, uint64_t len, u
 }
 
 bool Extract::DeliverStream(const u_char* data, uint64_t len) {
-    if ( ! file_stream )
+    // Failed writes get noticed with a delay when they happen on the
+    // writer thread.
+    if ( ! file_stream || file_stream->Failed() )
         return false;
 
     uint64_t towrite = 0;
@@ -107,17 +89,10 @@ bool Extract::DeliverStream(const u_char* data, uint64_t len) {
         limit_exceeded = check_limit_exceeded(limit, written, len, &towrite);
     }
 
-    char buf[128];
+    auto* writer = ExtractWriter::Instance();
 
     if ( towrite > 0 ) {
-        if ( fwrite(data, towrite, 1, file_stream) != 1 ) {
-            util::zeek_strerror_r(errno, buf, sizeof(buf));
-            reporter->Error("failed to write to extracted file %s: %s", filename.data(), buf);
-            fclose(file_stream);
-            file_stream = nullptr;
-            return false;
-        }
-
+        writer->Write(file_stream, data, towrite);
         written += towrite;
     }
 
@@ -125,16 +100,26 @@ bool Extract::DeliverStream(const u_char* data, uint64_t len) {
     // the extraction limit and the file analysis File still proceeding to
     // do other analysis without destructing/closing this one until the very end,
     // so flush anything currently buffered.
-    if ( limit_exceeded && fflush(file_stream) ) {
-        util::zeek_strerror_r(errno, buf, sizeof(buf));
-        reporter->Warning("cannot fflush extracted file %s: %s", filename.data(), buf);
-    }
+    if ( limit_exceeded )
+        writer->Flush(file_stream);
+
+    writer->ReportErrors();
 
     return (! limit_exceeded);
 }
 
+bool Extract::EndOfFile() {
+    auto* writer = ExtractWriter::Instance();
+
+    if ( file_stream )
+        writer->Close(std::move(file_stream));
+
+    writer->ReportErrors();
+    return true;
+}
+
 bool Extract::Undelivered(uint64_t offset, uint64_t len) {
-    if ( ! file_stream )
+    if ( ! file_stream || file_stream->Failed() )
         return false;
 
     if ( limit_includes_missing ) {
@@ -157,15 +142,7 @@ bool Extract::Undelivered(uint64_t offset, uint64_t len) {
         written += len;
     }
 
-    if ( fseek(file_stream, len + offset, SEEK_SET) != 0 ) {
-        char buf[128];
-        util::zeek_strerror_r(errno, buf, sizeof(buf));
-        reporter->Error("failed to seek in extracted file %s: %s", filename.data(), buf);
-        fclose(file_stream);
-        file_stream = nullptr;
-        return false;
-    }
-
+    ExtractWriter::Instance()->Seek(file_stream, len + offset);
     return true;
 }
 
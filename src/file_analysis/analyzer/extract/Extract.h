@@ -2,12 +2,13 @@
 
 #pragma once
 
-#include <cstdio>
+#include <memory>
 #include <string>
 
 #include "zeek/Val.h"
 #include "zeek/file_analysis/Analyzer.h"
 #include "zeek/file_analysis/File.h"
+#include "zeek/file_analysis/analyzer/extract/ExtractWriter.h"
 #include "zeek/file_analysis/analyzer/extract/events.bif.h"
 
 namespace zeek::file_analysis::detail {
@@ -31,6 +32,13 @@ public:
      */
     bool DeliverStream(const u_char* data, uint64_t len) override;
 
+    /**
+     * Closes the extraction file, so that it's complete by the time
+     * file_state_remove gets raised.
+     * @return true
+     */
+    bool EndOfFile() override;
+
     /**
      * Report undelivered bytes.
      * @param offset distance into the file where the gap occurred.
@@ -70,7 +78,7 @@ protected:
 
 private:
     std::string filename;
-    FILE* file_stream;
+    std::shared_ptr<ExtractFile> file_stream; // Written by the ExtractWriter.
     uint64_t limit;              // the file extraction limit
     uint64_t written;            // how many bytes we have written so far
     bool limit_includes_missing; // do count missing bytes against limit if true
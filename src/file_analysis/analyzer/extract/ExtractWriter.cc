@@ -0,0 +1,450 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/file_analysis/analyzer/extract/ExtractWriter.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "zeek/Reporter.h"
+#include "zeek/digest.h"
+#include "zeek/file_analysis/analyzer/extract/consts.bif.h"
+#include "zeek/telemetry/Manager.h"
+#include "zeek/util.h"
+
+namespace zeek::file_analysis::detail {
+
+namespace {
+
+// With a content store, files up to this size stay in memory until they
+// close, so that duplicates never touch the disk.
+constexpr uint64_t max_buffered_bytes = 1024 * 1024;
+
+ExtractWriter* writer = nullptr;
+
+} // namespace
+
+ExtractFile::ExtractFile(std::string arg_filename, std::string arg_store)
+    : filename(std::move(arg_filename)), store(std::move(arg_store)) {}
+
+ExtractFile::~ExtractFile() {
+    if ( stream )
+        fclose(stream);
+
+    if ( ! temp_filename.empty() )
+        unlink(temp_filename.c_str());
+}
+
+bool ExtractFile::Fail(const char* what, bool warning) {
+    char buf[128];
+    util::zeek_strerror_r(errno, buf, sizeof(buf));
+    error = std::string(what) + " " + filename + ": " + buf;
+    error_is_warning = warning;
+
+    if ( ! warning ) {
+        failed.store(true, std::memory_order_relaxed);
+
+        if ( stream ) {
+            fclose(stream);
+            stream = nullptr;
+        }
+    }
+
+    return false;
+}
+
+bool ExtractFile::Open() {
+    // With a content store, the file only gets created when it closes.
+    if ( ! store.empty() )
+        return true;
+
+    stream = fopen(filename.data(), "wb");
+
+    if ( ! stream )
+        return Fail("cannot open");
+
+    // Try to ensure full buffering.
+    if ( util::detail::setvbuf(stream, nullptr, _IOFBF, BUFSIZ) )
+        Fail("cannot set buffering mode for", true);
+
+    return true;
+}
+
+bool ExtractFile::Spill() {
+    temp_filename = store + "/.tmp-XXXXXX";
+    int fd = mkstemp(temp_filename.data());
+
+    if ( fd < 0 ) {
+        temp_filename.clear();
+        return Fail("failed to buffer extracted file");
+    }
+
+    // mkstemp() restricts access to the owner. Use the permissions that
+    // fopen() gives with the common umask instead.
+    fchmod(fd, 0644);
+
+    stream = fdopen(fd, "w+b");
+
+    if ( ! stream ) {
+        close(fd);
+        return Fail("failed to buffer extracted file");
+    }
+
+    if ( (! buffer.empty() && fwrite(buffer.data(), buffer.size(), 1, stream) != 1) ||
+         fseek(stream, pos, SEEK_SET) != 0 )
+        return Fail("failed to write to extracted file");
+
+    buffer.clear();
+    buffer.shrink_to_fit();
+    return true;
+}
+
+bool ExtractFile::Write(const u_char* data, uint64_t len) {
+    if ( Failed() )
+        return true;
+
+    if ( ! store.empty() && ! stream ) {
+        if ( pos + len > max_buffered_bytes ) {
+            if ( ! Spill() )
+                return false;
+        }
+        else {
+            if ( pos + len > buffer.size() )
+                buffer.resize(pos + len);
+
+            memcpy(buffer.data() + pos, data, len);
+            pos += len;
+            return true;
+        }
+    }
+
+    if ( fwrite(data, len, 1, stream) != 1 )
+        return Fail("failed to write to extracted file");
+
+    pos += len;
+    return true;
+}
+
+bool ExtractFile::Seek(uint64_t offset) {
+    if ( Failed() )
+        return true;
+
+    pos = offset;
+
+    // A buffered file's holes get filled in by the next write.
+    if ( stream && fseek(stream, offset, SEEK_SET) != 0 )
+        return Fail("failed to seek in extracted file");
+
+    return true;
+}
+
+bool ExtractFile::Flush() {
+    if ( Failed() || ! stream )
+        return true;
+
+    if ( fflush(stream) )
+        return Fail("cannot fflush extracted file", true);
+
+    return true;
+}
+
+bool ExtractFile::Close(bool* duplicate) {
+    *duplicate = false;
+
+    if ( Failed() )
+        return true;
+
+    if ( ! store.empty() )
+        return Store(duplicate);
+
+    auto* s = stream;
+    stream = nullptr;
+
+    if ( s && fclose(s) )
+        return Fail("cannot close");
+
+    return true;
+}
+
+bool ExtractFile::Store(bool* duplicate) {
+    u_char digest[ZEEK_SHA256_DIGEST_LENGTH];
+    auto* state = zeek::detail::hash_init(zeek::detail::Hash_SHA256);
+
+    if ( stream ) {
+        u_char chunk[64 * 1024];
+        size_t n;
+
+        if ( fflush(stream) || fseek(stream, 0, SEEK_SET) != 0 ) {
+            zeek::detail::hash_state_free(state);
+            return Fail("cannot read back extracted file");
+        }
+
+        while ( (n = fread(chunk, 1, sizeof(chunk), stream)) > 0 )
+            zeek::detail::hash_update(state, chunk, n);
+
+        if ( ferror(stream) ) {
+            zeek::detail::hash_state_free(state);
+            return Fail("cannot read back extracted file");
+        }
+    }
+    else
+        zeek::detail::hash_update(state, buffer.data(), buffer.size());
+
+    zeek::detail::hash_final(state, digest);
+
+    char hex[ZEEK_SHA256_DIGEST_LENGTH * 2 + 1];
+
+    for ( size_t i = 0; i < sizeof(digest); ++i )
+        util::bytetohex(digest[i], &hex[i * 2]);
+
+    hex[sizeof(hex) - 1] = '\0';
+
+    auto target = store + "/" + hex;
+
+    if ( access(target.c_str(), F_OK) == 0 )
+        *duplicate = true;
+
+    else {
+        if ( ! stream && ! Spill() )
+            return false;
+
+        auto* s = stream;
+        stream = nullptr;
+
+        if ( fclose(s) )
+            return Fail("cannot close");
+
+        if ( rename(temp_filename.c_str(), target.c_str()) != 0 )
+            return Fail("failed to store extracted file");
+
+        temp_filename.clear();
+    }
+
+    if ( (unlink(filename.c_str()) != 0 && errno != ENOENT) || link(target.c_str(), filename.c_str()) != 0 )
+        return Fail("failed to link extracted file");
+
+    return true;
+}
+
+ExtractWriter* ExtractWriter::Instance() {
+    if ( ! writer )
+        writer = new ExtractWriter();
+
+    return writer;
+}
+
+void ExtractWriter::Shutdown() {
+    if ( writer )
+        writer->Stop();
+}
+
+ExtractWriter::ExtractWriter()
+    : store(BifConst::FileExtract::content_store->CheckString()),
+      synchronous(BifConst::FileExtract::writer_queue_size == 0),
+      drop_when_full(BifConst::FileExtract::drop_when_full),
+      max_queued_bytes(BifConst::FileExtract::writer_queue_size) {
+    if ( ! store.empty() && ! util::detail::ensure_intermediate_dirs(store.c_str()) ) {
+        reporter->Error("cannot use content store %s, extracting without it", store.c_str());
+        store.clear();
+    }
+
+    queued_metric = telemetry_mgr->GaugeInstance("zeek", "extract-queued", {},
+                                                 "File data waiting for the extraction writer", "bytes",
+                                                 [this]() { return static_cast<double>(stat_queued_bytes.load()); });
+    written_metric =
+        telemetry_mgr->CounterInstance("zeek", "extract-written", {}, "File data written by extraction", "bytes",
+                                       [this]() { return static_cast<double>(stat_written_bytes.load()); });
+    dropped_metric =
+        telemetry_mgr->CounterInstance("zeek", "extract-dropped", {}, "File data dropped due to a full writer queue",
+                                       "bytes", [this]() { return static_cast<double>(stat_dropped_bytes.load()); });
+    blocked_metric =
+        telemetry_mgr->CounterInstance("zeek", "extract-blocked-time", {},
+                                       "Time spent waiting for room in the extraction writer queue", "seconds",
+                                       [this]() { return stat_blocked_time.load(); });
+    deduplicated_metric =
+        telemetry_mgr->CounterInstance("zeek", "extract-deduplicated-files", {},
+                                       "Extracted files whose content was in the content store already", "",
+                                       [this]() { return static_cast<double>(stat_deduplicated.load()); });
+
+    if ( ! synchronous )
+        thread = std::thread(&ExtractWriter::Run, this);
+}
+
+std::shared_ptr<ExtractFile> ExtractWriter::Open(const std::string& filename) {
+    auto file = std::make_shared<ExtractFile>(filename, store);
+    bool ok = file->Open();
+
+    if ( ! file->Error().empty() ) {
+        if ( file->ErrorIsWarning() )
+            reporter->Warning("%s", file->Error().c_str());
+        else
+            reporter->Error("%s", file->Error().c_str());
+    }
+
+    return ok ? file : nullptr;
+}
+
+void ExtractWriter::Write(const std::shared_ptr<ExtractFile>& file, const u_char* data, uint64_t len) {
+    if ( synchronous ) {
+        Execute(WRITE, file.get(), data, len);
+        ReportErrors();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(mtx);
+
+    if ( queued_bytes > 0 && queued_bytes + len > max_queued_bytes ) {
+        if ( drop_when_full ) {
+            stat_dropped_bytes += len;
+            jobs.push_back({SKIP, file, {}, len});
+            lk.unlock();
+            cv.notify_one();
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        space.wait(lk, [this, len]() { return queued_bytes == 0 || queued_bytes + len <= max_queued_bytes; });
+
+        using Sec = std::chrono::duration<double>;
+        auto blocked = std::chrono::duration_cast<Sec>(std::chrono::steady_clock::now() - start).count();
+        stat_blocked_time.store(stat_blocked_time.load() + blocked);
+    }
+
+    jobs.push_back({WRITE, file, std::vector<u_char>(data, data + len)});
+    queued_bytes += len;
+    stat_queued_bytes = queued_bytes;
+    lk.unlock();
+    cv.notify_one();
+}
+
+void ExtractWriter::Seek(const std::shared_ptr<ExtractFile>& file, uint64_t offset) {
+    Submit({SEEK, file, {}, offset});
+}
+
+void ExtractWriter::Flush(const std::shared_ptr<ExtractFile>& file) { Submit({FLUSH, file}); }
+
+void ExtractWriter::Close(std::shared_ptr<ExtractFile> file) {
+    if ( synchronous ) {
+        Submit({CLOSE, std::move(file)});
+        return;
+    }
+
+    // The writer works through the queue in order, so the file's data is
+    // on disk once its close is done.
+    std::unique_lock<std::mutex> lk(mtx);
+    closing.insert(file.get());
+    jobs.push_back({CLOSE, file});
+    cv.notify_one();
+    closed.wait(lk, [this, &file]() { return closing.count(file.get()) == 0; });
+}
+
+void ExtractWriter::Submit(Job job) {
+    if ( synchronous ) {
+        Execute(job.op, job.file.get(), nullptr, job.offset);
+        ReportErrors();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        jobs.push_back(std::move(job));
+    }
+
+    cv.notify_one();
+}
+
+void ExtractWriter::Execute(Op op, ExtractFile* file, const u_char* data, uint64_t n) {
+    bool ok = true;
+    bool duplicate = false;
+
+    switch ( op ) {
+        case WRITE:
+            ok = file->Write(data, n);
+            if ( ok )
+                stat_written_bytes += n;
+            break;
+
+        case SEEK: ok = file->Seek(n); break;
+        case SKIP: ok = file->Skip(n); break;
+        case FLUSH: ok = file->Flush(); break;
+
+        case CLOSE:
+            ok = file->Close(&duplicate);
+            if ( duplicate )
+                ++stat_deduplicated;
+            break;
+    }
+
+    if ( ! ok ) {
+        std::lock_guard<std::mutex> lk(errors_mtx);
+        errors.emplace_back(file->ErrorIsWarning(), file->Error());
+        has_errors.store(true, std::memory_order_relaxed);
+    }
+}
+
+void ExtractWriter::Run() {
+    util::detail::set_thread_name("zk.extract");
+
+    std::unique_lock<std::mutex> lk(mtx);
+
+    while ( true ) {
+        cv.wait(lk, [this]() { return stopping || ! jobs.empty(); });
+
+        if ( jobs.empty() )
+            return;
+
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        lk.unlock();
+
+        Execute(job.op, job.file.get(), job.data.data(), job.op == WRITE ? job.data.size() : job.offset);
+        auto size = job.data.size();
+        auto* closed_file = job.op == CLOSE ? job.file.get() : nullptr;
+        job = {};
+
+        lk.lock();
+        queued_bytes -= size;
+        stat_queued_bytes = queued_bytes;
+        space.notify_one();
+
+        if ( closed_file && closing.erase(closed_file) )
+            closed.notify_all();
+    }
+}
+
+void ExtractWriter::DoReportErrors() {
+    std::vector<std::pair<bool, std::string>> pending;
+
+    {
+        std::lock_guard<std::mutex> lk(errors_mtx);
+        pending.swap(errors);
+        has_errors.store(false, std::memory_order_relaxed);
+    }
+
+    for ( const auto& [warning, msg] : pending ) {
+        if ( warning )
+            reporter->Warning("%s", msg.c_str());
+        else
+            reporter->Error("%s", msg.c_str());
+    }
+}
+
+void ExtractWriter::Stop() {
+    if ( ! synchronous ) {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+        }
+
+        cv.notify_one();
+        thread.join();
+        synchronous = true;
+    }
+
+    DoReportErrors();
+}
+
+} // namespace zeek::file_analysis::detail
@@ -0,0 +1,191 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <sys/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace zeek::telemetry {
+class Counter;
+class Gauge;
+} // namespace zeek::telemetry
+
+namespace zeek::file_analysis::detail {
+
+/**
+ * The on-disk side of a single extracted file.
+ *
+ * With a content store, the data stays in memory or a temporary file until
+ * the file closes. It then moves into the store under its SHA256 digest,
+ * unless the store has that content already, and the extraction filename
+ * becomes a hard link to it.
+ *
+ * Apart from Failed(), the methods run only on the writer thread, or on the
+ * main thread if writes are synchronous.
+ */
+class ExtractFile {
+public:
+    /**
+     * Constructor.
+     * @param filename the path to extract to.
+     * @param store the content store directory, or empty for none.
+     */
+    ExtractFile(std::string filename, std::string store);
+
+    ~ExtractFile();
+
+    const std::string& Filename() const { return filename; }
+
+    /**
+     * Returns true once an operation on the file failed. Later operations
+     * are ignored.
+     */
+    bool Failed() const { return failed.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the message of the failed operation, if any, and whether it's
+     * only a warning.
+     */
+    const std::string& Error() const { return error; }
+    bool ErrorIsWarning() const { return error_is_warning; }
+
+    // The operations. Each returns false on failure, with Error() set.
+    bool Open();
+    bool Write(const u_char* data, uint64_t len);
+    bool Seek(uint64_t offset);
+    bool Skip(uint64_t len) { return Seek(pos + len); }
+    bool Flush();
+
+    /**
+     * Closes the file.
+     * @param duplicate set to true if the content store had the content
+     *        already.
+     */
+    bool Close(bool* duplicate);
+
+private:
+    bool Spill();
+    bool Store(bool* duplicate);
+    bool Fail(const char* what, bool warning = false);
+
+    std::string filename;
+    std::string store;
+    FILE* stream = nullptr;
+    std::string temp_filename; // Content store only, once spilled.
+    std::vector<u_char> buffer; // Content store only, until spilled.
+    uint64_t pos = 0;
+
+    std::atomic<bool> failed = false;
+    std::string error;
+    bool error_is_warning = false;
+};
+
+/**
+ * Performs the I/O of all extraction analyzers on a background thread, so
+ * that a slow disk doesn't stall packet processing. The queue is bounded
+ * by FileExtract::writer_queue_size. Once full, the main thread either
+ * waits or, with FileExtract::drop_when_full, skips the data, which leaves
+ * a hole in the extracted file.
+ *
+ * All methods are for the main thread. Messages about failed operations get
+ * reported on a later call.
+ */
+class ExtractWriter {
+public:
+    /**
+     * Returns the writer, starting it on first use.
+     */
+    static ExtractWriter* Instance();
+
+    /**
+     * Completes all queued operations and stops the thread. Later operations
+     * run synchronously.
+     */
+    static void Shutdown();
+
+    /**
+     * Opens a file for extraction.
+     * @return the file, or null if it cannot be opened.
+     */
+    std::shared_ptr<ExtractFile> Open(const std::string& filename);
+
+    void Write(const std::shared_ptr<ExtractFile>& file, const u_char* data, uint64_t len);
+    void Seek(const std::shared_ptr<ExtractFile>& file, uint64_t offset);
+    void Flush(const std::shared_ptr<ExtractFile>& file);
+
+    /**
+     * Closes a file, after completing its queued operations. Waits for the
+     * writer, so that the file is complete on disk once this returns.
+     */
+    void Close(std::shared_ptr<ExtractFile> file);
+
+    /**
+     * Reports the messages of operations that failed since the last call.
+     */
+    void ReportErrors() {
+        if ( has_errors.load(std::memory_order_relaxed) )
+            DoReportErrors();
+    }
+
+private:
+    enum Op { WRITE, SEEK, SKIP, FLUSH, CLOSE };
+
+    struct Job {
+        Op op;
+        std::shared_ptr<ExtractFile> file;
+        std::vector<u_char> data;
+        uint64_t offset = 0;
+    };
+
+    ExtractWriter();
+
+    void Submit(Job job);
+    void Execute(Op op, ExtractFile* file, const u_char* data, uint64_t n);
+    void Run();
+    void DoReportErrors();
+    void Stop();
+
+    std::string store;
+    bool synchronous;
+    bool drop_when_full;
+    uint64_t max_queued_bytes;
+
+    std::mutex mtx;
+    std::condition_variable cv;     // Signals new jobs.
+    std::condition_variable space;  // Signals room in the queue.
+    std::condition_variable closed; // Signals completed closes.
+    std::deque<Job> jobs;
+    std::unordered_set<const ExtractFile*> closing; // Files waited on in Close().
+    uint64_t queued_bytes = 0;
+    bool stopping = false;
+    std::thread thread;
+
+    std::mutex errors_mtx;
+    std::vector<std::pair<bool, std::string>> errors; // Warning flag and message.
+    std::atomic<bool> has_errors = false;
+
+    // Statistics for telemetry.
+    std::atomic<uint64_t> stat_queued_bytes = 0;
+    std::atomic<uint64_t> stat_written_bytes = 0;
+    std::atomic<uint64_t> stat_dropped_bytes = 0;
+    std::atomic<uint64_t> stat_deduplicated = 0;
+    std::atomic<double> stat_blocked_time = 0.0;
+
+    std::shared_ptr<telemetry::Gauge> queued_metric;
+    std::shared_ptr<telemetry::Counter> written_metric;
+    std::shared_ptr<telemetry::Counter> dropped_metric;
+    std::shared_ptr<telemetry::Counter> blocked_metric;
+    std::shared_ptr<telemetry::Counter> deduplicated_metric;
+};
+
+} // namespace zeek::file_analysis::detail
@@ -0,0 +1,224 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/file_analysis/analyzer/hash/DigestSet.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "zeek/OpaqueVal.h"
+#include "zeek/file_analysis/analyzer/hash/consts.bif.h"
+#include "zeek/util.h"
+
+namespace zeek::file_analysis::detail {
+
+namespace {
+
+// Data gets fed to all digests in blocks of this size, so that each block
+// stays in cache while passing through them.
+constexpr uint64_t block_size = 16 * 1024;
+
+// Upper bound for the data queued to a single worker thread. The main
+// thread blocks once a worker falls this far behind.
+constexpr size_t max_queued_bytes = 8 * 1024 * 1024;
+
+} // namespace
+
+/**
+ * Threads hashing the chunks of file data handed to them by DigestSet::Feed().
+ */
+class HashWorkers {
+public:
+    /**
+     * Returns the pool, starting it on first use, or nullptr if
+     * FileHash::worker_threads is zero.
+     */
+    static HashWorkers* Instance() {
+        static std::unique_ptr<HashWorkers> instance =
+            BifConst::FileHash::worker_threads > 0 ?
+                std::make_unique<HashWorkers>(BifConst::FileHash::worker_threads) :
+                nullptr;
+        return instance.get();
+    }
+
+    explicit HashWorkers(size_t num_threads) {
+        for ( size_t i = 0; i < num_threads; ++i ) {
+            auto w = std::make_unique<Worker>();
+            w->thread = std::thread(&HashWorkers::Run, w.get(), i);
+            workers.push_back(std::move(w));
+        }
+    }
+
+    ~HashWorkers() {
+        for ( auto& w : workers ) {
+            {
+                std::lock_guard<std::mutex> lk(w->mtx);
+                w->stopping = true;
+            }
+
+            w->cv.notify_one();
+            w->thread.join();
+        }
+    }
+
+    size_t Assign() { return next++ % workers.size(); }
+
+    void Enqueue(size_t worker, DigestSet* set, const u_char* data, uint64_t len) {
+        auto& w = *workers[worker];
+        std::unique_lock<std::mutex> lk(w.mtx);
+        w.space.wait(lk, [&w]() { return w.queued_bytes < max_queued_bytes; });
+        w.jobs.push_back({set, std::vector<u_char>(data, data + len)});
+        w.queued_bytes += len;
+        lk.unlock();
+        w.cv.notify_one();
+    }
+
+private:
+    struct Job {
+        DigestSet* set;
+        std::vector<u_char> data;
+    };
+
+    struct Worker {
+        std::mutex mtx;
+        std::condition_variable cv;    // Signals new jobs.
+        std::condition_variable space; // Signals room in the queue.
+        std::deque<Job> jobs;
+        size_t queued_bytes = 0;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    static void Run(Worker* w, size_t idx) {
+        std::string name = "zk.hash-" + std::to_string(idx);
+        util::detail::set_thread_name(name.c_str());
+
+        std::unique_lock<std::mutex> lk(w->mtx);
+
+        while ( true ) {
+            w->cv.wait(lk, [w]() { return w->stopping || ! w->jobs.empty(); });
+
+            if ( w->jobs.empty() )
+                return;
+
+            auto job = std::move(w->jobs.front());
+            w->jobs.pop_front();
+            w->queued_bytes -= job.data.size();
+            lk.unlock();
+            w->space.notify_one();
+
+            job.set->HashChunk(job.data.data(), job.data.size());
+            job.set->Done();
+
+            lk.lock();
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    size_t next = 0;
+};
+
+std::shared_ptr<DigestSet> DigestSet::Get(const File* file) {
+    // Main thread only, like all of file analysis. Never destroyed, so that
+    // sets outliving static destruction can still remove themselves.
+    static auto* sets = new std::unordered_map<const File*, std::weak_ptr<DigestSet>>();
+
+    if ( auto it = sets->find(file); it != sets->end() ) {
+        if ( auto set = it->second.lock() )
+            return set;
+    }
+
+    auto set = std::shared_ptr<DigestSet>(new DigestSet(file), [](DigestSet* s) {
+        sets->erase(s->file);
+        delete s;
+    });
+
+    if ( auto* workers = HashWorkers::Instance() )
+        set->worker = workers->Assign();
+
+    (*sets)[file] = set;
+    return set;
+}
+
+DigestSet::~DigestSet() { Sync(); }
+
+size_t DigestSet::Add(HashVal* hv) {
+    Sync();
+    digests.push_back({hv, fed == 0, 0});
+    return digests.size() - 1;
+}
+
+void DigestSet::Remove(size_t handle) {
+    Sync();
+    digests[handle].hv = nullptr;
+}
+
+bool DigestSet::CatchUp(size_t handle, const u_char* data, uint64_t len) {
+    auto& d = digests[handle];
+
+    if ( d.joined )
+        return false;
+
+    // Only this digest's analyzer touches it until it joins, so there's no
+    // need to wait for the workers here.
+    d.hv->Feed(data, len);
+    d.seen += len;
+
+    if ( d.seen == fed ) {
+        Sync();
+        d.joined = true;
+    }
+
+    return true;
+}
+
+bool DigestSet::IsFeeder(size_t handle) const {
+    auto it = std::find_if(digests.begin(), digests.end(),
+                           [](const Digest& d) { return d.hv && d.joined && d.hv->IsValid(); });
+    return it != digests.end() && static_cast<size_t>(it - digests.begin()) == handle;
+}
+
+void DigestSet::Feed(const u_char* data, uint64_t len) {
+    auto* workers = HashWorkers::Instance();
+
+    fed += len;
+
+    if ( ! workers ) {
+        HashChunk(data, len);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        ++pending;
+    }
+
+    workers->Enqueue(worker, this, data, len);
+}
+
+void DigestSet::Sync() {
+    std::unique_lock<std::mutex> lk(mtx);
+    cv.wait(lk, [this]() { return pending == 0; });
+}
+
+void DigestSet::HashChunk(const u_char* data, uint64_t len) {
+    for ( uint64_t offset = 0; offset < len; offset += block_size ) {
+        auto n = std::min(block_size, len - offset);
+
+        for ( const auto& d : digests ) {
+            if ( d.hv && d.joined && d.hv->IsValid() )
+                d.hv->Feed(data + offset, n);
+        }
+    }
+}
+
+void DigestSet::Done() {
+    std::lock_guard<std::mutex> lk(mtx);
+
+    if ( --pending == 0 )
+        cv.notify_all();
+}
+
+} // namespace zeek::file_analysis::detail
@@ -0,0 +1,111 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <sys/types.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace zeek {
+
+class HashVal;
+
+namespace file_analysis {
+class File;
+}
+
+namespace file_analysis::detail {
+
+/**
+ * The digests that the hash analyzers attached to a single file compute.
+ *
+ * Instead of each analyzer passing over every chunk of file data by itself,
+ * the first analyzer in the set feeds each chunk to all digests, in blocks
+ * small enough to stay in cache. If FileHash::worker_threads is non-zero,
+ * that work moves to a pool of threads. All chunks of a file go to the same
+ * thread and get hashed in order. Before an analyzer reads its digest or
+ * the set changes, the main thread waits for the file's pending chunks.
+ *
+ * A digest added after the set has been fed is first caught up through its
+ * own analyzer, which the file replays its buffered data to. It joins the
+ * others once it has seen as much data as they have.
+ */
+class DigestSet {
+public:
+    /**
+     * Returns the set for the given file, creating it if necessary.
+     */
+    static std::shared_ptr<DigestSet> Get(const File* file);
+
+    ~DigestSet();
+
+    /**
+     * Adds an initialized digest to the set.
+     *
+     * @return A handle for the other methods.
+     */
+    size_t Add(HashVal* hv);
+
+    /**
+     * Removes a digest from the set, after waiting for pending chunks.
+     */
+    void Remove(size_t handle);
+
+    /**
+     * Feeds a chunk of file data to a digest that was added late and has
+     * not yet caught up with the others.
+     *
+     * @return false if the digest is already caught up, in which case it
+     * gets the data along with the others.
+     */
+    bool CatchUp(size_t handle, const u_char* data, uint64_t len);
+
+    /**
+     * Returns true if the digest is the one whose analyzer feeds the set:
+     * the first one that is still valid and caught up.
+     */
+    bool IsFeeder(size_t handle) const;
+
+    /**
+     * Feeds a chunk of file data to all digests in the set.
+     */
+    void Feed(const u_char* data, uint64_t len);
+
+    /**
+     * Waits until all chunks fed so far have been hashed.
+     */
+    void Sync();
+
+private:
+    friend class HashWorkers;
+
+    explicit DigestSet(const File* file) : file(file) {}
+
+    // Feeds a chunk to all digests. Runs on a worker thread if there are
+    // any, otherwise on the main thread.
+    void HashChunk(const u_char* data, uint64_t len);
+
+    // Called by a worker thread after hashing a chunk.
+    void Done();
+
+    struct Digest {
+        HashVal* hv;   // Null once removed.
+        bool joined;   // Gets fed along with the others.
+        uint64_t seen; // Bytes fed to it directly while catching up.
+    };
+
+    const File* file;
+    std::vector<Digest> digests;
+    uint64_t fed = 0; // Bytes fed to the joined digests.
+    size_t worker = 0;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t pending = 0; // Chunks queued to a worker, protected by mtx.
+};
+
+} // namespace file_analysis::detail
+} // namespace zeek
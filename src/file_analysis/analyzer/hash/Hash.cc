@@ -21,9 +21,14 @@ Hash::Hash(RecordValPtr args, file_analysis::File* file, HashVal* hv, StringValP
       fed(false),
       kind(std::move(arg_kind)) {
     hash->Init();
+    digests = DigestSet::Get(file);
+    digest_handle = digests->Add(hash);
 }
 
-Hash::~Hash() { Unref(hash); }
+Hash::~Hash() {
+    digests->Remove(digest_handle);
+    Unref(hash);
+}
 
 bool Hash::DeliverStream(const u_char* data, uint64_t len) {
     if ( ! hash->IsValid() )
@@ -32,7 +37,15 @@ bool Hash::DeliverStream(const u_char* data, uint64_t len) {
     if ( ! fed )
         fed = len > 0;
 
-    hash->Feed(data, len);
+    // A digest added after the others were fed gets the data replayed to
+    // its analyzer first. Once caught up, one of the file's hash analyzers
+    // feeds the data to all of them.
+    if ( digests->CatchUp(digest_handle, data, len) )
+        return true;
+
+    if ( digests->IsFeeder(digest_handle) )
+        digests->Feed(data, len);
+
     return true;
 }
 
@@ -44,6 +57,8 @@ bool Hash::EndOfFile() {
 bool Hash::Undelivered(uint64_t offset, uint64_t len) { return false; }
 
 void Hash::Finalize() {
+    digests->Sync();
+
     if ( ! hash->IsValid() || ! fed )
         return;
 
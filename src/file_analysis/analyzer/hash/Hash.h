@@ -2,18 +2,22 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "zeek/OpaqueVal.h"
 #include "zeek/Val.h"
 #include "zeek/file_analysis/Analyzer.h"
 #include "zeek/file_analysis/File.h"
+#include "zeek/file_analysis/analyzer/hash/DigestSet.h"
 #include "zeek/file_analysis/analyzer/hash/events.bif.h"
 
 namespace zeek::file_analysis::detail {
 
 /**
- * An analyzer to produce a hash of file contents.
+ * An analyzer to produce a hash of file contents. All hash analyzers
+ * attached to a file share a DigestSet, which passes over the file's data
+ * only once.
  */
 class Hash : public file_analysis::Analyzer {
 public:
@@ -65,6 +69,8 @@ private:
     HashVal* hash;
     bool fed;
     StringValPtr kind;
+    std::shared_ptr<DigestSet> digests;
+    size_t digest_handle;
 };
 
 /**
@@ -0,0 +1,63 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/file_analysis/analyzer/x509/CertificateCache.h"
+
+#include "zeek/telemetry/Manager.h"
+
+namespace zeek::file_analysis::detail {
+
+CertificateCache::CertificateCache(size_t arg_capacity) : capacity(arg_capacity) {
+    index.reserve(capacity);
+
+    auto lookups_family = telemetry_mgr->CounterFamily("zeek", "x509-certificate-cache-lookups", {"result"},
+                                                       "Lookups in the X509 analyzer's certificate cache");
+    hits_metric = lookups_family->GetOrAdd({{"result", "hit"}}, [this]() { return static_cast<double>(hits); });
+    misses_metric = lookups_family->GetOrAdd({{"result", "miss"}}, [this]() { return static_cast<double>(misses); });
+
+    evictions_metric = telemetry_mgr->CounterInstance("zeek", "x509-certificate-cache-evictions", {},
+                                                      "Certificates evicted from the X509 analyzer's cache", "",
+                                                      [this]() { return static_cast<double>(evictions); });
+    entries_metric = telemetry_mgr->GaugeInstance("zeek", "x509-certificate-cache-entries", {},
+                                                  "Certificates in the X509 analyzer's cache", "",
+                                                  [this]() { return static_cast<double>(index.size()); });
+}
+
+const CertificateEvents* CertificateCache::Lookup(const std::string& sha256) {
+    auto it = index.find(sha256);
+
+    if ( it == index.end() ) {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->second;
+}
+
+void CertificateCache::Insert(const std::string& sha256, CertificateEvents events) {
+    if ( capacity == 0 || index.find(sha256) != index.end() )
+        return;
+
+    if ( index.size() >= capacity ) {
+        // Reuse the least recently used entry's list node.
+        auto last = std::prev(entries.end());
+        index.erase(last->first);
+        entries.splice(entries.begin(), entries, last);
+        ++evictions;
+    }
+    else
+        entries.emplace_front();
+
+    auto& entry = entries.front();
+    entry.first = sha256;
+    entry.second = std::move(events);
+    index.emplace(sha256, entries.begin());
+}
+
+void CertificateCache::Clear() {
+    index.clear();
+    entries.clear();
+}
+
+} // namespace zeek::file_analysis::detail
@@ -0,0 +1,83 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "zeek/EventHandler.h"
+#include "zeek/ZeekArgs.h"
+
+namespace zeek::telemetry {
+class Counter;
+class Gauge;
+} // namespace zeek::telemetry
+
+namespace zeek::file_analysis::detail {
+
+/**
+ * The events that the X509 analyzer raised for a certificate, in order,
+ * without their leading fa_file argument.
+ */
+struct CertificateEvents {
+    std::vector<std::pair<EventHandlerPtr, Args>> events;
+};
+
+/**
+ * A least-recently-used cache of the events for certificates, keyed by the
+ * SHA256 digest of their DER encoding. Once the cache reaches its capacity,
+ * each insertion evicts the entry that was used the longest time ago.
+ */
+class CertificateCache {
+public:
+    /**
+     * Constructor.
+     * @param capacity the maximum number of entries.
+     */
+    explicit CertificateCache(size_t capacity);
+
+    /**
+     * Looks up a certificate and marks it as most recently used.
+     * @param sha256 the raw digest.
+     * @return the events for the certificate, or null if not cached.
+     */
+    const CertificateEvents* Lookup(const std::string& sha256);
+
+    /**
+     * Adds a certificate, evicting the least recently used one if the cache
+     * is full.
+     * @param sha256 the raw digest.
+     * @param events the events the certificate's analysis raised.
+     */
+    void Insert(const std::string& sha256, CertificateEvents events);
+
+    /**
+     * Removes all entries.
+     */
+    void Clear();
+
+    size_t Size() const { return index.size(); }
+
+private:
+    using Entry = std::pair<std::string, CertificateEvents>;
+
+    size_t capacity;
+    std::list<Entry> entries; // Most recently used first.
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    std::shared_ptr<telemetry::Counter> hits_metric;
+    std::shared_ptr<telemetry::Counter> misses_metric;
+    std::shared_ptr<telemetry::Counter> evictions_metric;
+    std::shared_ptr<telemetry::Gauge> entries_metric;
+};
+
+} // namespace zeek::file_analysis::detail
@@ -26,6 +26,7 @@ public:
     void Done() override {
         zeek::plugin::Plugin::Done();
         zeek::file_analysis::detail::X509::FreeRootStore();
+        zeek::file_analysis::detail::X509::FreeNativeCertificateCache();
     }
 } plugin;
 
@@ -20,6 +20,8 @@
 #include "zeek/digest.h"
 #include "zeek/file_analysis/File.h"
 #include "zeek/file_analysis/Manager.h"
+#include "zeek/file_analysis/analyzer/x509/CertificateCache.h"
+#include "zeek/file_analysis/analyzer/x509/consts.bif.h"
 #include "zeek/file_analysis/analyzer/x509/events.bif.h"
 #include "zeek/file_analysis/analyzer/x509/types.bif.h"
 
@@ -40,12 +42,17 @@ bool X509::Undelivered(uint64_t offset, uint64_t len) { return false; }
 
 bool X509::EndOfFile() {
     const unsigned char* cert_char = reinterpret_cast<const unsigned char*>(cert_data.data());
-    if ( certificate_cache ) {
-        // first step - let's see if the certificate has been cached.
-        unsigned char buf[SHA256_DIGEST_LENGTH];
+    unsigned char buf[SHA256_DIGEST_LENGTH];
+    auto* native_cache = NativeCertificateCache();
+
+    if ( certificate_cache || native_cache ) {
         auto ctx = zeek::detail::hash_init(zeek::detail::Hash_SHA256);
         zeek::detail::hash_update(ctx, cert_char, cert_data.size());
         zeek::detail::hash_final(ctx, buf);
+    }
+
+    if ( certificate_cache ) {
+        // first step - let's see if the certificate has been cached.
         std::string cert_sha256 = zeek::detail::sha256_digest_print(buf);
         auto index = make_intrusive<StringVal>(cert_sha256);
         const auto& entry = certificate_cache->Find(index);
@@ -63,12 +70,52 @@ bool X509::EndOfFile() {
         }
     }
 
+    if ( ! native_cache ) {
+        ParseCertificateData();
+        return false;
+    }
+
+    std::string key(reinterpret_cast<const char*>(buf), sizeof(buf));
+
+    if ( const auto* cached = native_cache->Lookup(key) ) {
+        // Replay what parsing the certificate raised before. Handlers may
+        // modify the records they get, so each replay gets its own copies.
+        for ( const auto& [h, args] : cached->events ) {
+            Args copies;
+            copies.reserve(args.size());
+
+            for ( const auto& a : args )
+                copies.emplace_back(a->GetType()->Tag() == TYPE_OPAQUE ? a : a->Clone());
+
+            RaiseFileEvent(h, std::move(copies));
+        }
+
+        return false;
+    }
+
+    // Record the events for the cache. Certificates whose parsing raises
+    // weirds are left out, since replaying wouldn't raise the weirds.
+    CertificateEvents events;
+    auto weirds = reporter->GetWeirdCount();
+    recording = &events;
+    ParseCertificateData();
+    recording = nullptr;
+
+    if ( ! events.events.empty() && reporter->GetWeirdCount() == weirds )
+        native_cache->Insert(key, std::move(events));
+
+    return false;
+}
+
+void X509::ParseCertificateData() {
+    const unsigned char* cert_char = reinterpret_cast<const unsigned char*>(cert_data.data());
+
     // ok, now we can try to parse the certificate with openssl. Should
     // be rather straightforward...
     ::X509* ssl_cert = d2i_X509(NULL, &cert_char, cert_data.size());
     if ( ! ssl_cert ) {
         reporter->Weird(GetFile(), "x509_cert_parse_error");
-        return false;
+        return;
     }
 
     X509Val* cert_val = new X509Val(ssl_cert); // cert_val takes ownership of ssl_cert
@@ -78,7 +125,7 @@ bool X509::EndOfFile() {
 
     // and send the record on to scriptland
     if ( x509_certificate )
-        event_mgr.Enqueue(x509_certificate, GetFile()->ToVal(), IntrusivePtr{NewRef{}, cert_val}, cert_record);
+        RaiseFileEvent(x509_certificate, {IntrusivePtr{NewRef{}, cert_val}, cert_record});
 
     // after parsing the certificate - parse the extensions...
 
@@ -97,8 +144,18 @@ bool X509::EndOfFile() {
     // The certificate will be freed when the last X509Val is Unref'd.
 
     Unref(cert_val); // Same for cert_val
+}
 
-    return false;
+CertificateCache* X509::NativeCertificateCache() {
+    static auto* cache = BifConst::X509::native_certificate_cache_size > 0 ?
+                             new CertificateCache(BifConst::X509::native_certificate_cache_size) :
+                             nullptr;
+    return cache;
+}
+
+void X509::FreeNativeCertificateCache() {
+    if ( auto* cache = NativeCertificateCache() )
+        cache->Clear();
 }
 
 RecordValPtr X509::ParseCertificate(X509Val* cert_val, file_analysis::File* f) {
@@ -290,7 +347,7 @@ void X509::ParseBasicConstraints(X509_EXTENSION* ex) {
             if ( constr->pathlen )
                 pBasicConstraint->Assign(1, static_cast<int32_t>(ASN1_INTEGER_get(constr->pathlen)));
 
-            event_mgr.Enqueue(x509_ext_basic_constraints, GetFile()->ToVal(), std::move(pBasicConstraint));
+            RaiseFileEvent(x509_ext_basic_constraints, {std::move(pBasicConstraint)});
         }
 
         BASIC_CONSTRAINTS_free(constr);
@@ -419,7 +476,7 @@ void X509::ParseSAN(X509_EXTENSION* ext) {
 
     sanExt->Assign(4, otherfields);
 
-    event_mgr.Enqueue(x509_ext_subject_alternative_name, GetFile()->ToVal(), std::move(sanExt));
+    RaiseFileEvent(x509_ext_subject_alternative_name, {std::move(sanExt)});
     GENERAL_NAMES_free(altname);
 }
 
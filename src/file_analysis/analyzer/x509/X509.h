@@ -60,6 +60,7 @@ static void RSA_get0_key(const RSA* r, const BIGNUM** n, const BIGNUM** e, const
 
 namespace zeek::file_analysis::detail {
 
+class CertificateCache;
 class X509Val;
 
 class X509 : public file_analysis::detail::X509Common {
@@ -119,6 +120,11 @@ public:
      */
     static void SetCertificateCacheHitCallback(FuncPtr func) { cache_hit_callback = std::move(func); }
 
+    /**
+     * Releases the entries of the native certificate cache.
+     */
+    static void FreeNativeCertificateCache();
+
 protected:
     X509(RecordValPtr args, file_analysis::File* file);
 
@@ -127,6 +133,12 @@ private:
     void ParseSAN(X509_EXTENSION* ex);
     void ParseExtensionsSpecific(X509_EXTENSION* ex, bool, ASN1_OBJECT*, const char*) override;
 
+    // Parses the certificate and raises its events.
+    void ParseCertificateData();
+
+    // Returns the native certificate cache, or null if disabled.
+    static CertificateCache* NativeCertificateCache();
+
     std::string cert_data;
 
     // Helpers for ParseCertificate.
@@ -8,7 +8,10 @@
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 
+#include "zeek/Event.h"
 #include "zeek/Reporter.h"
+#include "zeek/file_analysis/File.h"
+#include "zeek/file_analysis/analyzer/x509/CertificateCache.h"
 #include "zeek/file_analysis/analyzer/x509/events.bif.h"
 #include "zeek/file_analysis/analyzer/x509/ocsp_events.bif.h"
 #include "zeek/file_analysis/analyzer/x509/types.bif.h"
@@ -19,6 +22,14 @@ namespace zeek::file_analysis::detail {
 X509Common::X509Common(const zeek::Tag& arg_tag, RecordValPtr arg_args, file_analysis::File* arg_file)
     : file_analysis::Analyzer(arg_tag, std::move(arg_args), arg_file) {}
 
+void X509Common::RaiseFileEvent(const EventHandlerPtr& h, Args args) {
+    if ( recording )
+        recording->events.emplace_back(h, args);
+
+    args.insert(args.begin(), GetFile()->ToVal());
+    event_mgr.Enqueue(h, std::move(args));
+}
+
 static void EmitWeird(const char* name, file_analysis::File* file, const char* addl = "") {
     if ( file )
         reporter->Weird(file, name, addl);
@@ -260,9 +271,9 @@ void X509Common::ParseExtension(X509_EXTENSION* ex, const EventHandlerPtr& h, bo
     // but I am not sure if there is a better way to do it...
 
     if ( h == ocsp_extension )
-        event_mgr.Enqueue(h, GetFile()->ToVal(), std::move(pX509Ext), val_mgr->Bool(global));
+        RaiseFileEvent(h, {std::move(pX509Ext), val_mgr->Bool(global)});
     else
-        event_mgr.Enqueue(h, GetFile()->ToVal(), std::move(pX509Ext));
+        RaiseFileEvent(h, {std::move(pX509Ext)});
 
     // let individual analyzers parse more.
     ParseExtensionsSpecific(ex, global, ext_asn, oid);
@@ -8,6 +8,7 @@
 #include <openssl/asn1.h>
 #include <openssl/x509.h>
 
+#include "zeek/ZeekArgs.h"
 #include "zeek/file_analysis/Analyzer.h"
 
 namespace zeek {
@@ -25,6 +26,8 @@ class File;
 
 namespace detail {
 
+struct CertificateEvents;
+
 class X509Common : public file_analysis::Analyzer {
 public:
     ~X509Common() override {};
@@ -44,12 +47,21 @@ public:
 
     static double GetTimeFromAsn1(const ASN1_TIME* atime, file_analysis::File* f, Reporter* reporter);
 
+    /**
+     * Raises an event with the file's \c fa_file record prepended to the
+     * given arguments. While a recording is set, the event also goes into
+     * it, for replaying it later.
+     */
+    void RaiseFileEvent(const EventHandlerPtr& h, Args args);
+
 protected:
     X509Common(const zeek::Tag& arg_tag, RecordValPtr arg_args, file_analysis::File* arg_file);
 
     void ParseExtension(X509_EXTENSION* ex, const EventHandlerPtr& h, bool global);
     void ParseSignedCertificateTimestamps(X509_EXTENSION* ext);
     virtual void ParseExtensionsSpecific(X509_EXTENSION* ex, bool, ASN1_OBJECT*, const char*) = 0;
+
+    CertificateEvents* recording = nullptr; // Where RaiseFileEvent() records events, if set.
 };
 
 } // namespace detail
@@ -2,8 +2,12 @@
 
 #include "zeek/input/Manager.h"
 
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "zeek/CompHash.h"
 #include "zeek/Desc.h"
@@ -36,6 +40,9 @@ namespace zeek::input {
 struct InputHash {
     zeek::detail::hash_t valhash;
     zeek::detail::HashKey* idxkey;
+    // For readers sending chunks: the chunk that last sent the entry.
+    // Unset for entries a predicate kept after they vanished.
+    std::optional<uint64_t> chunk;
     ~InputHash();
 };
 
@@ -96,6 +103,25 @@ public:
 
     EventHandlerPtr event;
 
+    // State for readers sending their input source in chunks. chunks
+    // maps the chunks of the previous update to the lastDict keys of
+    // their entries, orphans holds the keys of entries that vanished but
+    // were kept by the predicate. have_chunks is set if chunks describes
+    // all of lastDict.
+    using ChunkKeys = std::vector<zeek::detail::HashKey>;
+    std::unordered_map<uint64_t, ChunkKeys> chunks;
+    ChunkKeys orphans;
+    bool have_chunks = false;
+
+    // Chunks sent or kept during the current update.
+    std::unordered_map<uint64_t, ChunkKeys> next_chunks;
+    std::unordered_set<uint64_t> kept_chunks;
+    uint64_t current_chunk = 0;
+    bool chunked_update = false;
+
+    // Records an entry added to currDict as part of the current chunk.
+    void AddToChunk(InputHash* h, const zeek::detail::HashKey& key);
+
     TableStream();
     ~TableStream() override;
 };
@@ -163,6 +189,14 @@ Manager::TableStream::~TableStream() {
     }
 }
 
+void Manager::TableStream::AddToChunk(InputHash* h, const zeek::detail::HashKey& key) {
+    if ( ! chunked_update )
+        return;
+
+    h->chunk = current_chunk;
+    next_chunks[current_chunk].emplace_back(key);
+}
+
 Manager::AnalysisStream::AnalysisStream() : Manager::Stream::Stream(ANALYSIS_STREAM), file_id() {}
 
 Manager::Manager() : plugin::ComponentManager<input::Component>("Input", "Reader") {
@@ -217,6 +251,7 @@ bool Manager::CreateStream(Stream* info, RecordVal* description) {
     ReaderBackend::ReaderInfo rinfo;
     rinfo.source = util::copy_string(source.c_str(), source.size());
     rinfo.name = util::copy_string(name.c_str(), name.size());
+    rinfo.table_stream = (info->stream_type == TABLE_STREAM);
 
     auto mode_val = description->GetFieldOrDefault("mode");
     auto mode = mode_val->AsEnumVal();
@@ -1109,6 +1144,7 @@ int Manager::SendEntryTable(Stream* i, const Value* const* vals) {
             // ok, exact duplicate, move entry to new dictionary and do nothing else.
             stream->lastDict->Remove(idxhash);
             stream->currDict->Insert(idxhash, h);
+            stream->AddToChunk(h, *idxhash);
             delete idxhash;
             return stream->num_val_fields + stream->num_idx_fields;
         }
@@ -1173,6 +1209,7 @@ int Manager::SendEntryTable(Stream* i, const Value* const* vals) {
                 else {
                     // keep old one
                     stream->currDict->Insert(idxhash, h);
+                    stream->AddToChunk(h, *idxhash);
                     delete idxhash;
                     return stream->num_val_fields + stream->num_idx_fields;
                 }
@@ -1227,6 +1264,7 @@ int Manager::SendEntryTable(Stream* i, const Value* const* vals) {
 
     auto prev = stream->currDict->Insert(idxhash, ih);
     delete prev;
+    stream->AddToChunk(ih, *idxhash);
     delete idxhash;
 
     if ( stream->event ) {
@@ -1280,56 +1318,97 @@ void Manager::EndCurrentSend(ReaderFrontend* reader) {
     assert(i->stream_type == TABLE_STREAM);
     auto* stream = static_cast<TableStream*>(i);
 
-    // lastdict contains all deleted entries and should be empty apart from that
-    for ( auto it = stream->lastDict->begin_robust(); it != stream->lastDict->end_robust(); ++it ) {
-        auto lastDictIdxKey = it->GetHashKey();
-        InputHash* ih = it->value;
+    if ( stream->chunked_update && stream->have_chunks ) {
+        // Entries of kept chunks stay in lastDict. Only the entries of
+        // chunks that changed or vanished, and those kept by the
+        // predicate earlier, may have to be removed.
+        std::vector<std::pair<const zeek::detail::HashKey*, std::optional<uint64_t>>> candidates;
 
-        ValPtr val;
-        ValPtr predidx;
-        EnumValPtr ev;
-        int startpos = 0;
+        for ( const auto& [id, keys] : stream->chunks ) {
+            if ( stream->kept_chunks.count(id) == 0 ) {
+                for ( const auto& k : keys )
+                    candidates.emplace_back(&k, id);
+            }
+        }
 
-        if ( stream->pred || stream->event ) {
-            auto idx = stream->tab->RecreateIndex(*ih->idxkey);
-            assert(idx != nullptr);
-            val = stream->tab->FindOrDefault(idx);
-            assert(val != nullptr);
-            predidx = {AdoptRef{}, ListValToRecordVal(idx.get(), stream->itype, &startpos)};
-            ev = BifType::Enum::Input::Event->GetEnumVal(BifEnum::Input::EVENT_REMOVED);
+        for ( const auto& k : stream->orphans )
+            candidates.emplace_back(&k, std::nullopt);
+
+        TableStream::ChunkKeys orphans;
+
+        for ( const auto& [key, chunk] : candidates ) {
+            // Skip entries that were sent again, or sent last by another chunk.
+            InputHash* ih = stream->lastDict->Lookup(key);
+            if ( ! ih || ih->chunk != chunk )
+                continue;
+
+            if ( ExpireTableEntry(stream, *ih->idxkey) )
+                delete stream->lastDict->Remove(key);
+            else {
+                ih->chunk.reset();
+                orphans.emplace_back(*key);
+            }
         }
 
-        if ( stream->pred ) {
-            // ask predicate, if we want to expire this element...
+        // lastDict keeps being the snapshot of the table, add everything
+        // sent during this update to it.
+        for ( auto it = stream->currDict->begin_robust(); it != stream->currDict->end_robust(); ++it ) {
+            auto k = it->GetHashKey();
+            delete stream->lastDict->Insert(k.get(), stream->currDict->RemoveEntry(k.get()));
+        }
 
-            bool result = CallPred(stream->pred, 3, ev->Ref(), predidx->Ref(), val->Ref());
+        for ( auto id : stream->kept_chunks ) {
+            auto it = stream->chunks.find(id);
+            if ( it == stream->chunks.end() )
+                continue;
 
-            if ( result == false ) {
+            auto& keys = stream->next_chunks[id];
+            keys.insert(keys.end(), std::make_move_iterator(it->second.begin()),
+                        std::make_move_iterator(it->second.end()));
+        }
+
+        stream->orphans = std::move(orphans);
+    }
+
+    else {
+        // lastdict contains all deleted entries and should be empty apart from that
+        for ( auto it = stream->lastDict->begin_robust(); it != stream->lastDict->end_robust(); ++it ) {
+            auto lastDictIdxKey = it->GetHashKey();
+            InputHash* ih = it->value;
+
+            if ( ! ExpireTableEntry(stream, *ih->idxkey) ) {
                 // Keep it. Hence - we quit and simply go to the next entry of lastDict
                 // ah well - and we have to add the entry to currDict...
                 stream->currDict->Insert(lastDictIdxKey.get(), stream->lastDict->RemoveEntry(lastDictIdxKey.get()));
+
+                if ( stream->chunked_update ) {
+                    ih->chunk.reset();
+                    stream->orphans.emplace_back(*lastDictIdxKey);
+                }
+
                 continue;
             }
-        }
 
-        if ( stream->event ) {
-            if ( stream->num_val_fields == 0 )
-                SendEvent(stream->event, 3, stream->description->Ref(), ev->Ref(), predidx->Ref());
-            else
-                SendEvent(stream->event, 4, stream->description->Ref(), ev->Ref(), predidx->Ref(), val->Ref());
+            stream->lastDict->Remove(lastDictIdxKey.get()); // delete in next line
+            delete ih;
         }
 
-        stream->tab->Remove(*ih->idxkey);
-        stream->lastDict->Remove(lastDictIdxKey.get()); // delete in next line
-        delete ih;
-    }
+        stream->lastDict->Clear(); // should be empty. but well... who knows...
+        delete stream->lastDict;
 
-    stream->lastDict->Clear(); // should be empty. but well... who knows...
-    delete stream->lastDict;
+        stream->lastDict = stream->currDict;
+        stream->currDict = new PDict<InputHash>;
+        stream->currDict->SetDeleteFunc(input_hash_delete_func);
 
-    stream->lastDict = stream->currDict;
-    stream->currDict = new PDict<InputHash>;
-    stream->currDict->SetDeleteFunc(input_hash_delete_func);
+        if ( ! stream->chunked_update )
+            stream->orphans.clear();
+    }
+
+    stream->chunks = std::move(stream->next_chunks);
+    stream->next_chunks.clear();
+    stream->kept_chunks.clear();
+    stream->have_chunks = stream->chunked_update;
+    stream->chunked_update = false;
 
 #ifdef DEBUG
     DBG_LOG(DBG_INPUT, "EndCurrentSend complete for stream %s", i->name.c_str());
@@ -1338,6 +1417,72 @@ void Manager::EndCurrentSend(ReaderFrontend* reader) {
     SendEndOfData(i);
 }
 
+bool Manager::ExpireTableEntry(TableStream* stream, const zeek::detail::HashKey& idxkey) {
+    ValPtr val;
+    ValPtr predidx;
+    EnumValPtr ev;
+    int startpos = 0;
+
+    if ( stream->pred || stream->event ) {
+        auto idx = stream->tab->RecreateIndex(idxkey);
+        assert(idx != nullptr);
+        val = stream->tab->FindOrDefault(idx);
+        assert(val != nullptr);
+        predidx = {AdoptRef{}, ListValToRecordVal(idx.get(), stream->itype, &startpos)};
+        ev = BifType::Enum::Input::Event->GetEnumVal(BifEnum::Input::EVENT_REMOVED);
+    }
+
+    if ( stream->pred ) {
+        // ask predicate, if we want to expire this element...
+        bool result = CallPred(stream->pred, 3, ev->Ref(), predidx->Ref(), val->Ref());
+
+        if ( result == false )
+            return false;
+    }
+
+    if ( stream->event ) {
+        if ( stream->num_val_fields == 0 )
+            SendEvent(stream->event, 3, stream->description->Ref(), ev->Ref(), predidx->Ref());
+        else
+            SendEvent(stream->event, 4, stream->description->Ref(), ev->Ref(), predidx->Ref(), val->Ref());
+    }
+
+    stream->tab->Remove(idxkey);
+    return true;
+}
+
+void Manager::BeginChunk(ReaderFrontend* reader, uint64_t chunk) {
+    Stream* i = FindStream(reader);
+
+    if ( i == nullptr ) {
+        reporter->InternalWarning("Unknown reader %s in BeginChunk", reader->Name());
+        return;
+    }
+
+    if ( i->stream_type != TABLE_STREAM )
+        return;
+
+    auto* stream = static_cast<TableStream*>(i);
+    stream->chunked_update = true;
+    stream->current_chunk = chunk;
+}
+
+void Manager::KeepChunk(ReaderFrontend* reader, uint64_t chunk) {
+    Stream* i = FindStream(reader);
+
+    if ( i == nullptr ) {
+        reporter->InternalWarning("Unknown reader %s in KeepChunk", reader->Name());
+        return;
+    }
+
+    if ( i->stream_type != TABLE_STREAM )
+        return;
+
+    auto* stream = static_cast<TableStream*>(i);
+    stream->chunked_update = true;
+    stream->kept_chunks.insert(chunk);
+}
+
 void Manager::SendEndOfData(ReaderFrontend* reader) {
     Stream* i = FindStream(reader);
 
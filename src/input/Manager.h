@@ -122,6 +122,8 @@ protected:
     friend class ClearMessage;
     friend class SendEntryMessage;
     friend class EndCurrentSendMessage;
+    friend class BeginChunkMessage;
+    friend class KeepChunkMessage;
     friend class ReaderClosedMessage;
     friend class DisableMessage;
     friend class EndOfDataMessage;
@@ -143,6 +145,12 @@ protected:
     void SendEntry(ReaderFrontend* reader, threading::Value** vals);
     void EndCurrentSend(ReaderFrontend* reader);
 
+    // For readers sending their input source in chunks in indirect mode.
+    // BeginChunk() assigns the following entries to a chunk, KeepChunk()
+    // retains the entries of an unchanged chunk of the previous update.
+    void BeginChunk(ReaderFrontend* reader, uint64_t chunk);
+    void KeepChunk(ReaderFrontend* reader, uint64_t chunk);
+
     // Instantiates a new ReaderBackend of the given type (note that
     // doing so creates a new thread!).
     ReaderBackend* CreateBackend(ReaderFrontend* frontend, EnumVal* tag);
@@ -192,6 +200,12 @@ private:
     // SendEntry implementation for Table stream.
     int SendEntryTable(Stream* i, const threading::Value* const* vals);
 
+    // Handles a table entry that vanished from the input source: asks
+    // the predicate and, unless it vetoes, raises the removed event and
+    // deletes the entry from the table. Returns false if the predicate
+    // keeps the entry.
+    bool ExpireTableEntry(TableStream* stream, const zeek::detail::HashKey& idxkey);
+
     // Put implementation for Table stream.
     int PutTable(Stream* i, const threading::Value* const* vals);
 
@@ -94,6 +94,34 @@ public:
 private:
 };
 
+class BeginChunkMessage final : public threading::OutputMessage<ReaderFrontend> {
+public:
+    BeginChunkMessage(ReaderFrontend* reader, uint64_t chunk)
+        : threading::OutputMessage<ReaderFrontend>("BeginChunk", reader), chunk(chunk) {}
+
+    bool Process() override {
+        input_mgr->BeginChunk(Object(), chunk);
+        return true;
+    }
+
+private:
+    uint64_t chunk;
+};
+
+class KeepChunkMessage final : public threading::OutputMessage<ReaderFrontend> {
+public:
+    KeepChunkMessage(ReaderFrontend* reader, uint64_t chunk)
+        : threading::OutputMessage<ReaderFrontend>("KeepChunk", reader), chunk(chunk) {}
+
+    bool Process() override {
+        input_mgr->KeepChunk(Object(), chunk);
+        return true;
+    }
+
+private:
+    uint64_t chunk;
+};
+
 class EndOfDataMessage final : public threading::OutputMessage<ReaderFrontend> {
 public:
     EndOfDataMessage(ReaderFrontend* reader) : threading::OutputMessage<ReaderFrontend>("EndOfData", reader) {}
@@ -172,6 +200,10 @@ void ReaderBackend::EndOfData() { SendOut(new EndOfDataMessage(frontend)); }
 
 void ReaderBackend::SendEntry(Value** vals) { SendOut(new SendEntryMessage(frontend, vals)); }
 
+void ReaderBackend::BeginChunk(uint64_t chunk) { SendOut(new BeginChunkMessage(frontend, chunk)); }
+
+void ReaderBackend::KeepChunk(uint64_t chunk) { SendOut(new KeepChunkMessage(frontend, chunk)); }
+
 bool ReaderBackend::Init(const int arg_num_fields, const threading::Field* const* arg_fields) {
     if ( Failed() )
         return true;
@@ -109,16 +109,25 @@ public:
          */
         ReaderMode mode;
 
+        /**
+         * True if the stream fills a table, i.e., the manager keeps
+         * track of the entries sent with SendEntry() and readers may use
+         * BeginChunk() and KeepChunk().
+         */
+        bool table_stream;
+
         ReaderInfo() {
             source = nullptr;
             name = nullptr;
             mode = MODE_NONE;
+            table_stream = false;
         }
 
         ReaderInfo(const ReaderInfo& other) {
             source = other.source ? util::copy_string(other.source) : nullptr;
             name = other.name ? util::copy_string(other.name) : nullptr;
             mode = other.mode;
+            table_stream = other.table_stream;
 
             for ( config_map::const_iterator i = other.config.begin(); i != other.config.end(); i++ )
                 config.insert(std::make_pair(util::copy_string(i->first), util::copy_string(i->second)));
@@ -352,6 +361,32 @@ protected:
      */
     void EndCurrentSend();
 
+    /**
+     * Method telling the manager that the entries following in the
+     * current list of entries sent by SendEntry belong to the given
+     * chunk of the input source. Readers that can cheaply recognize
+     * unchanged parts of their input source use this together with
+     * KeepChunk() to avoid sending the complete source on every update.
+     *
+     * Chunk ids must identify a chunk's content, e.g., by a checksum.
+     * Only valid for table streams, see ReaderInfo::table_stream. Once
+     * a reader uses chunks, it must put all entries it sends into
+     * chunks.
+     *
+     * @param chunk The id of the chunk.
+     */
+    void BeginChunk(uint64_t chunk);
+
+    /**
+     * Method telling the manager that the given chunk, sent with
+     * BeginChunk() during the previous list of entries, is still part
+     * of the input source unchanged. Its entries are retained without
+     * being sent again.
+     *
+     * @param chunk The id of the chunk.
+     */
+    void KeepChunk(uint64_t chunk);
+
 private:
     // Frontend that instantiated us. This object must not be accessed
     // from this class, it's running in a different thread!
@@ -5,7 +5,18 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cerrno>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string_view>
+#include <thread>
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
 
 #include "zeek/input/readers/ascii/ascii.bif.h"
 #include "zeek/threading/SerialTypes.h"
@@ -58,6 +69,9 @@ Ascii::Ascii(ReaderFrontend* frontend) : ReaderBackend(frontend) {
     ino = 0;
     fail_on_file_problem = false;
     fail_on_invalid_lines = false;
+    fast_mode = false;
+    fast_mode_threads = 0;
+    incremental_reload = false;
 }
 
 void Ascii::DoClose() { read_location.reset(); }
@@ -82,6 +96,10 @@ bool Ascii::DoInit(const ReaderInfo& info, int num_fields, const Field* const* f
     path_prefix.assign((const char*)BifConst::InputAscii::path_prefix->Bytes(),
                        BifConst::InputAscii::path_prefix->Len());
 
+    fast_mode = BifConst::InputAscii::fast_mode;
+    fast_mode_threads = BifConst::InputAscii::fast_mode_threads;
+    incremental_reload = BifConst::InputAscii::incremental_reload;
+
     // Set per-filter configuration options.
     for ( const auto& [k, v] : info.config ) {
         if ( strcmp(k, "separator") == 0 )
@@ -101,6 +119,15 @@ bool Ascii::DoInit(const ReaderInfo& info, int num_fields, const Field* const* f
 
         else if ( strcmp(k, "fail_on_file_problem") == 0 )
             fail_on_file_problem = (strncmp(v, "T", 1) == 0);
+
+        else if ( strcmp(k, "fast_mode") == 0 )
+            fast_mode = (strncmp(v, "T", 1) == 0);
+
+        else if ( strcmp(k, "fast_mode_threads") == 0 )
+            fast_mode_threads = strtoul(v, nullptr, 10);
+
+        else if ( strcmp(k, "incremental_reload") == 0 )
+            incremental_reload = (strncmp(v, "T", 1) == 0);
     }
 
     if ( separator.size() != 1 )
@@ -252,6 +279,44 @@ bool Ascii::GetLine(string& str) {
     return false;
 }
 
+#ifndef _MSC_VER
+namespace {
+
+// A read-only memory mapping of a complete file.
+struct MappedFile {
+    explicit MappedFile(const string& fname) {
+        int fd = open(fname.c_str(), O_RDONLY);
+
+        if ( fd < 0 )
+            return;
+
+        struct stat sb;
+
+        if ( fstat(fd, &sb) == 0 && sb.st_size > 0 ) {
+            void* p = mmap(nullptr, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if ( p != MAP_FAILED ) {
+                madvise(p, sb.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(p);
+                size = sb.st_size;
+            }
+        }
+
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if ( data )
+            munmap(const_cast<char*>(data), size);
+    }
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+} // namespace
+#endif
+
 // read the entire file and send appropriate thingies back to InputMgr
 bool Ascii::DoUpdate() {
     if ( ! OpenFile() )
@@ -313,102 +378,288 @@ bool Ascii::DoUpdate() {
         default: assert(false);
     }
 
-    string line;
+    bool done = false;
+
+#ifndef _MSC_VER
+    bool incremental = incremental_reload && Info().table_stream;
 
-    file.sync();
+    if ( (fast_mode || incremental) && Info().mode != MODE_STREAM && separator[0] != '\n' && separator[0] != '\r' ) {
+        // The header has been read through the stream already, continue
+        // with the data lines following it.
+        auto offset = file.tellg();
 
-    while ( GetLine(line) ) {
-        // split on tabs
-        bool error = false;
-        auto stringfields = util::split(line, separator[0]);
+        if ( offset >= 0 ) {
+            MappedFile mapped(fname);
 
-        // This needs to be a signed value or the comparisons below will fail.
-        int pos = static_cast<int>(stringfields.size() - 1);
+            if ( mapped.data ) {
+                if ( incremental ) {
+                    if ( ! ReadIncremental(mapped.data, mapped.size, static_cast<size_t>(offset)) )
+                        return false;
+                }
 
-        Value** fields = new Value*[NumFields()];
+                else if ( ! ReadFast(mapped.data, mapped.size, static_cast<size_t>(offset)) )
+                    return false;
 
-        int fpos = 0;
-        for ( const auto& fit : columnMap ) {
-            if ( ! fit.present ) {
-                // add non-present field
-                fields[fpos] = new Value(fit.type, false);
-                if ( read_location )
-                    fields[fpos]->SetFileLineNumber(read_location->first_line);
-                fpos++;
-                continue;
+                done = true;
             }
+        }
+    }
+#endif
 
-            assert(fit.position >= 0);
+    if ( ! done ) {
+        // The manager forgets about chunks when an update doesn't use
+        // them, start over during the next incremental update.
+        reload_chunks.clear();
 
-            if ( fit.position > pos || fit.secondary_position > pos ) {
-                FailWarn(fail_on_invalid_lines,
-                         Fmt("Not enough fields in line '%s' of %s. Found "
-                             "%d fields, want positions %d and %d",
-                             line.c_str(), fname.c_str(), pos, fit.position, fit.secondary_position),
-                         ! fail_on_invalid_lines);
+        string line;
 
-                if ( fail_on_invalid_lines ) {
-                    for ( int i = 0; i < fpos; i++ )
-                        delete fields[i];
+        file.sync();
 
-                    delete[] fields;
+        while ( GetLine(line) ) {
+            // split on tabs
+            auto stringfields = util::split(line, separator[0]);
 
-                    return false;
-                }
-                else {
-                    error = true;
-                    break;
-                }
+            if ( ! ProcessLine(line, stringfields) )
+                return false;
+        }
+    }
+
+    if ( Info().mode != MODE_STREAM )
+        EndCurrentSend();
+
+    StopWarningSuppression();
+    return true;
+}
+
+bool Ascii::ReadFast(const char* data, size_t size, size_t offset) {
+    // Chunks are tokenized concurrently. Converting the fields into values
+    // happens on this thread in file order, so that warnings, line numbers
+    // and the order of entries are exactly the same as when reading line
+    // by line.
+    constexpr size_t chunk_size = 4 * 1024 * 1024;
+
+    size_t max_pending = fast_mode_threads;
+
+    if ( max_pending == 0 )
+        max_pending = std::clamp(std::thread::hardware_concurrency(), 1U, 8U);
+
+    const char sep = separator[0];
+    const char* pos = data + std::min(offset, size);
+    const char* end = data + size;
+
+    uint64_t line_base = read_location ? read_location->first_line : 0;
+
+    // Futures returned by std::async block in their destructor, so no
+    // chunk is still being scanned when the mapping goes away.
+    std::deque<std::future<ScannedChunk>> pending;
+
+    while ( pos < end || ! pending.empty() ) {
+        while ( pos < end && pending.size() < max_pending ) {
+            // Extend the chunk to the end of its last line.
+            const char* chunk_end = pos + std::min(chunk_size, static_cast<size_t>(end - pos));
+
+            if ( chunk_end < end ) {
+                auto nl = static_cast<const char*>(memchr(chunk_end, '\n', end - chunk_end));
+                chunk_end = nl ? nl + 1 : end;
             }
 
-            Value* val = formatter->ParseValue(stringfields[fit.position], fit.name, fit.type, fit.subtype);
-            if ( ! val ) {
-                Warning(Fmt("Could not convert line '%s' of %s to Val. Ignoring line.", line.c_str(), fname.c_str()));
-                error = true;
+            pending.push_back(std::async(std::launch::async, [pos, chunk_end, sep]() {
+                ScannedChunk chunk;
+                scan_chunk(pos, chunk_end, sep, &chunk);
+                return chunk;
+            }));
+
+            pos = chunk_end;
+        }
+
+        auto chunk = pending.front().get();
+        pending.pop_front();
+
+        if ( ! ProcessChunk(chunk, line_base) )
+            return false;
+
+        line_base += chunk.physical_lines;
+    }
+
+    if ( read_location ) {
+        read_location->first_line = line_base;
+        read_location->last_line = line_base;
+    }
+
+    return true;
+}
+
+bool Ascii::ReadIncremental(const char* data, size_t size, size_t offset) {
+    // Chunks end after a line whose hash has its low bits cleared, so that
+    // inserting or removing lines only changes the chunks containing them.
+    // Chunks average 256 lines.
+    constexpr uint64_t boundary_mask = 0xff;
+    constexpr uint64_t max_chunk_lines = 4096;
+
+    const char* pos = data + std::min(offset, size);
+    const char* end = data + size;
+
+    uint64_t line_base = read_location ? read_location->first_line : 0;
+
+    // A changed header changes the meaning of all lines.
+    const uint64_t seed = std::hash<string>{}(headerline);
+
+    std::unordered_set<uint64_t> seen;
+
+    while ( pos < end ) {
+        const char* chunk_end = pos;
+        uint64_t id = seed;
+        uint64_t lines = 0;
+
+        while ( chunk_end < end ) {
+            auto nl = static_cast<const char*>(memchr(chunk_end, '\n', end - chunk_end));
+            const char* line_end = nl ? nl + 1 : end;
+            uint64_t h = std::hash<std::string_view>{}(std::string_view(chunk_end, line_end - chunk_end));
+
+            id ^= h + 0x9e3779b97f4a7c15 + (id << 6) + (id >> 2);
+            chunk_end = line_end;
+            ++lines;
+
+            if ( (h & boundary_mask) == 0 || lines == max_chunk_lines )
                 break;
-            }
+        }
 
-            if ( read_location )
-                val->SetFileLineNumber(read_location->first_line);
+        if ( reload_chunks.count(id) != 0 )
+            KeepChunk(id);
 
-            if ( fit.secondary_position != -1 ) {
-                // we have a port definition :)
-                assert(val->type == TYPE_PORT);
-                val->val.port_val.proto = formatter->ParseProto(stringfields[fit.secondary_position]);
-            }
+        else {
+            BeginChunk(id);
 
-            fields[fpos] = val;
+            ScannedChunk chunk;
+            scan_chunk(pos, chunk_end, separator[0], &chunk);
 
-            fpos++;
+            if ( ! ProcessChunk(chunk, line_base) )
+                return false;
         }
 
-        if ( error ) {
-            // Encountered non-fatal error, ignoring line. But
-            // first, delete all successfully read fields and the
-            // array structure.
+        seen.insert(id);
+        line_base += lines;
+        pos = chunk_end;
+    }
+
+    reload_chunks = std::move(seen);
+
+    if ( read_location ) {
+        read_location->first_line = line_base;
+        read_location->last_line = line_base;
+    }
+
+    return true;
+}
+
+bool Ascii::ProcessChunk(const ScannedChunk& chunk, uint64_t line_base) {
+    string line;
+    std::vector<string> stringfields;
+
+    for ( const auto& l : chunk.lines ) {
+        if ( read_location ) {
+            read_location->first_line = line_base + l.line_number;
+            read_location->last_line = read_location->first_line;
+        }
+
+        line.assign(l.text);
+        stringfields.resize(l.num_fields);
+
+        for ( size_t i = 0; i < l.num_fields; ++i )
+            stringfields[i].assign(chunk.fields[l.first_field + i]);
+
+        if ( ! ProcessLine(line, stringfields) )
+            return false;
+    }
+
+    return true;
+}
+
+bool Ascii::ProcessLine(const string& line, const std::vector<string>& stringfields) {
+    bool error = false;
 
-            for ( int i = 0; i < fpos; i++ )
-                delete fields[i];
+    // This needs to be a signed value or the comparisons below will fail.
+    int pos = static_cast<int>(stringfields.size() - 1);
 
-            delete[] fields;
+    Value** fields = new Value*[NumFields()];
+
+    int fpos = 0;
+    for ( const auto& fit : columnMap ) {
+        if ( ! fit.present ) {
+            // add non-present field
+            fields[fpos] = new Value(fit.type, false);
+            if ( read_location )
+                fields[fpos]->SetFileLineNumber(read_location->first_line);
+            fpos++;
             continue;
         }
-        // If there's no error, then it makes sense to report the next error.
-        else
-            StopWarningSuppression();
 
-        assert(fpos == NumFields());
+        assert(fit.position >= 0);
 
-        if ( Info().mode == MODE_STREAM )
-            Put(fields);
-        else
-            SendEntry(fields);
+        if ( fit.position > pos || fit.secondary_position > pos ) {
+            FailWarn(fail_on_invalid_lines,
+                     Fmt("Not enough fields in line '%s' of %s. Found "
+                         "%d fields, want positions %d and %d",
+                         line.c_str(), fname.c_str(), pos, fit.position, fit.secondary_position),
+                     ! fail_on_invalid_lines);
+
+            if ( fail_on_invalid_lines ) {
+                for ( int i = 0; i < fpos; i++ )
+                    delete fields[i];
+
+                delete[] fields;
+
+                return false;
+            }
+            else {
+                error = true;
+                break;
+            }
+        }
+
+        Value* val = formatter->ParseValue(stringfields[fit.position], fit.name, fit.type, fit.subtype);
+        if ( ! val ) {
+            Warning(Fmt("Could not convert line '%s' of %s to Val. Ignoring line.", line.c_str(), fname.c_str()));
+            error = true;
+            break;
+        }
+
+        if ( read_location )
+            val->SetFileLineNumber(read_location->first_line);
+
+        if ( fit.secondary_position != -1 ) {
+            // we have a port definition :)
+            assert(val->type == TYPE_PORT);
+            val->val.port_val.proto = formatter->ParseProto(stringfields[fit.secondary_position]);
+        }
+
+        fields[fpos] = val;
+
+        fpos++;
     }
 
-    if ( Info().mode != MODE_STREAM )
-        EndCurrentSend();
+    if ( error ) {
+        // Encountered non-fatal error, ignoring line. But
+        // first, delete all successfully read fields and the
+        // array structure.
+
+        for ( int i = 0; i < fpos; i++ )
+            delete fields[i];
+
+        delete[] fields;
+        return true;
+    }
+    // If there's no error, then it makes sense to report the next error.
+    else
+        StopWarningSuppression();
+
+    assert(fpos == NumFields());
+
+    if ( Info().mode == MODE_STREAM )
+        Put(fields);
+    else
+        SendEntry(fields);
 
-    StopWarningSuppression();
     return true;
 }
 
@@ -6,10 +6,12 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "zeek/Obj.h"
 #include "zeek/input/ReaderBackend.h"
+#include "zeek/input/readers/ascii/Scanner.h"
 #include "zeek/threading/formatters/Ascii.h"
 
 namespace zeek::input::reader::detail {
@@ -63,6 +65,22 @@ private:
     bool GetLine(std::string& str);
     bool OpenFile();
 
+    // Converts a line's fields into values and sends them to the frontend.
+    // Returns false if the line caused a fatal error.
+    bool ProcessLine(const std::string& line, const std::vector<std::string>& stringfields);
+
+    // Reads the data lines of a memory-mapped file, starting at the given
+    // offset. Returns false on a fatal error.
+    bool ReadFast(const char* data, size_t size, size_t offset);
+
+    // Like ReadFast(), but only parses and sends the chunks of the file
+    // that were not present during the previous update.
+    bool ReadIncremental(const char* data, size_t size, size_t offset);
+
+    // Converts and sends the lines of a scanned chunk that starts at the
+    // given line number. Returns false on a fatal error.
+    bool ProcessChunk(const ScannedChunk& chunk, uint64_t line_base);
+
     std::ifstream file;
     time_t mtime;
     ino_t ino;
@@ -86,6 +104,12 @@ private:
     bool fail_on_invalid_lines;
     bool fail_on_file_problem;
     std::string path_prefix;
+    bool fast_mode;
+    zeek_uint_t fast_mode_threads;
+    bool incremental_reload;
+
+    // Ids of the chunks read during the previous incremental update.
+    std::unordered_set<uint64_t> reload_chunks;
 
     std::unique_ptr<threading::Formatter> formatter;
 
@@ -0,0 +1,166 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/input/readers/ascii/Scanner.h"
+
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "zeek/3rdparty/doctest.h"
+
+namespace zeek::input::reader::detail {
+
+const char* find_first_of2(const char* begin, const char* end, char a, char b) {
+    const char* p = begin;
+
+#if defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+
+    for ( ; end - p >= 16; p += 16 ) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+        int mask = _mm_movemask_epi8(hits);
+
+        if ( mask != 0 )
+            return p + __builtin_ctz(mask);
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t va = vdupq_n_u8(static_cast<uint8_t>(a));
+    const uint8x16_t vb = vdupq_n_u8(static_cast<uint8_t>(b));
+
+    for ( ; end - p >= 16; p += 16 ) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint8x16_t hits = vorrq_u8(vceqq_u8(chunk, va), vceqq_u8(chunk, vb));
+
+        // Narrow the 128-bit comparison result into a 64-bit mask holding
+        // four bits per input byte.
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+
+        if ( mask != 0 )
+            return p + (__builtin_ctzll(mask) >> 2);
+    }
+#endif
+
+    for ( ; p < end; ++p ) {
+        if ( *p == a || *p == b )
+            return p;
+    }
+
+    return end;
+}
+
+// Applies Ascii::GetLine()'s rules to a physical line whose fields have
+// already been appended to out->fields, starting at first_field.
+static void finish_line(const char* start, const char* stop, size_t first_field, char separator, ScannedChunk* out) {
+    ++out->physical_lines;
+
+    size_t len = stop - start;
+
+    if ( len == 0 ) {
+        out->fields.resize(first_field);
+        return;
+    }
+
+    if ( start[len - 1] == '\r' ) {
+        --len;
+        out->fields.back().remove_suffix(1);
+    }
+
+    size_t offset = 0;
+
+    if ( len > 0 && start[0] == '#' ) {
+        if ( len <= 8 || memcmp(start, "#fields", 7) != 0 || start[7] != separator ) {
+            out->fields.resize(first_field);
+            return;
+        }
+
+        // Skip the "#fields" prefix, which is exactly the line's first field.
+        offset = 8;
+        ++first_field;
+    }
+
+    std::string_view text(start + offset, len - offset);
+    out->lines.push_back({out->physical_lines, text, first_field, out->fields.size() - first_field});
+}
+
+void scan_chunk(const char* begin, const char* end, char separator, ScannedChunk* out) {
+    const char* line_start = begin;
+    const char* field_start = begin;
+    size_t first_field = out->fields.size();
+
+    while ( line_start < end ) {
+        const char* hit = find_first_of2(field_start, end, '\n', separator);
+
+        out->fields.emplace_back(field_start, hit - field_start);
+
+        if ( hit != end && *hit == separator ) {
+            field_start = hit + 1;
+            continue;
+        }
+
+        // End of line, or end of the chunk without a final newline.
+        finish_line(line_start, hit, first_field, separator, out);
+
+        first_field = out->fields.size();
+        line_start = field_start = (hit == end ? end : hit + 1);
+    }
+}
+
+TEST_SUITE_BEGIN("input ascii scanner");
+
+TEST_CASE("find_first_of2") {
+    std::string s = "0123456789abcdefghijklmnopqrstuvwxyz\tfoo\n";
+    CHECK(find_first_of2(s.data(), s.data() + s.size(), '\n', '\t') == s.data() + 36);
+    CHECK(find_first_of2(s.data(), s.data() + s.size(), '\n', 'x') == s.data() + 33);
+    CHECK(find_first_of2(s.data(), s.data() + 10, '\n', '\t') == s.data() + 10);
+}
+
+TEST_CASE("scan_chunk") {
+    std::string s = "#separator \\x09\n#fields\ta\tb\r\n\n1\t\r\n\t2\n#close\nlast";
+    ScannedChunk c;
+    scan_chunk(s.data(), s.data() + s.size(), '\t', &c);
+
+    CHECK(c.physical_lines == 7);
+    REQUIRE(c.lines.size() == 4);
+
+    CHECK(c.lines[0].line_number == 2);
+    CHECK(c.lines[0].text == "a\tb");
+    REQUIRE(c.lines[0].num_fields == 2);
+    CHECK(c.fields[c.lines[0].first_field] == "a");
+    CHECK(c.fields[c.lines[0].first_field + 1] == "b");
+
+    CHECK(c.lines[1].line_number == 4);
+    CHECK(c.lines[1].text == "1\t");
+    REQUIRE(c.lines[1].num_fields == 2);
+    CHECK(c.fields[c.lines[1].first_field] == "1");
+    CHECK(c.fields[c.lines[1].first_field + 1] == "");
+
+    CHECK(c.lines[2].num_fields == 2);
+    CHECK(c.fields[c.lines[2].first_field] == "");
+    CHECK(c.fields[c.lines[2].first_field + 1] == "2");
+
+    CHECK(c.lines[3].line_number == 7);
+    CHECK(c.lines[3].text == "last");
+    CHECK(c.lines[3].num_fields == 1);
+}
+
+TEST_CASE("scan_chunk carriage return only") {
+    std::string s = "\r\n";
+    ScannedChunk c;
+    scan_chunk(s.data(), s.data() + s.size(), '\t', &c);
+
+    // Like Ascii::GetLine(), this yields an empty data line.
+    REQUIRE(c.lines.size() == 1);
+    CHECK(c.lines[0].text.empty());
+    CHECK(c.lines[0].num_fields == 1);
+}
+
+TEST_SUITE_END();
+
+} // namespace zeek::input::reader::detail
@@ -0,0 +1,56 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+//
+// Tokenizer for the fast mode of the ASCII input reader.
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace zeek::input::reader::detail {
+
+/**
+ * Returns a pointer to the first byte in [begin, end) equal to either \a a
+ * or \a b, or \a end if there's none. Uses SSE2 or NEON where available.
+ */
+const char* find_first_of2(const char* begin, const char* end, char a, char b);
+
+/**
+ * The lines and fields found in a chunk of an input file by scan_chunk().
+ */
+struct ScannedChunk {
+    struct Line {
+        uint64_t line_number; // Physical line number, relative to the chunk's start.
+        std::string_view text;
+        size_t first_field; // Index into fields.
+        size_t num_fields;
+    };
+
+    std::vector<Line> lines;
+    std::vector<std::string_view> fields;
+    uint64_t physical_lines = 0; // Number of physical lines in the chunk.
+};
+
+/**
+ * Splits a chunk of an input file into data lines and their fields, with
+ * the exact semantics of reading it through Ascii::GetLine() and
+ * util::split(): empty lines and comments are skipped, trailing CRs are
+ * removed, and "#fields" lines are returned without their prefix.
+ *
+ * The chunk must start at the beginning of a line and end at a line
+ * boundary or at the end of the file. The resulting views point into the
+ * chunk. The function does not access any shared state, so chunks can be
+ * scanned concurrently.
+ *
+ * @param begin Start of the chunk.
+ *
+ * @param end End of the chunk.
+ *
+ * @param separator The field separator. Must not be a CR or LF.
+ *
+ * @param out The chunk's lines and fields.
+ */
+void scan_chunk(const char* begin, const char* end, char separator, ScannedChunk* out);
+
+} // namespace zeek::input::reader::detail
@@ -3,12 +3,16 @@
 #include "zeek/iosource/Manager.h"
 
 #include <cassert>
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#else
 // These two files have to remain in the same order or FreeBSD builds
 // stop working.
 // clang-format off
 #include <sys/types.h>
 #include <sys/event.h>
 // clang-format on
+#endif
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -45,9 +49,17 @@ void Manager::WakeupHandler::Ping(std::string_view where) {
 }
 
 Manager::Manager() {
+#ifdef USE_EPOLL
+    event_queue = epoll_create1(EPOLL_CLOEXEC);
+    if ( event_queue == -1 )
+        reporter->FatalError("Failed to initialize epoll: %s", strerror(errno));
+
+    events.resize(1);
+#else
     event_queue = kqueue();
     if ( event_queue == -1 )
         reporter->FatalError("Failed to initialize kqueue: %s", strerror(errno));
+#endif
 }
 
 Manager::~Manager() {
@@ -188,6 +200,60 @@ void Manager::FindReadySources(ReadySources* ready) {
         Poll(ready, timeout, timeout_src);
 }
 
+#ifdef USE_EPOLL
+void Manager::Poll(ReadySources* ready, double timeout, IOSource* timeout_src) {
+    struct timespec spec;
+    ConvertTimeout(timeout, spec);
+
+    // epoll_wait() takes milliseconds. Round up so that timeouts below a
+    // millisecond don't turn into busy polling.
+    int timeout_ms = static_cast<int>(spec.tv_sec * 1000 + (spec.tv_nsec + 999999) / 1000000);
+
+    int ret = epoll_wait(event_queue, events.data(), static_cast<int>(events.size()), timeout_ms);
+    if ( ret == -1 ) {
+        // Ignore interrupts since we may catch one during shutdown and we don't want the
+        // error to get printed.
+        if ( errno != EINTR )
+            reporter->InternalWarning("Error calling epoll_wait: %s", strerror(errno));
+    }
+    else if ( ret == 0 ) {
+        // If a timeout_src was provided and nothing else was ready, we timed out
+        // according to the given source's timeout and can add it as ready.
+        if ( timeout_src )
+            ready->push_back({timeout_src, -1, 0});
+    }
+    else {
+        // Unlike kqueue, epoll reports the read and write readiness of a file
+        // descriptor in a single event. Errors and hangups are delivered to
+        // both directions, the same as kqueue's EV_EOF.
+        bool timeout_src_added = false;
+        for ( int i = 0; i < ret; i++ ) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+
+            if ( (flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0 ) {
+                std::map<int, IOSource*>::const_iterator it = fd_map.find(fd);
+                if ( it != fd_map.end() ) {
+                    ready->push_back({it->second, fd, IOSource::ProcessFlags::READ});
+                    timeout_src_added |= it->second == timeout_src;
+                }
+            }
+
+            if ( (flags & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0 ) {
+                std::map<int, IOSource*>::const_iterator it = write_fd_map.find(fd);
+                if ( it != write_fd_map.end() ) {
+                    ready->push_back({it->second, fd, IOSource::ProcessFlags::WRITE});
+                    timeout_src_added |= it->second == timeout_src;
+                }
+            }
+        }
+
+        // A timeout_src with a zero timeout can be considered ready.
+        if ( timeout_src && timeout == 0.0 && ! timeout_src_added )
+            ready->push_back({timeout_src, -1, 0});
+    }
+}
+#else
 void Manager::Poll(ReadySources* ready, double timeout, IOSource* timeout_src) {
     struct timespec kqueue_timeout;
     ConvertTimeout(timeout, kqueue_timeout);
@@ -231,6 +297,7 @@ void Manager::Poll(ReadySources* ready, double timeout, IOSource* timeout_src) {
             ready->push_back({timeout_src, -1, 0});
     }
 }
+#endif
 
 void Manager::ConvertTimeout(double timeout, struct timespec& spec) {
     // If timeout ended up -1, set it to some nominal value just to keep the loop
@@ -246,6 +313,84 @@ void Manager::ConvertTimeout(double timeout, struct timespec& spec) {
     }
 }
 
+#ifdef USE_EPOLL
+static uint32_t epoll_flags(bool read, bool write) { return (read ? EPOLLIN : 0) | (write ? EPOLLOUT : 0); }
+
+bool Manager::RegisterFd(int fd, IOSource* src, int flags) {
+    bool have_read = fd_map.count(fd) != 0;
+    bool have_write = write_fd_map.count(fd) != 0;
+    bool want_read = have_read || (flags & IOSource::READ) != 0;
+    bool want_write = have_write || (flags & IOSource::WRITE) != 0;
+
+    if ( want_read == have_read && want_write == have_write )
+        return true;
+
+    struct epoll_event ev = {};
+    ev.events = epoll_flags(want_read, want_write);
+    ev.data.fd = fd;
+
+    bool added = ! have_read && ! have_write;
+    int ret = epoll_ctl(event_queue, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &ev);
+
+    // The kernel may still know about a file descriptor whose removal
+    // failed in UnregisterFd().
+    if ( ret == -1 && added && errno == EEXIST )
+        ret = epoll_ctl(event_queue, EPOLL_CTL_MOD, fd, &ev);
+
+    if ( ret == -1 ) {
+        reporter->Error("Failed to register fd %d from %s: %s (flags %d)", fd, src->Tag(), strerror(errno), flags);
+        return false;
+    }
+
+    DBG_LOG(DBG_MAINLOOP, "Registered fd %d from %s", fd, src->Tag());
+    if ( added )
+        events.push_back({});
+
+    if ( (flags & IOSource::READ) != 0 )
+        fd_map[fd] = src;
+    if ( (flags & IOSource::WRITE) != 0 )
+        write_fd_map[fd] = src;
+
+    Wakeup("RegisterFd");
+    return true;
+}
+
+bool Manager::UnregisterFd(int fd, IOSource* src, int flags) {
+    bool have_read = fd_map.count(fd) != 0;
+    bool have_write = write_fd_map.count(fd) != 0;
+    bool want_read = have_read && (flags & IOSource::READ) == 0;
+    bool want_write = have_write && (flags & IOSource::WRITE) == 0;
+
+    if ( want_read == have_read && want_write == have_write ) {
+        reporter->Error("Attempted to unregister an unknown file descriptor %d from %s", fd, src->Tag());
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = epoll_flags(want_read, want_write);
+    ev.data.fd = fd;
+
+    bool removed = ! want_read && ! want_write;
+
+    // We don't care about failure here. If it failed to unregister, it's likely because
+    // the file descriptor was already closed, and epoll already automatically removed
+    // it. Update our own state regardless so that the descriptor number can be
+    // registered again.
+    epoll_ctl(event_queue, removed ? EPOLL_CTL_DEL : EPOLL_CTL_MOD, fd, &ev);
+
+    DBG_LOG(DBG_MAINLOOP, "Unregistered fd %d from %s", fd, src->Tag());
+    if ( removed )
+        events.pop_back();
+
+    if ( (flags & IOSource::READ) != 0 )
+        fd_map.erase(fd);
+    if ( (flags & IOSource::WRITE) != 0 )
+        write_fd_map.erase(fd);
+
+    Wakeup("UnregisterFd");
+    return true;
+}
+#else
 bool Manager::RegisterFd(int fd, IOSource* src, int flags) {
     std::vector<struct kevent> new_events;
 
@@ -329,6 +474,7 @@ bool Manager::UnregisterFd(int fd, IOSource* src, int flags) {
 
     return true;
 }
+#endif
 
 void Manager::Register(IOSource* src, bool dont_count, bool manage_lifetime) {
     // First see if we already have registered that source. If so, just
@@ -12,7 +12,11 @@
 #include "zeek/iosource/IOSource.h"
 
 struct timespec;
+#ifdef USE_EPOLL
+struct epoll_event;
+#else
 struct kevent;
+#endif
 
 namespace zeek {
 namespace iosource {
@@ -168,7 +172,7 @@ private:
 
     /**
      * Converts a double timeout value into a timespec struct used for calls
-     * to kevent().
+     * to kevent() or epoll_wait().
      */
     void ConvertTimeout(double timeout, struct timespec& spec);
 
@@ -232,9 +236,16 @@ private:
     std::map<int, IOSource*> fd_map;
     std::map<int, IOSource*> write_fd_map;
 
+#ifdef USE_EPOLL
+    // This is only used for the output of the call to epoll_wait() in
+    // FindReadySources(). It holds one entry per registered file descriptor,
+    // plus one since epoll_wait() needs room for at least one event.
+    std::vector<struct epoll_event> events;
+#else
     // This is only used for the output of the call to kqueue in FindReadySources().
     // The actual events are stored as part of the queue.
     std::vector<struct kevent> events;
+#endif
 };
 
 } // namespace iosource
@@ -19,6 +19,7 @@
 #include "zeek/Timer.h"
 #include "zeek/Type.h"
 #include "zeek/broker/Manager.h"
+#include "zeek/logging/RecordBatch.h"
 #include "zeek/logging/WriterBackend.h"
 #include "zeek/logging/WriterFrontend.h"
 #include "zeek/logging/logging.bif.h"
@@ -474,6 +475,9 @@ void Manager::Stream::DispatchDelayExpiredTimer(double t, bool is_expire) {
         ScheduleLogDelayExpiredTimer(delay_queue.front()->ExpireTime());
 }
 
+// Bucket bounds in seconds.
+static constexpr double log_writer_queue_latency_bounds[] = {0.0001, 0.001, 0.01, 0.1, 1.0, 10.0};
+
 Manager::Manager()
     : plugin::ComponentManager<logging::Component>("Log", "Writer"),
       total_log_stream_writes_family(telemetry_mgr->CounterFamily("zeek", "log-stream-writes", {"module", "stream"},
@@ -482,7 +486,12 @@ Manager::Manager()
           telemetry_mgr
               ->CounterFamily("zeek", "log-writer-writes", {"writer", "module", "stream", "filter-name", "path"},
                               "Total number of log writes passed to a concrete log writer not vetoed by stream or "
-                              "filter policies.")) {
+                              "filter policies.")),
+      log_writer_queue_latency_family(
+          telemetry_mgr->HistogramFamily("zeek", "log-writer-queue-latency", {"writer", "path"},
+                                         log_writer_queue_latency_bounds,
+                                         "Time batches of log writes wait until a log writer processes them.",
+                                         "seconds")) {
     rotations_pending = 0;
 }
 
@@ -1146,6 +1155,21 @@ bool Manager::WriteToFilters(const Manager::Stream* stream, zeek::RecordValPtr c
         assert(writer);
 
         // Alright, can do the write now.
+        //
+        // Without remote logging and log write hooks, nobody needs the
+        // record as a whole, so fill the writer's columnar write buffer
+        // directly.
+        if ( ! writer->remote && ! zeek::plugin_mgr->HavePluginForHook(zeek::plugin::HOOK_LOG_WRITE) ) {
+            if ( RecordToBatch(filter, columns.get(), writer) )
+                w->second->total_writes->Inc();
+
+#ifdef DEBUG
+            DBG_LOG(DBG_LOGGING, "Wrote record to filter '%s' on stream '%s'", filter->name.c_str(),
+                    stream->name.c_str());
+#endif
+            continue;
+        }
+
         auto rec = RecordToLogRecord(stream, filter, columns.get());
 
         if ( zeek::plugin_mgr->HavePluginForHook(zeek::plugin::HOOK_LOG_WRITE) ) {
@@ -1516,60 +1540,178 @@ threading::Value Manager::ValToLogVal(std::optional<ZVal>& val, Type* ty) {
     return lval;
 }
 
-detail::LogRecord Manager::RecordToLogRecord(const Stream* stream, Filter* filter, RecordVal* columns) {
-    RecordValPtr ext_rec;
+RecordValPtr Manager::InvokeExtFunc(Filter* filter) {
+    if ( filter->num_ext_fields == 0 )
+        return nullptr;
 
-    if ( filter->num_ext_fields > 0 ) {
-        auto res = filter->ext_func->Invoke(IntrusivePtr{NewRef{}, filter->path_val});
+    auto res = filter->ext_func->Invoke(IntrusivePtr{NewRef{}, filter->path_val});
 
-        if ( res )
-            ext_rec = {AdoptRef{}, res.release()->AsRecordVal()};
+    if ( ! res )
+        return nullptr;
+
+    return {AdoptRef{}, res.release()->AsRecordVal()};
+}
+
+std::optional<ZVal> Manager::LookupField(Filter* filter, int i, RecordVal* columns, RecordVal* ext_rec, Type*& vt) {
+    std::optional<ZVal> val;
+
+    if ( i < filter->num_ext_fields ) {
+        if ( ! ext_rec )
+            // executing function did not return record. Send empty for all vals.
+            return std::nullopt;
+
+        val = ZVal(ext_rec);
+        vt = ext_rec->GetType().get();
+    }
+    else {
+        val = ZVal(columns);
+        vt = columns->GetType().get();
     }
 
+    // For each field, first find the right value, which can
+    // potentially be nested inside other records.
+    list<int>& indices = filter->indices[i];
+
+    for ( list<int>::iterator j = indices.begin(); j != indices.end(); ++j ) {
+        auto vr = val->AsRecord();
+        val = vr->RawOptField(*j);
+
+        if ( ! val )
+            // Value, or any of its parents, is not set.
+            return std::nullopt;
+
+        vt = cast_intrusive<RecordType>(vr->GetType())->GetFieldType(*j).get();
+    }
+
+    return val;
+}
+
+detail::LogRecord Manager::RecordToLogRecord(const Stream* stream, Filter* filter, RecordVal* columns) {
+    RecordValPtr ext_rec = InvokeExtFunc(filter);
+
     // Allocate storage for all vals.
     detail::LogRecord vals;
     vals.reserve(filter->num_fields);
 
     for ( int i = 0; i < filter->num_fields; ++i ) {
-        std::optional<ZVal> val;
-        Type* vt;
-        if ( i < filter->num_ext_fields ) {
-            if ( ! ext_rec ) {
-                // executing function did not return record. Send empty for all vals.
-                vals.emplace_back(filter->fields[i]->type, false);
-                continue;
+        Type* vt = nullptr;
+        auto val = LookupField(filter, i, columns, ext_rec.get(), vt);
+
+        if ( val )
+            vals.emplace_back(ValToLogVal(val, vt));
+        else
+            vals.emplace_back(filter->fields[i]->type, false);
+    }
+
+    return vals;
+}
+
+bool Manager::RecordToBatch(Filter* filter, RecordVal* columns, WriterFrontend* writer) {
+    // The extension function runs script code that may itself log to this
+    // writer, so invoke it before starting the row.
+    RecordValPtr ext_rec = InvokeExtFunc(filter);
+
+    auto batch = writer->BeginBatchWrite();
+
+    if ( ! batch )
+        return false;
+
+    for ( int i = 0; i < filter->num_fields; ++i ) {
+        Type* vt = nullptr;
+        auto val = LookupField(filter, i, columns, ext_rec.get(), vt);
+
+        // Fields start out unset.
+        if ( val )
+            ValToBatch(*batch, i, val, vt);
+    }
+
+    writer->EndBatchWrite();
+    return true;
+}
+
+void Manager::ValToBatch(detail::RecordBatch& batch, int col, std::optional<ZVal>& val, Type* ty) {
+    // Mirrors ValToLogVal(), but writes scalars and strings straight into
+    // the batch's columns.
+    switch ( ty->Tag() ) {
+        case TYPE_BOOL:
+        case TYPE_INT: batch.SetInt(col, val->AsInt()); break;
+
+        case TYPE_ENUM: {
+            const char* s = ty->AsEnumType()->Lookup(val->AsInt());
+
+            if ( s )
+                batch.SetString(col, s, strlen(s));
+
+            else {
+                auto err_msg = "enum type does not contain value:" + std::to_string(val->AsInt());
+                ty->Error(err_msg.c_str());
+                batch.SetString(col, "", 0);
             }
+            break;
+        }
+
+        case TYPE_COUNT: batch.SetCount(col, val->AsCount()); break;
+
+        case TYPE_PORT: {
+            auto p = val->AsCount();
 
-            val = ZVal(ext_rec.get());
-            vt = ext_rec->GetType().get();
+            auto pt = TRANSPORT_UNKNOWN;
+            auto pm = p & PORT_SPACE_MASK;
+            if ( pm == TCP_PORT_MASK )
+                pt = TRANSPORT_TCP;
+            else if ( pm == UDP_PORT_MASK )
+                pt = TRANSPORT_UDP;
+            else if ( pm == ICMP_PORT_MASK )
+                pt = TRANSPORT_ICMP;
+
+            batch.SetPort(col, p & ~PORT_SPACE_MASK, pt);
+            break;
         }
-        else {
-            val = ZVal(columns);
-            vt = columns->GetType().get();
+
+        case TYPE_SUBNET: {
+            threading::Value::subnet_t sn;
+            val->AsSubNet()->Get().ConvertToThreadingValue(&sn);
+            batch.SetSubnet(col, sn);
+            break;
         }
 
-        // For each field, first find the right value, which can
-        // potentially be nested inside other records.
-        list<int>& indices = filter->indices[i];
+        case TYPE_ADDR: {
+            threading::Value::addr_t a;
+            val->AsAddr()->Get().ConvertToThreadingValue(&a);
+            batch.SetAddr(col, a);
+            break;
+        }
 
-        for ( list<int>::iterator j = indices.begin(); j != indices.end(); ++j ) {
-            auto vr = val->AsRecord();
-            val = vr->RawOptField(*j);
+        case TYPE_DOUBLE:
+        case TYPE_TIME:
+        case TYPE_INTERVAL: batch.SetDouble(col, val->AsDouble()); break;
 
-            if ( ! val ) {
-                // Value, or any of its parents, is not set.
-                vals.emplace_back(filter->fields[i]->type, false);
-                break;
-            }
+        case TYPE_STRING: {
+            const String* s = val->AsString()->AsString();
+            batch.SetString(col, reinterpret_cast<const char*>(s->Bytes()), s->Len());
+            break;
+        }
 
-            vt = cast_intrusive<RecordType>(vr->GetType())->GetFieldType(*j).get();
+        case TYPE_FILE: {
+            const char* s = val->AsFile()->Name();
+            batch.SetString(col, s, strlen(s));
+            break;
         }
 
-        if ( val )
-            vals.emplace_back(ValToLogVal(val, vt));
-    }
+        case TYPE_FUNC: {
+            ODesc d;
+            val->AsFunc()->Describe(&d);
+            const char* s = d.Description();
+            batch.SetString(col, s, strlen(s));
+            break;
+        }
 
-    return vals;
+        default:
+            // Sets, vectors and anything unexpected go through the
+            // generic conversion.
+            batch.SetValue(col, ValToLogVal(val, ty));
+            break;
+    }
 }
 
 bool Manager::CreateWriterForRemoteLog(EnumVal* id, EnumVal* writer, WriterBackend::WriterInfo* info, int num_fields,
@@ -1766,6 +1908,59 @@ bool Manager::WriteFromRemote(EnumVal* id, EnumVal* writer, const string& path,
     return true;
 }
 
+bool Manager::WritesFromRemote(const detail::LogWriteHeader& header, std::vector<detail::LogRecord>&& records) {
+    if ( ! header.stream_id || ! header.writer_id )
+        return false;
+
+    Stream* stream = FindStream(header.stream_id.get());
+
+    if ( ! stream ) {
+        DBG_LOG(DBG_LOGGING, "unknown stream %s in Manager::WritesFromRemote()", header.stream_name.c_str());
+        return false;
+    }
+
+    if ( ! stream->enabled )
+        return true;
+
+    auto w = stream->writers.find(Stream::WriterPathPair(header.writer_id->AsEnum(), header.path));
+    WriterFrontend* writer = nullptr;
+
+    if ( w != stream->writers.end() )
+        writer = w->second->writer;
+    else {
+        int num_fields = static_cast<int>(header.fields.size());
+        auto** fields = new threading::Field*[num_fields];
+
+        for ( int i = 0; i < num_fields; ++i )
+            fields[i] = new threading::Field(header.fields[i]);
+
+        auto* info = new WriterBackend::WriterInfo;
+        info->path = util::copy_string(header.path.c_str(), header.path.size());
+        info->network_time = run_state::network_time;
+
+        writer = CreateWriter(header.stream_id.get(), header.writer_id.get(), info, num_fields, fields, true, false,
+                              true);
+
+        if ( ! writer )
+            return false;
+    }
+
+    for ( auto& rec : records ) {
+        if ( rec.size() != static_cast<size_t>(writer->NumFields()) ) {
+            reporter->Warning("dropping remote log record for %s with %zu fields, expected %d", header.path.c_str(),
+                              rec.size(), writer->NumFields());
+            continue;
+        }
+
+        writer->Write(std::move(rec));
+    }
+
+    DBG_LOG(DBG_LOGGING, "Wrote %zu pre-filtered records to path '%s' on stream '%s'", records.size(),
+            header.path.c_str(), stream->name.c_str());
+
+    return true;
+}
+
 void Manager::SendAllWritersTo(const broker::endpoint_info& ei) {
     auto et = id::find_type("Log::Writer")->AsEnumType();
 
@@ -287,6 +287,22 @@ public:
      */
     bool WriteFromRemote(EnumVal* id, EnumVal* writer, const std::string& path, detail::LogRecord&& rec);
 
+    /**
+     * Writes out a batch of log entries received from a remote node through
+     * a cluster backend.
+     *
+     * Unlike WriteFromRemote(), this creates a writer for the header's
+     * stream, writer and path if none exists yet, using the header's fields
+     * as the schema.
+     *
+     * @param header The header describing the sending writer frontend.
+     *
+     * @param records The log records to write.
+     *
+     * @return Returns true if the batch was processed successfully.
+     */
+    bool WritesFromRemote(const detail::LogWriteHeader& header, std::vector<detail::LogRecord>&& records);
+
     /**
      * Announces all instantiated writers to a given Broker peer.
      */
@@ -401,6 +417,16 @@ private:
     detail::LogRecord RecordToLogRecord(const Stream* stream, Filter* filter, RecordVal* columns);
     threading::Value ValToLogVal(std::optional<ZVal>& val, Type* ty);
 
+    // Fills a row of the writer's columnar write buffer directly from the
+    // record, bypassing the intermediary LogRecord. Returns false if the
+    // writer didn't accept the row.
+    bool RecordToBatch(Filter* filter, RecordVal* columns, WriterFrontend* writer);
+    void ValToBatch(detail::RecordBatch& batch, int col, std::optional<ZVal>& val, Type* ty);
+
+    // Helpers shared by RecordToLogRecord() and RecordToBatch().
+    RecordValPtr InvokeExtFunc(Filter* filter);
+    std::optional<ZVal> LookupField(Filter* filter, int i, RecordVal* columns, RecordVal* ext_rec, Type*& vt);
+
     Stream* FindStream(EnumVal* id);
     void RemoveDisabledWriters(Stream* stream);
     void InstallRotationTimer(WriterInfo* winfo);
@@ -427,6 +453,7 @@ private:
 
     std::shared_ptr<telemetry::CounterFamily> total_log_stream_writes_family;
     std::shared_ptr<telemetry::CounterFamily> total_log_writer_writes_family;
+    std::shared_ptr<telemetry::HistogramFamily> log_writer_queue_latency_family;
 
     zeek_uint_t last_delay_token = 0;
     std::vector<detail::WriteContext> active_writes;
@@ -0,0 +1,253 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/logging/RecordBatch.h"
+
+#include "zeek/3rdparty/doctest.h"
+
+using zeek::threading::Value;
+
+namespace zeek::logging::detail {
+
+RecordBatch::RecordBatch(int num_fields, const threading::Field* const* fields, size_t capacity) {
+    columns.resize(num_fields);
+
+    for ( int i = 0; i < num_fields; ++i ) {
+        auto& c = columns[i];
+        c.type = fields[i]->type;
+        c.present.reserve(capacity);
+        c.slots.reserve(capacity);
+    }
+}
+
+void RecordBatch::BeginRow() {
+    for ( auto& c : columns ) {
+        c.present.emplace_back(0);
+        c.slots.emplace_back();
+    }
+
+    row_blob_size = blob.size();
+    row_composites_size = composites.size();
+}
+
+void RecordBatch::AbortRow() {
+    for ( auto& c : columns ) {
+        c.present.pop_back();
+        c.slots.pop_back();
+    }
+
+    blob.resize(row_blob_size);
+
+    while ( composites.size() > row_composites_size )
+        composites.pop_back();
+}
+
+void RecordBatch::SetPort(int col, zeek_uint_t port, TransportProto proto) {
+    auto& s = Current(col);
+    s.port_val.port = port;
+    s.port_val.proto = proto;
+}
+
+void RecordBatch::SetString(int col, const char* data, size_t len) {
+    auto& s = Current(col);
+    s.string_val.offset = blob.size();
+    s.string_val.length = len;
+
+    // Strings are NUL terminated within the blob so that writers treating
+    // enum names as C strings keep working.
+    blob.insert(blob.end(), data, data + len);
+    blob.emplace_back('\0');
+}
+
+void RecordBatch::SetValue(int col, Value&& v) {
+    if ( ! v.present )
+        return;
+
+    switch ( v.type ) {
+        case TYPE_BOOL:
+        case TYPE_INT: SetInt(col, v.val.int_val); break;
+
+        case TYPE_COUNT: SetCount(col, v.val.uint_val); break;
+
+        case TYPE_DOUBLE:
+        case TYPE_TIME:
+        case TYPE_INTERVAL: SetDouble(col, v.val.double_val); break;
+
+        case TYPE_PORT: SetPort(col, v.val.port_val.port, v.val.port_val.proto); break;
+
+        case TYPE_ADDR: SetAddr(col, v.val.addr_val); break;
+
+        case TYPE_SUBNET: SetSubnet(col, v.val.subnet_val); break;
+
+        case TYPE_ENUM:
+        case TYPE_STRING:
+        case TYPE_FILE:
+        case TYPE_FUNC: SetString(col, v.val.string_val.data, v.val.string_val.length); break;
+
+        default:
+            Current(col).composite_idx = composites.size();
+            composites.emplace_back(std::move(v));
+            break;
+    }
+}
+
+bool RecordBatch::AppendRecord(LogRecord&& rec) {
+    if ( rec.size() != columns.size() )
+        return false;
+
+    BeginRow();
+
+    for ( size_t i = 0; i < rec.size(); ++i ) {
+        if ( rec[i].type != columns[i].type ) {
+            AbortRow();
+            return false;
+        }
+
+        SetValue(static_cast<int>(i), std::move(rec[i]));
+    }
+
+    CommitRow();
+    return true;
+}
+
+std::string_view RecordBatch::String(size_t row, int col) const {
+    const auto& s = columns[col].slots[row].string_val;
+    return {blob.data() + s.offset, s.length};
+}
+
+const Value& RecordBatch::Composite(size_t row, int col) const {
+    return composites[columns[col].slots[row].composite_idx];
+}
+
+RecordBatch::RowView::RowView(const RecordBatch& arg_batch) : batch(arg_batch) {
+    vals.reserve(batch.columns.size());
+    ptrs.reserve(batch.columns.size());
+
+    for ( const auto& c : batch.columns ) {
+        vals.emplace_back(c.type, false);
+        ptrs.emplace_back(&vals.back());
+    }
+}
+
+RecordBatch::RowView::~RowView() { Release(); }
+
+void RecordBatch::RowView::Release() {
+    // The values only borrow the batch's storage, make sure their
+    // destructors don't free it.
+    for ( auto& v : vals ) {
+        v.val = Value::_val();
+        v.subtype = TYPE_VOID;
+        v.present = false;
+    }
+}
+
+Value** RecordBatch::RowView::Load(size_t row) {
+    Release();
+
+    for ( size_t i = 0; i < vals.size(); ++i ) {
+        int col = static_cast<int>(i);
+        auto& v = vals[i];
+
+        if ( ! batch.IsPresent(row, col) )
+            continue;
+
+        v.present = true;
+
+        const auto& s = batch.columns[i].slots[row];
+
+        switch ( v.type ) {
+            case TYPE_BOOL:
+            case TYPE_INT: v.val.int_val = s.int_val; break;
+
+            case TYPE_COUNT: v.val.uint_val = s.uint_val; break;
+
+            case TYPE_DOUBLE:
+            case TYPE_TIME:
+            case TYPE_INTERVAL: v.val.double_val = s.double_val; break;
+
+            case TYPE_PORT: v.val.port_val = s.port_val; break;
+
+            case TYPE_ADDR: v.val.addr_val = s.addr_val; break;
+
+            case TYPE_SUBNET: v.val.subnet_val = s.subnet_val; break;
+
+            case TYPE_ENUM:
+            case TYPE_STRING:
+            case TYPE_FILE:
+            case TYPE_FUNC:
+                v.val.string_val.data = const_cast<char*>(batch.blob.data()) + s.string_val.offset;
+                v.val.string_val.length = static_cast<int>(s.string_val.length);
+                break;
+
+            default: {
+                const auto& c = batch.composites[s.composite_idx];
+                v.subtype = c.subtype;
+                v.val = c.val;
+                break;
+            }
+        }
+    }
+
+    return ptrs.data();
+}
+
+TEST_SUITE_BEGIN("logging RecordBatch");
+
+TEST_CASE("append and view rows") {
+    threading::Field f0("s", nullptr, TYPE_STRING, TYPE_VOID, true);
+    threading::Field f1("c", nullptr, TYPE_COUNT, TYPE_VOID, false);
+    const threading::Field* fields[] = {&f0, &f1};
+
+    RecordBatch batch(2, fields, 4);
+
+    batch.BeginRow();
+    batch.SetString(0, "abc", 3);
+    batch.SetCount(1, 42);
+    batch.CommitRow();
+
+    batch.BeginRow();
+    batch.SetCount(1, 43);
+    batch.CommitRow();
+
+    batch.BeginRow();
+    batch.SetString(0, "discarded", 9);
+    batch.AbortRow();
+
+    REQUIRE(batch.Rows() == 2);
+    CHECK(batch.String(0, 0) == "abc");
+    CHECK(batch.Count(0, 1) == 42);
+    CHECK_FALSE(batch.IsPresent(1, 0));
+    CHECK(batch.Count(1, 1) == 43);
+
+    RecordBatch::RowView view(batch);
+    auto vals = view.Load(0);
+    CHECK(vals[0]->present);
+    CHECK(std::string(vals[0]->val.string_val.data, vals[0]->val.string_val.length) == "abc");
+    CHECK(vals[1]->val.uint_val == 42);
+
+    vals = view.Load(1);
+    CHECK_FALSE(vals[0]->present);
+    CHECK(vals[1]->val.uint_val == 43);
+}
+
+TEST_CASE("append record with mismatched type") {
+    threading::Field f0("c", nullptr, TYPE_COUNT, TYPE_VOID, false);
+    const threading::Field* fields[] = {&f0};
+
+    RecordBatch batch(1, fields, 1);
+
+    LogRecord good;
+    good.emplace_back(TYPE_COUNT);
+    good[0].val.uint_val = 1;
+    CHECK(batch.AppendRecord(std::move(good)));
+
+    LogRecord bad;
+    bad.emplace_back(TYPE_INT);
+    CHECK_FALSE(batch.AppendRecord(std::move(bad)));
+
+    CHECK(batch.Rows() == 1);
+    CHECK(batch.Count(0, 0) == 1);
+}
+
+TEST_SUITE_END();
+
+} // namespace zeek::logging::detail
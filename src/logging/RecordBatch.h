@@ -0,0 +1,200 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "zeek/logging/Types.h"
+#include "zeek/threading/SerialTypes.h"
+
+namespace zeek::logging::detail {
+
+/**
+ * A columnar batch of log records passed from a \a WriterFrontend to its
+ * \a WriterBackend.
+ *
+ * Instead of a vector of heap-allocated threading::Value instances per
+ * record, a batch keeps one typed column array per log field and a single
+ * blob holding the bytes of all string-like values (strings, enums, files
+ * and funcs). Composite values (sets and vectors) are rare in logs and are
+ * kept as owned threading::Value instances in a side array.
+ *
+ * A batch is filled row by row, either directly from a script-level record
+ * by the logging::Manager or by appending a \a LogRecord. Writers consume it
+ * through WriterBackend::DoWriteBatch().
+ */
+class RecordBatch {
+public:
+    /**
+     * Constructor.
+     *
+     * @param num_fields The number of log fields.
+     *
+     * @param fields The log fields, determining the column types. The
+     * batch does not take ownership.
+     *
+     * @param capacity The number of rows to reserve space for.
+     */
+    RecordBatch(int num_fields, const threading::Field* const* fields, size_t capacity);
+
+    RecordBatch(const RecordBatch&) = delete;
+    RecordBatch& operator=(const RecordBatch&) = delete;
+
+    /**
+     * @return The number of columns in this batch.
+     */
+    int NumFields() const { return static_cast<int>(columns.size()); }
+
+    /**
+     * @return The number of committed rows in this batch.
+     */
+    size_t Rows() const { return rows; }
+
+    /**
+     * @return True if no rows have been committed.
+     */
+    bool Empty() const { return rows == 0; }
+
+    /**
+     * @return The type of the given column.
+     */
+    TypeTag Type(int col) const { return columns[col].type; }
+
+    /**
+     * Starts a new row. All of its fields are initially unset. Must be
+     * followed by either CommitRow() or AbortRow().
+     */
+    void BeginRow();
+
+    /**
+     * Makes the row started by BeginRow() visible to consumers.
+     */
+    void CommitRow() { ++rows; }
+
+    /**
+     * Discards the row started by BeginRow(), including any string or
+     * composite storage it used.
+     */
+    void AbortRow();
+
+    /**
+     * Setters for the fields of the current row. The caller is
+     * responsible for picking the setter matching the column's type.
+     */
+    void SetInt(int col, zeek_int_t v) { Current(col).int_val = v; }
+    void SetCount(int col, zeek_uint_t v) { Current(col).uint_val = v; }
+    void SetDouble(int col, double v) { Current(col).double_val = v; }
+    void SetPort(int col, zeek_uint_t port, TransportProto proto);
+    void SetAddr(int col, const threading::Value::addr_t& v) { Current(col).addr_val = v; }
+    void SetSubnet(int col, const threading::Value::subnet_t& v) { Current(col).subnet_val = v; }
+    void SetString(int col, const char* data, size_t len);
+
+    /**
+     * Sets a field of the current row from a threading::Value. Scalars
+     * and strings are copied into the batch's columns, composite values
+     * are moved into the batch. Unset values leave the field unset.
+     */
+    void SetValue(int col, threading::Value&& v);
+
+    /**
+     * Appends a complete log record as a new row.
+     *
+     * @return False if the record's size or field types don't match the
+     * batch's columns. The record is not added in that case.
+     */
+    bool AppendRecord(LogRecord&& rec);
+
+    /**
+     * Accessors for committed rows. As with the setters, the caller is
+     * responsible for using the accessor matching the column's type.
+     */
+    bool IsPresent(size_t row, int col) const { return columns[col].present[row]; }
+    zeek_int_t Int(size_t row, int col) const { return columns[col].slots[row].int_val; }
+    zeek_uint_t Count(size_t row, int col) const { return columns[col].slots[row].uint_val; }
+    double Double(size_t row, int col) const { return columns[col].slots[row].double_val; }
+    const threading::Value::port_t& Port(size_t row, int col) const { return columns[col].slots[row].port_val; }
+    const threading::Value::addr_t& Addr(size_t row, int col) const { return columns[col].slots[row].addr_val; }
+    const threading::Value::subnet_t& Subnet(size_t row, int col) const { return columns[col].slots[row].subnet_val; }
+    std::string_view String(size_t row, int col) const;
+    const threading::Value& Composite(size_t row, int col) const;
+
+    /**
+     * Presents rows of a batch as an array of threading::Value pointers
+     * for writers implementing only WriterBackend::DoWrite(). The values
+     * reference the batch's storage and are only valid until the next
+     * call to Load() or until the view is destroyed.
+     */
+    class RowView {
+    public:
+        explicit RowView(const RecordBatch& batch);
+        ~RowView();
+
+        RowView(const RowView&) = delete;
+        RowView& operator=(const RowView&) = delete;
+
+        /**
+         * Populates the view with the given row.
+         *
+         * @return An array of NumFields() values.
+         */
+        threading::Value** Load(size_t row);
+
+    private:
+        void Release();
+
+        const RecordBatch& batch;
+        std::vector<threading::Value> vals;
+        std::vector<threading::Value*> ptrs;
+    };
+
+private:
+    // Storage for one field of one row. String-like values are stored as
+    // a range into the blob, composite values as an index into composites.
+    union Slot {
+        zeek_int_t int_val;
+        zeek_uint_t uint_val;
+        double double_val;
+        threading::Value::port_t port_val;
+        threading::Value::addr_t addr_val;
+        threading::Value::subnet_t subnet_val;
+
+        struct {
+            uint32_t offset;
+            uint32_t length;
+        } string_val;
+
+        size_t composite_idx;
+
+        Slot() { memset(this, 0, sizeof(Slot)); }
+    };
+
+    struct Column {
+        TypeTag type;
+        std::vector<uint8_t> present;
+        std::vector<Slot> slots;
+    };
+
+    Slot& Current(int col) {
+        auto& c = columns[col];
+        c.present.back() = 1;
+        return c.slots.back();
+    }
+
+    static bool IsStringType(TypeTag t) {
+        return t == TYPE_STRING || t == TYPE_ENUM || t == TYPE_FILE || t == TYPE_FUNC;
+    }
+
+    std::vector<Column> columns;
+    std::vector<char> blob;
+    std::vector<threading::Value> composites;
+    size_t rows = 0;
+
+    // State at BeginRow() for AbortRow().
+    size_t row_blob_size = 0;
+    size_t row_composites_size = 0;
+};
+
+} // namespace zeek::logging::detail
@@ -5,6 +5,7 @@
 #include <broker/data.hh>
 
 #include "zeek/logging/Manager.h"
+#include "zeek/logging/RecordBatch.h"
 #include "zeek/logging/WriterFrontend.h"
 #include "zeek/threading/SerialTypes.h"
 #include "zeek/util.h"
@@ -232,6 +233,57 @@ bool WriterBackend::Write(int arg_num_fields, zeek::Span<detail::LogRecord> reco
     return success;
 }
 
+bool WriterBackend::Write(int arg_num_fields, const detail::RecordBatch& batch) {
+    // Double-check that the arguments match. If we get this from remote,
+    // something might be mixed up.
+    if ( num_fields != arg_num_fields || num_fields != batch.NumFields() ) {
+#ifdef DEBUG
+        const char* msg =
+            Fmt("Number of fields don't match in WriterBackend::Write() (%d vs. %d)", arg_num_fields, num_fields);
+        Debug(DBG_LOGGING, msg);
+#endif
+
+        DisableFrontend();
+        return false;
+    }
+
+    // Double-check all the types match. The batch's columns are typed,
+    // so this only needs to happen once per batch.
+    for ( int i = 0; i < num_fields; ++i ) {
+        if ( batch.Type(i) != fields[i]->type ) {
+#ifdef DEBUG
+            const char* msg = Fmt("Field #%d type doesn't match in WriterBackend::Write() (%d vs. %d)", i,
+                                  batch.Type(i), fields[i]->type);
+            Debug(DBG_LOGGING, msg);
+#endif
+            DisableFrontend();
+            return false;
+        }
+    }
+
+    bool success = true;
+
+    if ( ! Failed() )
+        success = DoWriteBatch(num_fields, fields, batch);
+
+    if ( ! success )
+        DisableFrontend();
+
+    return success;
+}
+
+bool WriterBackend::DoWriteBatch(int num_fields, const threading::Field* const* fields,
+                                 const detail::RecordBatch& batch) {
+    detail::RecordBatch::RowView view(batch);
+
+    for ( size_t j = 0; j < batch.Rows(); j++ ) {
+        if ( ! DoWrite(num_fields, fields, view.Load(j)) )
+            return false;
+    }
+
+    return true;
+}
+
 bool WriterBackend::SetBuf(bool enabled) {
     if ( enabled == buffering )
         // No change.
@@ -18,7 +18,9 @@ namespace detail {
 
 using LogRecord = std::vector<threading::Value>;
 
-}
+class RecordBatch;
+
+} // namespace detail
 
 class WriterFrontend;
 
@@ -153,8 +155,21 @@ public:
      *
      * @return False if an error occurred.
      */
+    [[deprecated("Remove in v8.1. Use the RecordBatch version instead.")]]
     bool Write(int arg_num_fields, zeek::Span<detail::LogRecord> records);
 
+    /**
+     * Write a columnar batch of log records.
+     *
+     * @param num_fields: The number of log fields for this stream. The
+     * value must match what was passed to Init().
+     *
+     * @param batch The records to write out.
+     *
+     * @return False if an error occurred.
+     */
+    bool Write(int arg_num_fields, const detail::RecordBatch& batch);
+
     /**
      * Sets the buffering status for the writer, assuming the writer
      * supports that. (If not, it will be ignored).
@@ -283,6 +298,19 @@ protected:
      */
     virtual bool DoWrite(int num_fields, const threading::Field* const* fields, threading::Value** vals) = 0;
 
+    /**
+     * Writer-specific output method implementing recording of a batch of
+     * log entries.
+     *
+     * Writers may override this method to consume the columnar batch
+     * directly. The default implementation presents each row as an array
+     * of threading::Value pointers referencing the batch's storage and
+     * passes it to DoWrite().
+     *
+     * The same error semantics as for DoWrite() apply.
+     */
+    virtual bool DoWriteBatch(int num_fields, const threading::Field* const* fields, const detail::RecordBatch& batch);
+
     /**
      * Writer-specific method implementing a change of the buffering
      * state.  If buffering is disabled, the writer should attempt to
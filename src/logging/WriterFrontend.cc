@@ -1,8 +1,8 @@
 #include "zeek/logging/WriterFrontend.h"
 
 #include "zeek/RunState.h"
-#include "zeek/Span.h"
 #include "zeek/broker/Manager.h"
+#include "zeek/cluster/Backend.h"
 #include "zeek/logging/Manager.h"
 #include "zeek/logging/WriterBackend.h"
 #include "zeek/threading/SerialTypes.h"
@@ -51,16 +51,26 @@ private:
 
 class WriteMessage final : public threading::InputMessage<WriterBackend> {
 public:
-    WriteMessage(WriterBackend* backend, int num_fields, std::vector<detail::LogRecord>&& records)
+    WriteMessage(WriterBackend* backend, int num_fields, std::unique_ptr<detail::RecordBatch> batch,
+                 telemetry::HistogramPtr queue_latency)
         : threading::InputMessage<WriterBackend>("Write", backend),
           num_fields(num_fields),
-          records(std::move(records)) {}
+          batch(std::move(batch)),
+          queue_latency(std::move(queue_latency)),
+          queued(util::current_time(true)) {}
 
-    bool Process() override { return Object()->Write(num_fields, zeek::Span{records}); }
+    bool Process() override {
+        if ( queue_latency )
+            queue_latency->Observe(util::current_time(true) - queued);
+
+        return Object()->Write(num_fields, *batch);
+    }
 
 private:
     int num_fields;
-    std::vector<detail::LogRecord> records;
+    std::unique_ptr<detail::RecordBatch> batch;
+    telemetry::HistogramPtr queue_latency;
+    double queued;
 };
 
 class SetBufMessage final : public threading::InputMessage<WriterBackend> {
@@ -109,6 +119,7 @@ WriterFrontend::WriterFrontend(const WriterBackend::WriterInfo& arg_info, EnumVa
 
     if ( local ) {
         backend = log_mgr->CreateBackend(this, writer);
+        queue_latency = log_mgr->log_writer_queue_latency_family->GetOrAdd({{"writer", w}, {"path", arg_info.path}});
 
         if ( backend )
             backend->Start();
@@ -156,6 +167,8 @@ void WriterFrontend::Init(int arg_num_fields, const Field* const* arg_fields) {
 
     initialized = true;
 
+    write_buffer.Init(num_fields, fields);
+
     if ( backend ) {
         auto fs = new Field*[num_fields];
 
@@ -166,7 +179,20 @@ void WriterFrontend::Init(int arg_num_fields, const Field* const* arg_fields) {
     }
 
     if ( remote ) {
-        broker_mgr->PublishLogCreate(stream, writer, *info, arg_num_fields, arg_fields);
+        if ( cluster::backend == broker_mgr )
+            broker_mgr->PublishLogCreate(stream, writer, *info, arg_num_fields, arg_fields);
+        else {
+            // Other backends carry the schema in each batch's header and
+            // receivers create writers on demand.
+            remote_header = std::make_unique<detail::LogWriteHeader>(EnumValPtr{NewRef{}, stream},
+                                                                     EnumValPtr{NewRef{}, writer}, "", info->path);
+            remote_header->fields.reserve(num_fields);
+
+            for ( auto i = 0; i < num_fields; ++i )
+                remote_header->fields.emplace_back(*fields[i]);
+
+            remote_buffer.reserve(BifConst::Log::write_buffer_size);
+        }
     }
 }
 
@@ -182,30 +208,69 @@ void WriterFrontend::Write(detail::LogRecord&& arg_vals) {
         return;
     }
 
-    if ( remote ) {
+    if ( remote_header ) {
+        if ( backend )
+            remote_buffer.emplace_back(vals);
+        else
+            remote_buffer.emplace_back(std::move(vals));
+
+        if ( remote_buffer.size() >= BifConst::Log::write_buffer_size || ! buf || run_state::terminating )
+            FlushRemoteBuffer();
+    }
+    else if ( remote ) {
         broker_mgr->PublishLogWrite(stream, writer, info->path, vals);
     }
 
     if ( ! backend )
         return;
 
-    write_buffer.WriteRecord(std::move(vals));
+    if ( ! write_buffer.WriteRecord(std::move(vals)) ) {
+        reporter->Warning("WriterFrontend %s received write with mismatching field types. Skipping line.", name);
+        return;
+    }
 
     if ( write_buffer.Full() || ! buf || run_state::terminating )
         // Buffer full (or no buffering desired or terminating).
         FlushWriteBuffer();
 }
 
+detail::RecordBatch* WriterFrontend::BeginBatchWrite() {
+    if ( disabled || ! initialized || ! backend )
+        return nullptr;
+
+    auto& batch = write_buffer.CurrentBatch();
+    batch.BeginRow();
+    return &batch;
+}
+
+void WriterFrontend::EndBatchWrite() {
+    write_buffer.CurrentBatch().CommitRow();
+
+    if ( write_buffer.Full() || ! buf || run_state::terminating )
+        // Buffer full (or no buffering desired or terminating).
+        FlushWriteBuffer();
+}
+
+void WriterFrontend::FlushRemoteBuffer() {
+    if ( remote_buffer.empty() )
+        return;
+
+    cluster::backend->PublishLogWrites(*remote_header, remote_buffer);
+    remote_buffer.clear();
+}
+
 void WriterFrontend::FlushWriteBuffer() {
     if ( disabled )
         return;
 
+    FlushRemoteBuffer();
+
     if ( write_buffer.Empty() )
         // Nothing to do.
         return;
 
     if ( backend )
-        backend->SendIn(new WriteMessage(backend, num_fields, std::move(write_buffer).TakeRecords()));
+        backend->SendIn(new WriteMessage(backend, num_fields, std::move(write_buffer).TakeBatch(), queue_latency));
 }
 
 void WriterFrontend::SetBuf(bool enabled) {
@@ -2,7 +2,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
+
+#include "zeek/logging/RecordBatch.h"
 #include "zeek/logging/WriterBackend.h"
+#include "zeek/telemetry/Histogram.h"
 
 namespace zeek::logging {
 
@@ -15,6 +20,9 @@ namespace detail {
  * Implements a buffer accumulating log records in \a WriterFrontend instance
  * before passing them to \a WriterBackend instances.
  *
+ * Records are accumulated in a columnar \a RecordBatch, which is handed over
+ * to the backend as a whole.
+ *
  * \see WriterFrontend::Write
  */
 class WriteBuffer {
@@ -24,24 +32,48 @@ public:
      */
     explicit WriteBuffer(size_t buffer_size) : buffer_size(buffer_size) {}
 
+    /**
+     * Sets the schema of the records to buffer. Must be called before
+     * records are written.
+     *
+     * @param num_fields The number of log fields.
+     *
+     * @param fields The log fields. The buffer does not take ownership.
+     */
+    void Init(int arg_num_fields, const threading::Field* const* arg_fields) {
+        num_fields = arg_num_fields;
+        fields = arg_fields;
+        batch = NewBatch(0);
+    }
+
     /**
      * Push a record to the buffer.
      *
      * @param record The records vals.
+     *
+     * @return False if the record doesn't match the buffer's schema.
+     */
+    bool WriteRecord(LogRecord&& record) { return batch && batch->AppendRecord(std::move(record)); }
+
+    /**
+     * Returns the batch currently being filled, for callers that populate
+     * rows directly through RecordBatch::BeginRow() and
+     * RecordBatch::CommitRow().
      */
-    void WriteRecord(LogRecord&& record) { records.emplace_back(std::move(record)); }
+    RecordBatch& CurrentBatch() { return *batch; }
 
     /**
      * Moves the records out of the buffer and resets it.
      *
      * @return The currently buffered log records.
      */
-    std::vector<LogRecord> TakeRecords() && {
-        auto tmp = std::move(records);
+    std::unique_ptr<RecordBatch> TakeBatch() && {
+        auto tmp = std::move(batch);
 
-        // Re-initialize the buffer.
-        records.clear();
-        records.reserve(buffer_size);
+        // Re-initialize the buffer. Size it after the batch just taken, so
+        // writers that flush every few records don't reserve room for a
+        // full buffer each time.
+        batch = NewBatch(tmp->Rows());
 
         return tmp;
     }
@@ -49,21 +81,27 @@ public:
     /**
      * @return The size of the buffer.
      */
-    size_t Size() const { return records.size(); }
+    size_t Size() const { return batch ? batch->Rows() : 0; }
 
     /**
      * @return True if buffer is empty.
      */
-    size_t Empty() const { return records.empty(); }
+    bool Empty() const { return Size() == 0; }
 
     /**
      * @return True if size equals or exceeds configured buffer size.
      */
-    bool Full() const { return records.size() >= buffer_size; }
+    bool Full() const { return Size() >= buffer_size; }
 
 private:
+    std::unique_ptr<RecordBatch> NewBatch(size_t rows) const {
+        return std::make_unique<RecordBatch>(num_fields, fields, std::min(rows, buffer_size));
+    }
+
     size_t buffer_size;
-    std::vector<LogRecord> records;
+    int num_fields = 0;
+    const threading::Field* const* fields = nullptr;
+    std::unique_ptr<RecordBatch> batch;
 };
 
 } // namespace detail
@@ -153,6 +191,30 @@ public:
      */
     void Write(detail::LogRecord&& rec);
 
+    /**
+     * Starts writing a record directly into the frontend's columnar write
+     * buffer, avoiding the intermediary \a LogRecord. The caller fills in
+     * the fields of the returned batch's current row and then must call
+     * EndBatchWrite().
+     *
+     * This is only possible for frontends without remote logging, as
+     * remote logging needs the record as a whole.
+     *
+     * This method must only be called from the main thread.
+     *
+     * @return The batch to fill, or null if the record should not be
+     * written (e.g., because the frontend is disabled). EndBatchWrite()
+     * must not be called in that case.
+     */
+    detail::RecordBatch* BeginBatchWrite();
+
+    /**
+     * Completes a write started with BeginBatchWrite().
+     *
+     * This method must only be called from the main thread.
+     */
+    void EndBatchWrite();
+
     /**
      * Sets the buffering state.
      *
@@ -246,6 +308,11 @@ public:
 protected:
     friend class Manager;
 
+    /**
+     * Publishes the records buffered for a non-Broker cluster backend.
+     */
+    void FlushRemoteBuffer();
+
     EnumVal* stream;
     EnumVal* writer;
 
@@ -262,6 +329,14 @@ protected:
     const threading::Field* const* fields; // The log fields.
 
     detail::WriteBuffer write_buffer; // Buffer for bulk writes.
+
+    // Header and pending records for remote logging through a cluster
+    // backend other than Broker. Unset when logging locally only or when
+    // Broker is the cluster backend.
+    std::unique_ptr<detail::LogWriteHeader> remote_header;
+    std::vector<detail::LogRecord> remote_buffer;
+
+    telemetry::HistogramPtr queue_latency; // Time batches wait for the backend.
 };
 
 } // namespace zeek::logging
@@ -29,6 +29,15 @@ bool IPBasedAnalyzer::AnalyzePacket(size_t len, const uint8_t* data, Packet* pkt
     const std::shared_ptr<IP_Hdr>& ip_hdr = pkt->ip_hdr;
     zeek::detail::ConnKey key(tuple);
 
+    if ( Connection* shunted = session_mgr->FindShuntedConnection(key) ) {
+        // Nothing left to do for the packet besides counting it.
+        bool is_orig = (tuple.src_addr == shunted->OrigAddr()) && (tuple.src_port == shunted->OrigPort());
+        shunted->ShuntedPacket(run_state::processing_start_time, is_orig, ip_hdr->TotalLen());
+        pkt->processed = true;
+        pkt->is_orig = is_orig;
+        return true;
+    }
+
     Connection* conn = session_mgr->FindConnection(key);
 
     if ( ! conn ) {
@@ -174,19 +183,16 @@ void IPBasedAnalyzer::BuildSessionAnalyzerTree(Connection* conn) {
     if ( ! scheduled ) { // Let's see if it's a port we know.
         if ( ! analyzers_by_port.empty() && ! zeek::detail::dpd_ignore_ports ) {
             int resp_port = ntohs(conn->RespPort());
-            std::set<zeek::Tag>* ports = LookupPort(resp_port, false);
 
-            if ( ports ) {
-                for ( const auto& port : *ports ) {
-                    analyzer::Analyzer* analyzer = analyzer_mgr->InstantiateAnalyzer(port, conn);
+            for ( auto* c : LookupPortTemplate(resp_port) ) {
+                analyzer::Analyzer* analyzer = analyzer_mgr->InstantiateAnalyzer(c, conn);
 
-                    if ( ! analyzer )
-                        continue;
+                if ( ! analyzer )
+                    continue;
 
-                    root->AddChildAnalyzer(analyzer, false);
-                    DBG_ANALYZER_ARGS(conn, "activated %s analyzer due to port %d",
-                                      analyzer_mgr->GetComponentName(port).c_str(), resp_port);
-                }
+                root->AddChildAnalyzer(analyzer, false);
+                DBG_ANALYZER_ARGS(conn, "activated %s analyzer due to port %d", c->CanonicalName().c_str(),
+                                  resp_port);
             }
         }
     }
@@ -218,6 +224,7 @@ bool IPBasedAnalyzer::RegisterAnalyzerForPort(const zeek::Tag& tag, uint32_t por
 #endif
 
     l->insert(tag);
+    analyzer_mgr->BumpConfigGeneration();
     return true;
 }
 
@@ -233,6 +240,7 @@ bool IPBasedAnalyzer::UnregisterAnalyzerForPort(const zeek::Tag& tag, uint32_t p
 #endif
 
     l->erase(tag);
+    analyzer_mgr->BumpConfigGeneration();
     return true;
 }
 
@@ -250,6 +258,28 @@ IPBasedAnalyzer::tag_set* IPBasedAnalyzer::LookupPort(uint32_t port, bool add_if
     return l;
 }
 
+const IPBasedAnalyzer::port_template& IPBasedAnalyzer::LookupPortTemplate(uint32_t port) {
+    if ( port_templates_generation != analyzer_mgr->ConfigGeneration() ) {
+        port_templates.clear();
+        port_templates_generation = analyzer_mgr->ConfigGeneration();
+    }
+
+    auto [it, inserted] = port_templates.try_emplace(port);
+
+    if ( inserted ) {
+        if ( const tag_set* tags = LookupPort(port, false) ) {
+            for ( const auto& tag : *tags ) {
+                auto* c = analyzer_mgr->Lookup(tag);
+
+                if ( c && c->Enabled() && c->Factory() )
+                    it->second.push_back(c);
+            }
+        }
+    }
+
+    return it->second;
+}
+
 void IPBasedAnalyzer::DumpPortDebug() {
     for ( const auto& mapping : analyzers_by_port ) {
         std::string s;
@@ -2,13 +2,20 @@
 
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "zeek/ID.h"
 #include "zeek/Tag.h"
 #include "zeek/packet_analysis/Analyzer.h"
 
+namespace zeek::analyzer {
+class Component;
+}
+
 namespace zeek::analyzer::pia {
 class PIA;
 }
@@ -177,6 +184,16 @@ private:
 
     tag_set* LookupPort(uint32_t port, bool add_if_not_found);
 
+    // The enabled, instantiable analyzers registered for a port, resolved
+    // once and reused for every new connection to it. Entries are valid
+    // only as long as the analyzer manager's ConfigGeneration() matches
+    // port_templates_generation.
+    using port_template = std::vector<analyzer::Component*>;
+    std::unordered_map<uint32_t, port_template> port_templates;
+    uint64_t port_templates_generation = 0;
+
+    const port_template& LookupPortTemplate(uint32_t port);
+
     /**
      * Creates a new Connection object from data gleaned from the current packet.
      *
@@ -423,6 +423,7 @@ static std::unordered_map<std::string, unsigned int> func_attrs = {
     {"sha256_hash_finish", ATTR_NO_SCRIPT_SIDE_EFFECTS},
     {"sha256_hash_init", ATTR_NO_SCRIPT_SIDE_EFFECTS},
     {"sha256_hash_update", ATTR_NO_SCRIPT_SIDE_EFFECTS},
+    {"shunt_flow", ATTR_NO_SCRIPT_SIDE_EFFECTS},
     {"skip_further_processing", ATTR_NO_SCRIPT_SIDE_EFFECTS},
     {"skip_http_entity_data", ATTR_NO_SCRIPT_SIDE_EFFECTS},
     {"skip_smtp_data", ATTR_NO_SCRIPT_SIDE_EFFECTS},
@@ -118,6 +118,9 @@ void Manager::Remove(Session* s) {
 
         detail::Key key = s->SessionKey(false);
 
+        if ( ! shunt_map.empty() )
+            shunt_map.erase(key);
+
         if ( session_map.erase(key) == 0 )
             reporter->InternalWarning("connection missing");
         else {
@@ -145,6 +148,9 @@ void Manager::Insert(Session* s, bool remove_existing) {
             old = it->second;
 
         session_map.erase(key);
+
+        if ( ! shunt_map.empty() )
+            shunt_map.erase(key);
     }
 
     InsertSession(std::move(key), s);
@@ -158,6 +164,14 @@ void Manager::Insert(Session* s, bool remove_existing) {
     }
 }
 
+void Manager::Shunt(Connection* c) {
+    if ( ! c->IsInSessionTable() || c->IsShunted() )
+        return;
+
+    c->Shunt();
+    shunt_map.emplace(c->SessionKey(true), c);
+}
+
 void Manager::Drain() {
     // If a random seed was passed in, we're most likely in testing mode and need the
     // order of the sessions to be consistent. Sort the keys to force that order
@@ -190,6 +204,7 @@ void Manager::Clear() {
         Unref(entry.second);
 
     session_map.clear();
+    shunt_map.clear();
 
     zeek::detail::fragment_mgr->Clear();
 }
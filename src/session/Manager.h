@@ -77,6 +77,32 @@ public:
     void Remove(Session* s);
     void Insert(Session* c, bool remove_existing = true);
 
+    /**
+     * Shunts a connection: stops its analysis and adds it to the shunt
+     * table, which packet analysis checks before looking up sessions. The
+     * connection's later packets only count toward its packet and byte
+     * totals. It expires through its inactivity timeout, as it no longer
+     * sees connection teardowns.
+     *
+     * @param c The connection to shunt.
+     */
+    void Shunt(Connection* c);
+
+    /**
+     * Looks up a connection in the shunt table.
+     *
+     * @param conn_key The key for the connection to search for.
+     * @return The connection, or nullptr if it isn't shunted.
+     */
+    Connection* FindShuntedConnection(const zeek::detail::ConnKey& conn_key) {
+        if ( shunt_map.empty() )
+            return nullptr;
+
+        detail::Key key(&conn_key, sizeof(conn_key), detail::Key::CONNECTION_KEY_TYPE, false);
+        auto it = shunt_map.find(key);
+        return it != shunt_map.end() ? it->second : nullptr;
+    }
+
     // Generating connection_pending events for all connections
     // that are still active.
     void Drain();
@@ -102,6 +128,8 @@ private:
     void InsertSession(detail::Key key, Session* session);
 
     SessionMap session_map;
+    // The shunted subset of session_map's connections.
+    std::unordered_map<detail::Key, Connection*, detail::KeyHash> shunt_map;
     detail::ProtocolStats* stats;
     telemetry::CounterFamilyPtr ended_sessions_metric_family;
     telemetry::CounterPtr ended_by_inactivity_metric;
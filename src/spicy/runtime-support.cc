@@ -3,6 +3,8 @@
 #include "zeek/spicy/runtime-support.h"
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <hilti/rt/exception.h>
 #include <hilti/rt/profiler.h>
@@ -221,6 +223,45 @@ TypePtr rt::event_arg_type(const EventHandlerPtr& handler, const hilti::rt::inte
     return zeek_args[idx];
 }
 
+ValPtr rt::unused_event_arg(const EventHandlerPtr& handler, const hilti::rt::integer::safe<uint64_t>& idx) {
+    auto _ = hilti::rt::profiler::start("zeek/rt/unused_event_arg");
+
+    // Validates the index.
+    auto target = event_arg_type(handler, idx);
+    auto tag = target->Tag();
+
+    // Converting atomic values is about as cheap as creating a placeholder,
+    // so we only skip building containers.
+    if ( tag != TYPE_RECORD && tag != TYPE_TABLE && tag != TYPE_VECTOR )
+        return nullptr;
+
+    auto* h = const_cast<EventHandlerPtr&>(handler).Ptr();
+
+    if ( h->ArgUsed(idx) )
+        return nullptr;
+
+    // The conversion is what checks the value against the parameter's type.
+    // Still convert each argument the first time its event gets raised, so
+    // that a mismatch gets reported once rather than never.
+    static std::unordered_map<const EventHandler*, std::vector<bool>> checked_args;
+    auto& checked = checked_args[h];
+    uint64_t i = idx;
+
+    if ( checked.size() <= i )
+        checked.resize(i + 1);
+
+    if ( ! checked[i] ) {
+        checked[i] = true;
+        return nullptr;
+    }
+
+    switch ( tag ) {
+        case TYPE_RECORD: return make_intrusive<RecordVal>(cast_intrusive<RecordType>(target));
+        case TYPE_TABLE: return make_intrusive<TableVal>(cast_intrusive<TableType>(target));
+        default: return make_intrusive<VectorVal>(cast_intrusive<VectorType>(target));
+    }
+}
+
 ValPtr& rt::current_conn() {
     auto _ = hilti::rt::profiler::start("zeek/rt/current_conn");
 
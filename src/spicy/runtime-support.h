@@ -209,6 +209,17 @@ void raise_event(const EventHandlerPtr& handler, const hilti::rt::Vector<ValPtr>
  */
 TypePtr event_arg_type(const EventHandlerPtr& handler, const hilti::rt::integer::safe<uint64_t>& idx);
 
+/**
+ * Returns a placeholder value for an event's i'th argument if nothing will
+ * look at the argument once the event is raised, as determined by
+ * `EventHandler::ArgUsed()`. Returns null if the argument is used, or if its
+ * type doesn't benefit from skipping the conversion. Also returns null the
+ * first time it's asked about an argument, so that the argument still gets
+ * converted, and checked against its parameter type, once. The result is
+ * returned with ref count +1.
+ */
+ValPtr unused_event_arg(const EventHandlerPtr& handler, const hilti::rt::integer::safe<uint64_t>& idx);
+
 /**
  * Retrieves the connection ID for the currently processed Zeek connection.
  * Assumes that the HILTI context's cookie value has been set accordingly.
@@ -994,6 +1005,21 @@ inline ValPtr to_val(const T& t, const TypePtr& target) {
     return target->AsEnumType()->GetEnumVal(bt);
 }
 
+/**
+ * Converts a Spicy-side value into a Zeek value for an event's i'th
+ * argument. Skips the conversion if nothing will look at the argument,
+ * returning a placeholder from `unused_event_arg()` instead. The result is
+ * returned with ref count +1.
+ */
+template<typename T>
+inline ValPtr event_arg_to_val(const T& t, const EventHandlerPtr& handler,
+                               const hilti::rt::integer::safe<uint64_t>& idx) {
+    if ( auto v = unused_event_arg(handler, idx) )
+        return v;
+
+    return to_val(t, event_arg_type(handler, idx));
+}
+
 
 /**
  * Returns the Zeek value associated with a global Zeek-side ID. Throws if the
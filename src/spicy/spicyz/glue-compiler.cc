@@ -1355,8 +1355,7 @@ bool GlueCompiler::CreateSpicyHook(glue::Event* ev) {
                 return false;
             }
 
-            auto ztype = builder()->call("zeek_rt::event_arg_type", {handler_expr, builder()->integer(i)}, meta);
-            val = builder()->call("zeek_rt::to_val", {*expr, ztype}, meta);
+            val = builder()->call("zeek_rt::event_arg_to_val", {*expr, handler_expr, builder()->integer(i)}, meta);
         }
 
         body.addMemberCall(builder()->id("args"), "push_back", {val}, meta);
@@ -2,13 +2,21 @@
 
 using namespace zeek::telemetry;
 
-Counter::Counter(FamilyType* family, const prometheus::Labels& labels, detail::CollectCallbackPtr callback) noexcept
-    : family(family), handle(family->Add(labels)), labels(labels), callback(std::move(callback)) {}
+Counter::Counter(FamilyType* family, const prometheus::Labels& labels, detail::CollectCallbackPtr callback,
+                 bool sharded) noexcept
+    : family(family), handle(family->Add(labels)), labels(labels), callback(std::move(callback)) {
+    // Callbacks determine the value by themselves, so there's nothing to shard.
+    if ( sharded && ! this->callback )
+        shards = std::make_unique<detail::ShardedValue>();
+}
 
 double Counter::Value() const noexcept {
     if ( callback )
         return callback();
 
+    if ( shards )
+        return shards->Sum();
+
     return handle.Value();
 }
 
@@ -20,7 +28,7 @@ std::shared_ptr<Counter> CounterFamily::GetOrAdd(Span<const LabelView> labels, d
     if ( auto it = std::find_if(counters.begin(), counters.end(), check); it != counters.end() )
         return *it;
 
-    auto counter = std::make_shared<Counter>(family, p_labels, callback);
+    auto counter = std::make_shared<Counter>(family, p_labels, callback, sharded);
     counters.push_back(counter);
     return counter;
 }
@@ -38,3 +46,13 @@ void CounterFamily::RunCallbacks() {
         }
     }
 }
+
+void CounterFamily::SyncShards() {
+    if ( ! sharded )
+        return;
+
+    for ( auto& c : counters ) {
+        if ( c->IsSharded() )
+            c->Set(c->shards->Sum());
+    }
+}
@@ -10,6 +10,7 @@
 #include "zeek/NetVar.h"
 #include "zeek/Span.h"
 #include "zeek/telemetry/MetricFamily.h"
+#include "zeek/telemetry/ShardedValue.h"
 #include "zeek/telemetry/Utils.h"
 
 namespace zeek::telemetry {
@@ -31,7 +32,7 @@ public:
     using FamilyType = prometheus::Family<Handle>;
 
     explicit Counter(FamilyType* family, const prometheus::Labels& labels,
-                     detail::CollectCallbackPtr callback = nullptr) noexcept;
+                     detail::CollectCallbackPtr callback = nullptr, bool sharded = false) noexcept;
 
     /**
      * Increments the value by 1.
@@ -42,7 +43,12 @@ public:
      * Increments the value by @p amount.
      * @pre `amount >= 0`
      */
-    void Inc(double amount) noexcept { handle.Increment(amount); }
+    void Inc(double amount) noexcept {
+        if ( shards )
+            shards->Add(amount);
+        else
+            handle.Increment(amount);
+    }
 
     /**
      * Increments the value by 1.
@@ -63,6 +69,8 @@ public:
     bool HasCallback() const noexcept { return callback != nullptr; }
     double RunCallback() const { return callback(); }
 
+    bool IsSharded() const noexcept { return shards != nullptr; }
+
 private:
     friend class CounterFamily;
     void Set(double val) {
@@ -75,6 +83,7 @@ private:
     Handle& handle;
     prometheus::Labels labels;
     detail::CollectCallbackPtr callback;
+    std::unique_ptr<detail::ShardedValue> shards;
 };
 
 using CounterPtr = std::shared_ptr<Counter>;
@@ -83,8 +92,14 @@ class CounterFamily : public MetricFamily {
 public:
     static inline const char* OpaqueName = "CounterMetricFamilyVal";
 
-    CounterFamily(prometheus::Family<prometheus::Counter>* family, Span<const std::string_view> labels)
-        : MetricFamily(labels), family(family) {}
+    /**
+     * @param sharded If true, the family's counters keep per-thread shards
+     * that get summed up only when collecting metrics. This avoids
+     * contention on counters that multiple threads increment frequently.
+     */
+    CounterFamily(prometheus::Family<prometheus::Counter>* family, Span<const std::string_view> labels,
+                  bool sharded = false)
+        : MetricFamily(labels), family(family), sharded(sharded) {}
 
     /**
      * Returns the metrics handle for given labels, creating a new instance
@@ -101,8 +116,11 @@ public:
 
     void RunCallbacks() override;
 
+    void SyncShards() override;
+
 private:
     prometheus::Family<prometheus::Counter>* family;
+    bool sharded;
     std::vector<CounterPtr> counters;
 };
 
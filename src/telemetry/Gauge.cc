@@ -6,12 +6,20 @@ double Gauge::Value() const noexcept {
     if ( callback )
         return callback();
 
+    if ( shards )
+        return shards->Sum();
+
     return handle.Value();
 }
 
 
-Gauge::Gauge(FamilyType* family, const prometheus::Labels& labels, detail::CollectCallbackPtr callback) noexcept
-    : family(family), handle(family->Add(labels)), labels(labels), callback(std::move(callback)) {}
+Gauge::Gauge(FamilyType* family, const prometheus::Labels& labels, detail::CollectCallbackPtr callback,
+             bool sharded) noexcept
+    : family(family), handle(family->Add(labels)), labels(labels), callback(std::move(callback)) {
+    // Callbacks determine the value by themselves, so there's nothing to shard.
+    if ( sharded && ! this->callback )
+        shards = std::make_unique<detail::ShardedValue>();
+}
 
 std::shared_ptr<Gauge> GaugeFamily::GetOrAdd(Span<const LabelView> labels, detail::CollectCallbackPtr callback) {
     prometheus::Labels p_labels = detail::BuildPrometheusLabels(labels);
@@ -21,7 +29,7 @@ std::shared_ptr<Gauge> GaugeFamily::GetOrAdd(Span<const LabelView> labels, detai
     if ( auto it = std::find_if(gauges.begin(), gauges.end(), check); it != gauges.end() )
         return *it;
 
-    auto gauge = std::make_shared<Gauge>(family, p_labels, callback);
+    auto gauge = std::make_shared<Gauge>(family, p_labels, callback, sharded);
     gauges.push_back(gauge);
     return gauge;
 }
@@ -37,3 +45,13 @@ void GaugeFamily::RunCallbacks() {
             g->Set(g->RunCallback());
     }
 }
+
+void GaugeFamily::SyncShards() {
+    if ( ! sharded )
+        return;
+
+    for ( const auto& g : gauges ) {
+        if ( g->IsSharded() )
+            g->handle.Set(g->shards->Sum());
+    }
+}
@@ -11,6 +11,7 @@
 #include "zeek/NetVar.h"
 #include "zeek/Span.h"
 #include "zeek/telemetry/MetricFamily.h"
+#include "zeek/telemetry/ShardedValue.h"
 #include "zeek/telemetry/Utils.h"
 
 namespace zeek::telemetry {
@@ -30,7 +31,7 @@ public:
     using FamilyType = prometheus::Family<Handle>;
 
     explicit Gauge(FamilyType* family, const prometheus::Labels& labels,
-                   detail::CollectCallbackPtr callback = nullptr) noexcept;
+                   detail::CollectCallbackPtr callback = nullptr, bool sharded = false) noexcept;
 
     /**
      * Increments the value by 1.
@@ -40,7 +41,12 @@ public:
     /**
      * Increments the value by @p amount.
      */
-    void Inc(double amount) noexcept { handle.Increment(amount); }
+    void Inc(double amount) noexcept {
+        if ( shards )
+            shards->Add(amount);
+        else
+            handle.Increment(amount);
+    }
 
     /**
      * Increments the value by 1.
@@ -59,12 +65,23 @@ public:
     /**
      * Decrements the value by @p amount.
      */
-    void Dec(double amount) noexcept { handle.Decrement(amount); }
+    void Dec(double amount) noexcept {
+        if ( shards )
+            shards->Add(-amount);
+        else
+            handle.Decrement(amount);
+    }
 
     /**
-     * Set the value by @p val.
+     * Set the value by @p val. For sharded gauges, concurrent updates by
+     * other threads may get lost.
      */
-    void Set(double val) noexcept { handle.Set(val); }
+    void Set(double val) noexcept {
+        if ( shards )
+            shards->Set(val);
+        else
+            handle.Set(val);
+    }
 
     /**
      * Decrements the value by 1.
@@ -85,11 +102,16 @@ public:
     bool HasCallback() const noexcept { return callback != nullptr; }
     double RunCallback() const { return callback(); }
 
+    bool IsSharded() const noexcept { return shards != nullptr; }
+
 private:
+    friend class GaugeFamily;
+
     FamilyType* family = nullptr;
     Handle& handle;
     prometheus::Labels labels;
     detail::CollectCallbackPtr callback;
+    std::unique_ptr<detail::ShardedValue> shards;
 };
 
 using GaugePtr = std::shared_ptr<Gauge>;
@@ -111,13 +133,22 @@ public:
 
     zeek_int_t MetricType() const noexcept override { return BifEnum::Telemetry::MetricType::GAUGE; }
 
-    GaugeFamily(prometheus::Family<prometheus::Gauge>* family, Span<const std::string_view> labels)
-        : MetricFamily(labels), family(family) {}
+    /**
+     * @param sharded If true, the family's gauges keep per-thread shards
+     * that get summed up only when collecting metrics. This avoids
+     * contention on gauges that multiple threads update frequently.
+     */
+    GaugeFamily(prometheus::Family<prometheus::Gauge>* family, Span<const std::string_view> labels,
+                bool sharded = false)
+        : MetricFamily(labels), family(family), sharded(sharded) {}
 
     void RunCallbacks() override;
 
+    void SyncShards() override;
+
 private:
     prometheus::Family<prometheus::Gauge>* family;
+    bool sharded;
     std::vector<GaugePtr> gauges;
 };
 
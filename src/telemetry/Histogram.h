@@ -76,4 +76,13 @@ private:
 
 using HistogramFamilyPtr = std::shared_ptr<HistogramFamily>;
 
+namespace detail {
+
+// Bucket bounds for durations in seconds: powers of four from one
+// microsecond to about one second.
+inline constexpr double duration_bounds[] = {0.000001, 0.000004, 0.000016, 0.000064, 0.000256, 0.001024,
+                                             0.004096, 0.016384, 0.065536, 0.262144, 1.048576};
+
+} // namespace detail
+
 } // namespace zeek::telemetry
@@ -0,0 +1,92 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/telemetry/InvocationProfile.h"
+
+#include <ctime>
+
+#include "zeek/NetVar.h"
+#include "zeek/telemetry/Histogram.h"
+#include "zeek/telemetry/Manager.h"
+
+namespace zeek::telemetry::detail {
+
+namespace {
+
+double thread_cpu_time() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    struct timespec ts;
+
+    if ( clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0 )
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+#endif
+
+    return 0.0;
+}
+
+} // namespace
+
+InvocationProfile::InvocationProfile(Kind kind, std::string name) : kind(kind), name(std::move(name)) {}
+
+InvocationProfile* InvocationProfile::Sample(std::shared_ptr<InvocationProfile>& profile, Kind kind,
+                                             const std::string& name) {
+    auto rate = BifConst::Telemetry::invocation_sample_rate;
+
+    if ( rate == 0 )
+        return nullptr;
+
+    if ( ! profile )
+        profile = std::make_shared<InvocationProfile>(kind, name);
+
+    if ( profile->countdown > 1 ) {
+        --profile->countdown;
+        return nullptr;
+    }
+
+    profile->countdown = rate;
+    return profile.get();
+}
+
+void InvocationProfile::Record(double wall, double cpu) {
+    if ( ! wall_time ) {
+        // Create the histograms lazily, so we don't expose metrics for
+        // handlers and functions that never ran.
+        static auto eh_wall_family =
+            telemetry_mgr->HistogramFamily("zeek", "event-handler-wall-time", {"name"}, duration_bounds,
+                                           "Sampled wall time of event handler invocations", "seconds");
+        static auto eh_cpu_family =
+            telemetry_mgr->HistogramFamily("zeek", "event-handler-cpu-time", {"name"}, duration_bounds,
+                                           "Sampled CPU time of event handler invocations", "seconds");
+        static auto func_wall_family =
+            telemetry_mgr->HistogramFamily("zeek", "function-wall-time", {"name"}, duration_bounds,
+                                           "Sampled wall time of script function and hook invocations", "seconds");
+        static auto func_cpu_family =
+            telemetry_mgr->HistogramFamily("zeek", "function-cpu-time", {"name"}, duration_bounds,
+                                           "Sampled CPU time of script function and hook invocations", "seconds");
+
+        if ( kind == EVENT_HANDLER ) {
+            wall_time = eh_wall_family->GetOrAdd({{"name", name}});
+            cpu_time = eh_cpu_family->GetOrAdd({{"name", name}});
+        }
+        else {
+            wall_time = func_wall_family->GetOrAdd({{"name", name}});
+            cpu_time = func_cpu_family->GetOrAdd({{"name", name}});
+        }
+    }
+
+    wall_time->Observe(wall);
+    cpu_time->Observe(cpu);
+}
+
+void InvocationTimer::Start() {
+    wall_start = std::chrono::steady_clock::now();
+    cpu_start = thread_cpu_time();
+}
+
+void InvocationTimer::Stop() {
+    using Sec = std::chrono::duration<double>;
+    auto wall = std::chrono::duration_cast<Sec>(std::chrono::steady_clock::now() - wall_start).count();
+    auto cpu = thread_cpu_time() - cpu_start;
+    profile->Record(wall, cpu > 0.0 ? cpu : 0.0);
+}
+
+} // namespace zeek::telemetry::detail
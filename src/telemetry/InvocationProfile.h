@@ -0,0 +1,86 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace zeek::telemetry {
+
+class Histogram;
+
+namespace detail {
+
+/**
+ * Sampled wall and CPU time histograms for invocations of a single event
+ * handler or script function. Every Telemetry::invocation_sample_rate-th
+ * invocation gets measured. The histograms are labeled with the handler's
+ * or function's name and exported like all other metrics.
+ */
+class InvocationProfile {
+public:
+    enum Kind {
+        EVENT_HANDLER,
+        FUNCTION,
+    };
+
+    InvocationProfile(Kind kind, std::string name);
+
+    /**
+     * Decides whether to measure the next invocation.
+     *
+     * @param profile The state of the handler or function. Gets created on
+     * first use.
+     *
+     * @return The profile to pass to an InvocationTimer, or nullptr if the
+     * invocation shouldn't be measured.
+     */
+    static InvocationProfile* Sample(std::shared_ptr<InvocationProfile>& profile, Kind kind, const std::string& name);
+
+    /**
+     * Records the times of one invocation, in seconds.
+     */
+    void Record(double wall, double cpu);
+
+private:
+    Kind kind;
+    std::string name;
+    uint64_t countdown = 0;
+    std::shared_ptr<Histogram> wall_time;
+    std::shared_ptr<Histogram> cpu_time;
+};
+
+/**
+ * Measures the invocation of a sampled handler or function from its
+ * construction until it goes out of scope. Does nothing if constructed
+ * with a nullptr.
+ */
+class [[nodiscard]] InvocationTimer {
+public:
+    explicit InvocationTimer(InvocationProfile* profile) : profile(profile) {
+        if ( profile )
+            Start();
+    }
+
+    InvocationTimer(const InvocationTimer&) = delete;
+
+    InvocationTimer& operator=(const InvocationTimer&) = delete;
+
+    ~InvocationTimer() {
+        if ( profile )
+            Stop();
+    }
+
+private:
+    void Start();
+    void Stop();
+
+    InvocationProfile* profile;
+    std::chrono::steady_clock::time_point wall_start;
+    double cpu_start = 0.0;
+};
+
+} // namespace detail
+} // namespace zeek::telemetry
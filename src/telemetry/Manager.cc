@@ -292,6 +292,9 @@ ValPtr Manager::CollectMetrics(std::string_view prefix_pattern, std::string_view
 
     InvokeTelemetrySyncHook();
 
+    for ( const auto& [name, f] : families )
+        f->SyncShards();
+
     VectorValPtr ret_val = make_intrusive<VectorVal>(metrics_vector_type);
 
     // Due to the name containing the full information about a metric including a potential unit add an
@@ -479,7 +482,7 @@ void Manager::BuildClusterJson() {
 
 CounterFamilyPtr Manager::CounterFamily(std::string_view prefix, std::string_view name,
                                         Span<const std::string_view> labels, std::string_view helptext,
-                                        std::string_view unit) {
+                                        std::string_view unit, bool sharded) {
     auto full_name = detail::BuildFullPrometheusName(prefix, name, unit, true);
 
     auto& prom_fam =
@@ -488,16 +491,16 @@ CounterFamilyPtr Manager::CounterFamily(std::string_view prefix, std::string_vie
     if ( auto it = families.find(prom_fam.GetName()); it != families.end() )
         return std::static_pointer_cast<telemetry::CounterFamily>(it->second);
 
-    auto fam = std::make_shared<telemetry::CounterFamily>(&prom_fam, labels);
+    auto fam = std::make_shared<telemetry::CounterFamily>(&prom_fam, labels, sharded);
     families.insert({prom_fam.GetName(), fam});
     return fam;
 }
 
 CounterFamilyPtr Manager::CounterFamily(std::string_view prefix, std::string_view name,
                                         std::initializer_list<std::string_view> labels, std::string_view helptext,
-                                        std::string_view unit) {
+                                        std::string_view unit, bool sharded) {
     auto lbl_span = Span{labels.begin(), labels.size()};
-    return CounterFamily(prefix, name, lbl_span, helptext, unit);
+    return CounterFamily(prefix, name, lbl_span, helptext, unit, sharded);
 }
 
 CounterPtr Manager::CounterInstance(std::string_view prefix, std::string_view name, Span<const LabelView> labels,
@@ -518,7 +521,7 @@ CounterPtr Manager::CounterInstance(std::string_view prefix, std::string_view na
 
 std::shared_ptr<GaugeFamily> Manager::GaugeFamily(std::string_view prefix, std::string_view name,
                                                   Span<const std::string_view> labels, std::string_view helptext,
-                                                  std::string_view unit) {
+                                                  std::string_view unit, bool sharded) {
     auto full_name = detail::BuildFullPrometheusName(prefix, name, unit, false);
 
     auto& prom_fam =
@@ -527,16 +530,16 @@ std::shared_ptr<GaugeFamily> Manager::GaugeFamily(std::string_view prefix, std::
     if ( auto it = families.find(prom_fam.GetName()); it != families.end() )
         return std::static_pointer_cast<telemetry::GaugeFamily>(it->second);
 
-    auto fam = std::make_shared<telemetry::GaugeFamily>(&prom_fam, labels);
+    auto fam = std::make_shared<telemetry::GaugeFamily>(&prom_fam, labels, sharded);
     families.insert({prom_fam.GetName(), fam});
     return fam;
 }
 
 GaugeFamilyPtr Manager::GaugeFamily(std::string_view prefix, std::string_view name,
                                     std::initializer_list<std::string_view> labels, std::string_view helptext,
-                                    std::string_view unit) {
+                                    std::string_view unit, bool sharded) {
     auto lbl_span = Span{labels.begin(), labels.size()};
-    return GaugeFamily(prefix, name, lbl_span, helptext, unit);
+    return GaugeFamily(prefix, name, lbl_span, helptext, unit, sharded);
 }
 
 GaugePtr Manager::GaugeInstance(std::string_view prefix, std::string_view name, Span<const LabelView> labels,
@@ -597,8 +600,10 @@ void Manager::ProcessFd(int fd, int flags) {
 
     collector_flare.Extinguish();
 
-    for ( const auto& [name, f] : families )
+    for ( const auto& [name, f] : families ) {
         f->RunCallbacks();
+        f->SyncShards();
+    }
 
     InvokeTelemetrySyncHook();
 
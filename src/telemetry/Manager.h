@@ -80,14 +80,17 @@ public:
      * @param labels Names for all label dimensions of the metric.
      * @param helptext Short explanation of the metric.
      * @param unit Unit of measurement.
+     * @param sharded Whether the counters keep per-thread shards, for counters
+     * that get incremented on hot paths. The first call wins when calling
+     * this function multiple times with different settings.
      */
     CounterFamilyPtr CounterFamily(std::string_view prefix, std::string_view name, Span<const std::string_view> labels,
-                                   std::string_view helptext, std::string_view unit = "");
+                                   std::string_view helptext, std::string_view unit = "", bool sharded = false);
 
     /// @copydoc CounterFamily
     CounterFamilyPtr CounterFamily(std::string_view prefix, std::string_view name,
                                    std::initializer_list<std::string_view> labels, std::string_view helptext,
-                                   std::string_view unit = "");
+                                   std::string_view unit = "", bool sharded = false);
 
     /**
      * Accesses a counter instance. Creates the hosting metric family as well
@@ -116,14 +119,17 @@ public:
      * @param labels Names for all label dimensions of the metric.
      * @param helptext Short explanation of the metric.
      * @param unit Unit of measurement.
+     * @param sharded Whether the gauges keep per-thread shards, for gauges
+     * that get updated on hot paths. The first call wins when calling this
+     * function multiple times with different settings.
      */
     GaugeFamilyPtr GaugeFamily(std::string_view prefix, std::string_view name, Span<const std::string_view> labels,
-                               std::string_view helptext, std::string_view unit = "");
+                               std::string_view helptext, std::string_view unit = "", bool sharded = false);
 
     /// @copydoc GaugeFamily
     GaugeFamilyPtr GaugeFamily(std::string_view prefix, std::string_view name,
                                std::initializer_list<std::string_view> labels, std::string_view helptext,
-                               std::string_view unit = "");
+                               std::string_view unit = "", bool sharded = false);
 
     /**
      * Accesses a gauge instance. Creates the hosting metric family as well
@@ -24,6 +24,11 @@ public:
 
     virtual void RunCallbacks() = 0;
 
+    /**
+     * Publishes the current values of sharded metrics to Prometheus.
+     */
+    virtual void SyncShards() {}
+
 protected:
     MetricFamily(Span<const std::string_view> labels) {
         for ( const auto& lbl : labels )
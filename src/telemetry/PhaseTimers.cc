@@ -0,0 +1,70 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/telemetry/PhaseTimers.h"
+
+#include "zeek/NetVar.h"
+#include "zeek/telemetry/Histogram.h"
+#include "zeek/telemetry/Manager.h"
+
+namespace zeek::telemetry::detail {
+
+PhaseTimers::PhaseTimers() : start_ticks(read_ticks()), start_time(std::chrono::steady_clock::now()) {}
+
+void PhaseTimers::InitPostScript() {
+    sample_rate = BifConst::Telemetry::main_loop_sample_rate;
+    enabled = sample_rate > 0;
+
+    if ( ! enabled )
+        return;
+
+    auto total_family =
+        telemetry_mgr->CounterFamily("zeek", "main-loop-phase-time", {"phase"},
+                                     "Total time the main loop spent in each phase", "seconds");
+    auto duration_family =
+        telemetry_mgr->HistogramFamily("zeek", "main-loop-phase-duration", {"phase"}, duration_bounds,
+                                       "Time spent in each phase of sampled main loop iterations", "seconds");
+
+    for ( int i = 0; i < NUM_PHASES; ++i ) {
+        auto phase = static_cast<Phase>(i);
+        total_metrics[i] = total_family->GetOrAdd({{"phase", PhaseName(phase)}},
+                                                  [this, i]() { return TicksToSeconds(totals[i]); });
+        duration_metrics[i] = duration_family->GetOrAdd({{"phase", PhaseName(phase)}});
+    }
+
+    iterations_metric = telemetry_mgr->CounterInstance("zeek", "main-loop-iterations", {},
+                                                       "Number of main loop iterations", "",
+                                                       [this]() { return static_cast<double>(iterations); });
+}
+
+double PhaseTimers::TicksToSeconds(uint64_t ticks) {
+    // Refine the tick rate against the steady clock as time goes by.
+    using Sec = std::chrono::duration<double>;
+    auto elapsed = std::chrono::duration_cast<Sec>(std::chrono::steady_clock::now() - start_time).count();
+
+    if ( elapsed >= 0.001 )
+        ticks_per_second = static_cast<double>(read_ticks() - start_ticks) / elapsed;
+
+    return static_cast<double>(ticks) / ticks_per_second;
+}
+
+const char* PhaseTimers::PhaseName(Phase phase) {
+    switch ( phase ) {
+        case POLL: return "poll";
+        case PACKETS: return "packets";
+        case TIMERS: return "timers";
+        case THREADS: return "threads";
+        case SOURCES: return "sources";
+        case EVENTS: return "events";
+        default: return "unknown";
+    }
+}
+
+void PhaseTimers::Sample() {
+    for ( int i = 0; i < NUM_PHASES; ++i ) {
+        // Only count phases that actually ran in this iteration.
+        if ( current[i] > 0 )
+            duration_metrics[i]->Observe(TicksToSeconds(current[i]));
+    }
+}
+
+} // namespace zeek::telemetry::detail
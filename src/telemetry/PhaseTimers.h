@@ -0,0 +1,128 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace zeek::telemetry {
+
+class Counter;
+class Histogram;
+
+namespace detail {
+
+/**
+ * Returns a cheap, monotonic timestamp in CPU-specific ticks: the time
+ * stamp counter on x86, the virtual counter on ARM64 and nanoseconds of the
+ * steady clock elsewhere. Use PhaseTimers::TicksToSeconds() for conversion.
+ */
+inline uint64_t read_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+/**
+ * Splits the time of each main loop iteration into phases. The loop calls
+ * Mark() at the end of each phase, which charges the ticks since the
+ * previous mark to that phase. The totals are exported as counters, and
+ * every Telemetry::main_loop_sample_rate-th iteration's breakdown also goes
+ * into per-phase histograms.
+ */
+class PhaseTimers {
+public:
+    enum Phase {
+        POLL,    // Waiting for and finding ready IO sources.
+        PACKETS, // Packet processing, including the analyzers.
+        TIMERS,  // Advancing network time and expiring timers.
+        THREADS, // Messages from threads, such as log writers and input readers.
+        SOURCES, // All other IO sources.
+        EVENTS,  // Draining the event queue, i.e. running scripts.
+        NUM_PHASES,
+    };
+
+    PhaseTimers();
+
+    /**
+     * Creates the metrics. Needs the telemetry manager.
+     */
+    void InitPostScript();
+
+    /**
+     * Starts a new loop iteration.
+     */
+    void Begin() {
+        if ( enabled )
+            last = read_ticks();
+    }
+
+    /**
+     * Charges the ticks since the previous mark to the given phase.
+     */
+    void Mark(Phase phase) {
+        if ( ! enabled )
+            return;
+
+        auto now = read_ticks();
+        auto ticks = now - last;
+        totals[phase] += ticks;
+        current[phase] += ticks;
+        last = now;
+    }
+
+    /**
+     * Finishes a loop iteration.
+     */
+    void End() {
+        if ( ! enabled )
+            return;
+
+        if ( ++iterations % sample_rate == 0 )
+            Sample();
+
+        current = {};
+    }
+
+    /**
+     * Converts ticks from read_ticks() to seconds.
+     */
+    double TicksToSeconds(uint64_t ticks);
+
+    static const char* PhaseName(Phase phase);
+
+private:
+    void Sample();
+
+    bool enabled = false;
+    uint64_t sample_rate = 1;
+    uint64_t last = 0;
+    uint64_t iterations = 0;
+    std::array<uint64_t, NUM_PHASES> totals = {};
+    std::array<uint64_t, NUM_PHASES> current = {};
+
+    // Calibration of ticks against the steady clock.
+    uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+    double ticks_per_second = 1e9;
+
+    std::array<std::shared_ptr<Counter>, NUM_PHASES> total_metrics;
+    std::array<std::shared_ptr<Histogram>, NUM_PHASES> duration_metrics;
+    std::shared_ptr<Counter> iterations_metric;
+};
+
+} // namespace detail
+} // namespace zeek::telemetry
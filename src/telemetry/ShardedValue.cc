@@ -0,0 +1,59 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#include "zeek/telemetry/ShardedValue.h"
+
+#include <thread>
+#include <vector>
+
+#include "zeek/3rdparty/doctest.h"
+
+using namespace zeek::telemetry::detail;
+
+double ShardedValue::Sum() const noexcept {
+    double sum = 0.0;
+
+    for ( size_t i = 0; i <= NumShards; ++i )
+        sum += shards[i].value.load(std::memory_order_relaxed);
+
+    return sum;
+}
+
+void ShardedValue::Set(double val) noexcept {
+    for ( size_t i = 1; i <= NumShards; ++i )
+        shards[i].value.store(0.0, std::memory_order_relaxed);
+
+    shards[0].value.store(val, std::memory_order_relaxed);
+}
+
+size_t ShardedValue::NextShard() noexcept {
+    static std::atomic<size_t> next = 0;
+    auto idx = next.fetch_add(1, std::memory_order_relaxed);
+    return idx < NumShards ? idx : NumShards;
+}
+
+TEST_SUITE_BEGIN("telemetry sharded value");
+
+TEST_CASE("sums updates from many threads") {
+    ShardedValue v;
+    std::vector<std::thread> threads;
+
+    // More threads than shards, so that some go through the overflow shard.
+    for ( size_t i = 0; i < ShardedValue::NumShards + 8; ++i )
+        threads.emplace_back([&v]() {
+            for ( int j = 0; j < 1000; ++j )
+                v.Add(1.0);
+        });
+
+    for ( auto& t : threads )
+        t.join();
+
+    CHECK(v.Sum() == (ShardedValue::NumShards + 8) * 1000.0);
+
+    v.Add(-500.0);
+    CHECK(v.Sum() == (ShardedValue::NumShards + 8) * 1000.0 - 500.0);
+
+    v.Set(42.0);
+    CHECK(v.Sum() == 42.0);
+}
+
+TEST_SUITE_END();
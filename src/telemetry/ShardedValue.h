@@ -0,0 +1,70 @@
+// See the file "COPYING" in the main distribution directory for copyright.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace zeek::telemetry::detail {
+
+/**
+ * A value that threads update without contending for the same cache line.
+ * Each of the first NumShards threads that touch any sharded value gets a
+ * shard of its own, which it updates with a plain load and store. Threads
+ * beyond that share an overflow shard that's updated with atomic
+ * read-modify-write operations. Reading the value sums up all shards, so
+ * it's meant for collection time, not for the hot path.
+ */
+class ShardedValue {
+public:
+    static constexpr size_t NumShards = 32;
+
+    ShardedValue() : shards(std::make_unique<Shard[]>(NumShards + 1)) {}
+
+    /**
+     * Adds @p amount, which may be negative, to the calling thread's shard.
+     */
+    void Add(double amount) noexcept {
+        auto idx = ThreadShard();
+
+        if ( idx < NumShards ) {
+            auto& v = shards[idx].value;
+            v.store(v.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+        else {
+            auto& v = shards[NumShards].value;
+            auto old = v.load(std::memory_order_relaxed);
+            while ( ! v.compare_exchange_weak(old, old + amount, std::memory_order_relaxed) )
+                ;
+        }
+    }
+
+    /**
+     * Returns the sum over all shards.
+     */
+    double Sum() const noexcept;
+
+    /**
+     * Sets the value such that Sum() returns @p val. Updates racing with
+     * this call may get lost.
+     */
+    void Set(double val) noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<double> value = 0.0;
+    };
+
+    // Returns the calling thread's shard index, assigning one on first use.
+    static size_t ThreadShard() noexcept {
+        static thread_local size_t idx = NextShard();
+        return idx;
+    }
+
+    static size_t NextShard() noexcept;
+
+    std::unique_ptr<Shard[]> shards;
+};
+
+} // namespace zeek::telemetry::detail
@@ -214,6 +214,10 @@ private:
 
 ////// Methods.
 
+bool MsgThread::IsMsgThreadSource(const iosource::IOSource* src) {
+    return dynamic_cast<const detail::IOSource*>(src) != nullptr;
+}
+
 Message::~Message() { delete[] name; }
 
 MsgThread::MsgThread() : BasicThread(), queue_in(this, nullptr), queue_out(nullptr, this) {
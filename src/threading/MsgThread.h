@@ -10,6 +10,10 @@ namespace zeek::detail {
 class Location;
 }
 
+namespace zeek::iosource {
+class IOSource;
+}
+
 namespace zeek::threading {
 
 struct Value;
@@ -64,6 +68,12 @@ public:
      */
     void SendIn(BasicInputMessage* msg) { return SendIn(msg, false); }
 
+    /**
+     * Returns true if the given IO source is the one through which a
+     * MsgThread delivers its messages to the main thread.
+     */
+    static bool IsMsgThreadSource(const iosource::IOSource* src);
+
     /**
      * Sends a message from the child thread to the main thread.
      *
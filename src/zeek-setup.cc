@@ -831,9 +831,28 @@ SetupResult setup(int argc, char** argv, Options* zopts) {
             cluster::backend = broker_mgr;
         }
         else {
-            reporter->Error("Unsupported cluster backend configured: %s",
-                            zeek::obj_desc_short(cluster_backend_val.get()).c_str());
-            exit(1);
+            const auto& event_serializer_val = id::find_val<zeek::EnumVal>("Cluster::event_serializer");
+            const auto& log_serializer_val = id::find_val<zeek::EnumVal>("Cluster::log_serializer");
+            auto event_serializer = cluster::manager->InstantiateEventSerializer(event_serializer_val);
+            auto log_serializer = cluster::manager->InstantiateLogSerializer(log_serializer_val);
+
+            if ( ! event_serializer || ! log_serializer ) {
+                reporter->Error("Failed to instantiate cluster serializers: %s, %s",
+                                zeek::obj_desc_short(event_serializer_val.get()).c_str(),
+                                zeek::obj_desc_short(log_serializer_val.get()).c_str());
+                exit(1);
+            }
+
+            auto backend = cluster::manager->InstantiateBackend(cluster_backend_val, std::move(event_serializer),
+                                                                std::move(log_serializer));
+            if ( ! backend ) {
+                reporter->Error("Unsupported cluster backend configured: %s",
+                                zeek::obj_desc_short(cluster_backend_val.get()).c_str());
+                exit(1);
+            }
+
+            // Backends register with the IO manager, which takes ownership.
+            cluster::backend = backend.release();
         }
 
         broker_mgr->InitPostScript();